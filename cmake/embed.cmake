@@ -0,0 +1,23 @@
+# Turn a binary file into a C++ source file that defines its contents as a
+# byte array, so that assets can be compiled into the executable.
+#
+#   cmake -DINPUT=<file> -DOUTPUT=<source> -DNAME=<identifier> -P embed.cmake
+#
+# defines `const unsigned char NAME[]` and `const size_t NAME_SIZE`.
+
+file(READ "${INPUT}" data HEX)
+string(LENGTH "${data}" n_digits)
+math(EXPR size "${n_digits} / 2")
+string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," data "${data}")
+# 16 bytes per line
+string(REPEAT "0x..," 16 line)
+string(REGEX REPLACE "(${line})" "\\1\n    " data "${data}")
+
+file(WRITE "${OUTPUT}"
+    "// Generated from ${INPUT} by embed.cmake\n"
+    "#include <stddef.h>\n"
+    "\n"
+    "extern const unsigned char ${NAME}[] = {\n"
+    "    ${data}\n"
+    "};\n"
+    "extern const size_t ${NAME}_SIZE = ${size};\n")
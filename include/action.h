@@ -0,0 +1,33 @@
+#pragma once
+#include "stdint.h"
+
+#include "SDL.h"
+
+/*
+ * Inputs understood by the simulation. Presses and releases are separate
+ * actions so that repeated movement (DAS) can be reproduced exactly from a
+ * recorded or transmitted stream of actions.
+ */
+enum class Action : uint8_t {
+    MoveLeft,
+    MoveLeftRelease,
+    MoveRight,
+    MoveRightRelease,
+    SoftDrop,
+    SoftDropRelease,
+    RotateClockw,
+    RotateCounterclockw,
+    HardDrop,
+    Hold,
+};
+inline const int N_ACTIONS = 10;
+
+// All actions that occurred during a single simulation tick, one bit per
+// Action. Within a tick, actions are applied in ascending bit order.
+using InputFrame_t = uint16_t;
+
+inline InputFrame_t actionBit(Action action) {
+    return (InputFrame_t)(1 << (int)action);
+}
+
+bool actionFromEvent(const SDL_Event &e, Action &action);
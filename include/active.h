@@ -2,43 +2,43 @@
 #include "array"
 #include "stdint.h"
 
+#include "bitboard.h"
+#include "boardsize.h"
 #include "constants.h"
 #include "playfield.h"
 
-class Active {
+template <int Width, int Height> class BasicActive {
   public:
+    using Size = BoardSize<Width, Height>;
+
     // Reference to playfield is necessary in order to set Minos when the
     // active Tetromino is locked down
-    Playfield &m_playfield;
+    BasicPlayfield<Width, Height> &m_playfield;
     // Top left corner of containing rectangle of the Tetromino
     int m_x, m_y;
     // Orientation of the Tetromino: A clockwise rotation increases the
     // orientation by one, counter-clockwise decreases by one
     uint8_t m_orientation;
-    // Grid representation of the current Tetromino
-    TetroGrid_t m_grid;
     // Current type of Tetrmino (e.g. O, L, T etc.)
     uint8_t m_type;
 
   private:
-    void loadGrid();
+    PieceMask_t getMask() const;
     bool canMoveRight();
     bool canMoveLeft();
-    TetroGrid_t getGridRotatedClockw();
-    TetroGrid_t getGridRotatedCounterclockw();
-    bool gridConflict(const TetroGrid_t &grid, int x, int y);
-    bool tryWallkicksC(const TetroGrid_t &new_grid, Wallkick_t &success,
+    bool conflict(uint8_t orientation, int x, int y);
+    bool tryWallkicksC(uint8_t new_orientation, Wallkick_t &success,
                        int &rotation_point);
-    bool tryWallkicksCC(const TetroGrid_t &new_grid, Wallkick_t &success,
+    bool tryWallkicksCC(uint8_t new_orientation, Wallkick_t &success,
                         int &rotation_point);
-    bool tryWallkicks(const TetroGrid_t &new_grid, int8_t direction,
+    bool tryWallkicks(uint8_t new_orientation, int8_t direction,
                       Wallkick_t &success, int &rotation_point);
-    bool tryWallkickData(const TetroGrid_t &new_grid,
+    bool tryWallkickData(uint8_t new_orientation,
                          const WallkickData_t *wallkick_data,
                          Wallkick_t &success, int &rotation_point);
 
   public:
-    Active(uint8_t type, Playfield &p_playfield);
+    BasicActive(uint8_t type, BasicPlayfield<Width, Height> &p_playfield);
 
     bool respawn(uint8_t type);
     void lockDown();
@@ -55,3 +55,6 @@ class Active {
     void draw(SDL_Renderer *renderer);
     void drawGhost(SDL_Renderer *renderer);
 };
+
+using Active = BasicActive<GRID_SIZE_X, GRID_SIZE_Y>;
+using WideActive = BasicActive<WIDE_GRID_SIZE_X, GRID_SIZE_Y>;
@@ -0,0 +1,6 @@
+#pragma once
+#include <stddef.h>
+
+// Font compiled into the executable by cmake/embed.cmake
+extern const unsigned char FONT_DATA[];
+extern const size_t FONT_DATA_SIZE;
@@ -0,0 +1,77 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <stdint.h>
+#include <vector>
+
+#include "SDL.h"
+
+#include "config.h"
+#include "events.h"
+
+// Frames per audio buffer; at 48 kHz this adds about 5 ms of latency
+inline const int AUDIO_BUFFER_FRAMES = 256;
+inline const int AUDIO_SAMPLE_RATE = 48000;
+// Sounds that can play at the same time; the oldest one is cut off
+inline const int AUDIO_MAX_VOICES = 8;
+
+enum class Sound : uint8_t {
+    Move,
+    Rotate,
+    Lock,
+    Hold,
+    LineClear,
+    Tetris,
+    TSpin,
+    LevelUp,
+    TopOut,
+};
+inline const int N_SOUNDS = 9;
+
+/*
+ * Plays a sound effect for the events of a game. All sounds are synthesized
+ * once when the device is opened by open() and kept as samples at the
+ * device's rate; playback starts once they are.
+ * The SDL audio callback takes new events from its own subscription to the
+ * EventBus and mixes the sounds they start, so the game thread never waits
+ * for audio and a sound starts at most one buffer after its event.
+ *
+ * Works with any SDL audio driver, including "dummy" and "disk" (set
+ * SDL_AUDIODRIVER), which is how it can be tested without a sound card.
+ */
+class Audio {
+  private:
+    struct Voice {
+        // Sound being played, -1 if the voice is free
+        int sound = -1;
+        size_t position = 0;
+    };
+
+    EventBus &m_bus;
+    EventSubscription *m_events = nullptr;
+    bool m_initialized = false;
+    SDL_AudioDeviceID m_device = 0;
+    std::atomic<float> m_volume;
+    std::array<std::vector<float>, N_SOUNDS> m_sounds;
+    // Only used by the audio callback
+    std::array<Voice, AUDIO_MAX_VOICES> m_voices;
+
+    static void callback(void *userdata, Uint8 *stream, int len);
+    void start(Sound sound);
+
+  public:
+    Audio(EventBus &bus, const AudioSettings &settings = AudioSettings());
+    ~Audio();
+
+    Audio(const Audio &) = delete;
+    Audio &operator=(const Audio &) = delete;
+
+    void open();
+    void setSettings(const AudioSettings &settings);
+    bool isOpen() const;
+    void load(int sample_rate);
+    void mix(float *out, int n_frames);
+
+    static uint32_t soundsFor(const GameEvent &event);
+    static std::vector<float> synthesize(Sound sound, int sample_rate);
+};
@@ -1,4 +1,6 @@
+#pragma once
 #include <array>
+#include <random>
 
 #include "constants.h"
 
@@ -7,6 +9,10 @@ class SevenBag {
     // Bag of Tetromino types from which new types are "pulled". Once the bag
     // is empty, it is refilled and shuffled
     std::array<TetrominoKind_t, N_TETROMINOS> m_bag;
+    // Source of randomness for shuffling. Kept per bag (instead of using the
+    // global rand() state) so that two bags with the same seed produce the
+    // same sequence, which is required for versus play and replays
+    std::minstd_rand m_rng;
     int m_next_bag_element = 0;
     // Queue of Tetrominos that will be placed on the Playfield.
     // Since the Queue is of a fixed size, it's not necessary to actually
@@ -26,7 +32,10 @@ class SevenBag {
 
   public:
     SevenBag();
+    SevenBag(uint32_t seed);
     void reset();
+    void reset(uint32_t seed);
     TetrominoKind_t popQueue();
     std::array<TetrominoKind_t, QUEUE_LEN> getQueue();
+    int getBagPosition() const;
 };
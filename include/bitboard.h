@@ -0,0 +1,54 @@
+#pragma once
+#include <array>
+#include <stdint.h>
+
+#include "boardsize.h"
+#include "constants.h"
+
+// Rows of a Tetromino's 4x4 grid, bit `x` is set if the cell in column `x` is
+// occupied
+using PieceRows_t = std::array<uint16_t, 4>;
+// A Tetromino's whole 4x4 grid, bit `row * 4 + col` is set if the cell is
+// occupied
+using PieceMask_t = uint16_t;
+
+/*
+ * Compact copy of a Playfield that only stores which cells are occupied. Used
+ * by bots and solvers, which simulate far more placements than could be done
+ * on a Playfield.
+ */
+template <int Width, int Height> struct BasicBitBoard {
+    using Size = BoardSize<Width, Height>;
+    using Row_t = typename Size::Row_t;
+
+    std::array<Row_t, Height> rows{};
+
+    bool isObstructed(int x, int y) const;
+    bool fits(TetrominoKind_t kind, uint8_t orientation, int x, int y) const;
+    void place(TetrominoKind_t kind, uint8_t orientation, int x, int y);
+    int clearLines();
+    int dropY(TetrominoKind_t kind, uint8_t orientation, int x, int y) const;
+    uint64_t getHash() const;
+
+    bool operator==(const BasicBitBoard &other) const;
+};
+
+using BitBoard = BasicBitBoard<GRID_SIZE_X, GRID_SIZE_Y>;
+using WideBitBoard = BasicBitBoard<WIDE_GRID_SIZE_X, GRID_SIZE_Y>;
+
+// A single row of the standard board
+using BitRow_t = BitBoard::Row_t;
+inline const BitRow_t FULL_ROW = StandardSize::FULL_ROW;
+
+const PieceRows_t &getPieceRows(TetrominoKind_t kind, uint8_t orientation);
+PieceMask_t getPieceMask(TetrominoKind_t kind, uint8_t orientation);
+
+/**
+ * Call `f(col, row)` for every occupied cell of a piece mask, row by row
+ */
+template <typename F> void forEachMino(PieceMask_t mask, F f) {
+    for (; mask; mask &= mask - 1) {
+        int bit = __builtin_ctz(mask);
+        f(bit % 4, bit / 4);
+    }
+}
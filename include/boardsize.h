@@ -0,0 +1,45 @@
+#pragma once
+#include <stdint.h>
+#include <type_traits>
+
+#include "constants.h"
+
+/*
+ * Everything that depends on the dimensions of a board. Playfield, Active,
+ * BitBoard and PlacementEnumerator are templated on the dimensions and take
+ * their layout from here, so that every board size is compiled into its own
+ * fully specialized code.
+ */
+template <int Width, int Height> struct BoardSize {
+    static_assert(Width >= 4 && Width <= 56,
+                  "rows plus walls must fit into 64 bits");
+    static_assert(Height >= 8 && Height % 2 == 0,
+                  "the upper half of the board is the buffer zone");
+
+    static constexpr int WIDTH = Width;
+    static constexpr int HEIGHT = Height;
+    // Only the lower half of the board is visible, the upper half is where
+    // Tetrominos spawn
+    static constexpr int VISIBLE_HEIGHT = Height / 2;
+    static constexpr int START_Y = Height - VISIBLE_HEIGHT;
+    // Top left corner of a newly spawned Tetromino's grid
+    static constexpr int SPAWN_X = (Width - 4) / 2;
+    static constexpr int SPAWN_Y = START_Y - 2;
+    // Size on screen in pixels
+    static constexpr int PIXEL_WIDTH = Width * CELL_SIZE;
+    static constexpr int PIXEL_HEIGHT = VISIBLE_HEIGHT * CELL_SIZE;
+
+    // Smallest integer that holds a row as a bitmask, bit `x` being column `x`
+    using Row_t = std::conditional_t<
+        Width <= 16, uint16_t,
+        std::conditional_t<Width <= 32, uint32_t, uint64_t>>;
+    // Integer with room for a row and four columns of wall on either side
+    using WallRow_t = std::conditional_t<Width + 8 <= 32, uint32_t, uint64_t>;
+    static constexpr Row_t FULL_ROW = (Row_t)(((uint64_t)1 << Width) - 1);
+};
+
+// The standard board
+using StandardSize = BoardSize<GRID_SIZE_X, GRID_SIZE_Y>;
+static_assert(StandardSize::SPAWN_X == STARTING_POSITION_X &&
+              StandardSize::SPAWN_Y == STARTING_POSITION_Y &&
+              StandardSize::START_Y == GRID_START_Y);
@@ -0,0 +1,256 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <stdint.h>
+#include <vector>
+
+#include "bitboard.h"
+#include "constants.h"
+#include "eval.h"
+#include "placement.h"
+#include "simcore.h"
+#include "ttable.h"
+#include "zobrist.h"
+
+// Maximum number of Tetrominos a Bot looks ahead: the active one and the queue
+inline const int BOT_MAX_DEPTH = QUEUE_LEN + 1;
+
+// Decision made by a Bot for the active Tetromino
+struct BotMove {
+    Placement placement;
+    // Whether to hold before placing
+    bool hold;
+};
+
+/*
+ * Plays a SimCore by searching all placements of the next few Tetrominos and
+ * picking the one leading to the best board. The evaluator is a template
+ * policy providing `float score(const EvalFeatures &) const`, either a
+ * StaticEvaluator with weights fixed at compile time or a BoardEvaluator for
+ * weights that change at runtime (e. g. while tuning).
+ *
+ * A TranspositionTable may be shared between several Bots to skip boards
+ * that were already searched with the same Tetrominos to come. Entries are
+ * keyed by the evaluator's weights too, so Bots with different weights can
+ * share a table without reading each other's scores.
+ */
+template <class Evaluator> class Bot {
+  private:
+    Evaluator m_evaluator;
+    int m_depth;
+    TranspositionTable *m_table;
+    // Fingerprint of the evaluator, mixed into the keys of m_table
+    uint64_t m_fingerprint = 0;
+
+    PlacementEnumerator m_enumerator;
+    // Placements for each level of the search, reused to avoid allocations
+    std::array<std::vector<Placement>, BOT_MAX_DEPTH> m_placements;
+    BoardBatch m_batch;
+    std::array<EvalFeatures, EVAL_BATCH_SIZE> m_features;
+
+    static constexpr float WORST = std::numeric_limits<float>::infinity();
+
+    /**
+     * Score all boards in the batch and empty it
+     *
+     * @param scores set to the score of each board, in the batch's order
+     */
+    void scoreBatch(float *scores) {
+        BoardEvaluator::computeFeaturesBatch(m_batch, m_features.data());
+        for (int i = 0; i < m_batch.size; i++) {
+            scores[i] = m_evaluator.score(m_features[i]);
+        }
+        m_batch.size = 0;
+    }
+
+    /**
+     * Score all boards in the batch and empty it
+     *
+     * @return the best score
+     */
+    float flushBatch() {
+        std::array<float, EVAL_BATCH_SIZE> scores;
+        int n = m_batch.size;
+        scoreBatch(scores.data());
+        return *std::min_element(scores.begin(), scores.begin() + n);
+    }
+
+    static uint64_t hashPieces(const TetrominoKind_t *pieces, int n_pieces) {
+        uint64_t hash = 0;
+        for (int i = 0; i < n_pieces; i++) {
+            hash ^= ZOBRIST.queue[i][pieces[i]];
+        }
+        return hash;
+    }
+
+    /**
+     * Find the best score reachable by placing the given Tetrominos in order
+     *
+     * @param level index into m_placements to use
+     */
+    float search(const BitBoard &board, const TetrominoKind_t *pieces,
+                 int n_pieces, int level) {
+        uint64_t hash = 0;
+        if (m_table) {
+            hash = board.getHash() ^ hashPieces(pieces, n_pieces) ^
+                   m_fingerprint;
+            float value;
+            uint8_t depth;
+            if (m_table->probe(hash, value, depth) && depth == n_pieces) {
+                return value;
+            }
+        }
+
+        std::vector<Placement> &placements = m_placements[level];
+        placements.clear();
+        m_enumerator.enumerate(CollisionMap(board), pieces[0], placements);
+        float best = WORST;
+        for (const Placement &placement : placements) {
+            BitBoard child = board;
+            child.place(pieces[0], placement.orientation, placement.x,
+                        placement.y);
+            child.clearLines();
+            if (n_pieces == 1) {
+                // Leaves are scored in batches
+                m_batch.push(child);
+                if (m_batch.size == EVAL_BATCH_SIZE) {
+                    best = std::min(best, flushBatch());
+                }
+            } else {
+                best = std::min(
+                    best, search(child, pieces + 1, n_pieces - 1, level + 1));
+            }
+        }
+        if (m_batch.size > 0) {
+            best = std::min(best, flushBatch());
+        }
+
+        if (m_table) {
+            m_table->store(hash, best, n_pieces);
+        }
+        return best;
+    }
+
+    /**
+     * Search a sequence of Tetrominos, but remember which root placement led
+     * to the best score
+     */
+    float searchRoot(const BitBoard &board, const TetrominoKind_t *pieces,
+                     int n_pieces, Placement &best_placement) {
+        std::vector<Placement> &placements = m_placements[0];
+        placements.clear();
+        m_enumerator.enumerate(CollisionMap(board), pieces[0], placements);
+        float best = WORST;
+        // Ties keep the earlier placement, so that the choice is
+        // deterministic
+        auto consider = [&](size_t i, float value) {
+            if (value < best) {
+                best = value;
+                best_placement = placements[i];
+            }
+        };
+        std::array<float, EVAL_BATCH_SIZE> scores;
+        for (size_t i = 0; i < placements.size(); i++) {
+            const Placement &placement = placements[i];
+            BitBoard child = board;
+            child.place(pieces[0], placement.orientation, placement.x,
+                        placement.y);
+            child.clearLines();
+            if (n_pieces > 1) {
+                consider(i, search(child, pieces + 1, n_pieces - 1, 1));
+                continue;
+            }
+            // Leaves are scored in batches, in the order of their placements
+            m_batch.push(child);
+            if (m_batch.size == EVAL_BATCH_SIZE ||
+                i + 1 == placements.size()) {
+                int n = m_batch.size;
+                scoreBatch(scores.data());
+                for (int j = 0; j < n; j++) {
+                    consider(i + 1 - n + j, scores[j]);
+                }
+            }
+        }
+        return best;
+    }
+
+  public:
+    /**
+     * @param depth number of Tetrominos to look ahead, at most BOT_MAX_DEPTH
+     * @param table optional transposition table, may be shared between Bots
+     */
+    Bot(const Evaluator &evaluator = Evaluator(), int depth = 2,
+        TranspositionTable *table = nullptr)
+        : m_evaluator(evaluator),
+          m_depth(std::max(1, std::min(depth, BOT_MAX_DEPTH))),
+          m_table(table) {}
+
+    /**
+     * Choose where to place the active Tetromino, also considering holding it
+     *
+     * @return false if there is no placement at all
+     */
+    template <class Rule, class Gravity>
+    bool chooseMove(SimCore<Rule, Gravity> &core, BotMove &move) {
+        std::array<TetrominoKind_t, QUEUE_LEN> queue = core.getQueue();
+        std::array<TetrominoKind_t, BOT_MAX_DEPTH> pieces;
+        pieces[0] = core.getActive();
+        std::copy(queue.begin(), queue.end(), pieces.begin() + 1);
+
+        // The weights may have been changed through getEvaluator()
+        if (m_table) {
+            m_fingerprint = m_evaluator.fingerprint();
+        }
+
+        Placement placement;
+        float best = searchRoot(core.board, pieces.data(), m_depth, placement);
+        move = {placement, false};
+
+        if (core.canHold()) {
+            // Holding either brings back the held Tetromino or the next one,
+            // which shortens the known sequence by one
+            int n_pieces = m_depth;
+            if (core.getHeld() == 255) {
+                n_pieces = std::min(m_depth, BOT_MAX_DEPTH - 1);
+                std::copy(queue.begin(), queue.end(), pieces.begin());
+            } else {
+                pieces[0] = core.getHeld();
+            }
+            if (pieces[0] != core.getActive()) {
+                float value =
+                    searchRoot(core.board, pieces.data(), n_pieces, placement);
+                if (value < best) {
+                    best = value;
+                    move = {placement, true};
+                }
+            }
+        }
+        return best != WORST;
+    }
+
+    /**
+     * Let the Bot play until the game is over or a number of Tetrominos has
+     * been placed
+     *
+     * @return the number of placed Tetrominos
+     */
+    template <class Rule, class Gravity>
+    int play(SimCore<Rule, Gravity> &core, int max_pieces) {
+        BotMove move;
+        while (!core.isOver() && core.getPieces() < max_pieces) {
+            if (!chooseMove(core, move)) {
+                break;
+            }
+            if (move.hold) {
+                core.hold();
+            }
+            core.place(move.placement);
+        }
+        return core.getPieces();
+    }
+
+    Evaluator &getEvaluator() {
+        return m_evaluator;
+    }
+};
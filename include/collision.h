@@ -0,0 +1,53 @@
+#pragma once
+#include <array>
+#include <stdint.h>
+
+#include "bitboard.h"
+#include "boardsize.h"
+#include "constants.h"
+
+/*
+ * Which poses of a Tetromino fit on a board, precomputed so that checking a
+ * pose is a single bit test. For every kind, orientation and horizontal
+ * position the map stores one bit per row. The poses of a kind are computed
+ * the first time one of them is asked for, so a board that only ever sees one
+ * or two kinds before it changes again doesn't pay for the others.
+ */
+template <int Width, int Height> class BasicCollisionMap {
+  public:
+    using Size = BoardSize<Width, Height>;
+
+  private:
+    static_assert(Height <= 60, "a column of poses must fit into 64 bits");
+    // Tetrominos can stick out of the left of the board by up to 3 columns
+    static const int OFFSET_X = 3;
+    static const int SIZE_X = Width + OFFSET_X;
+
+    BasicBitBoard<Width, Height> m_board;
+    // Occupied cells of every column, bit `y` being row `y`. Columns next to
+    // the board and rows below it are completely occupied.
+    std::array<uint64_t, SIZE_X + 4> m_columns;
+    // Bit `y` is set if the Tetromino fits with its top left corner at (x, y)
+    mutable std::array<std::array<std::array<uint64_t, SIZE_X>, 4>,
+                       N_TETROMINOS>
+        m_fits;
+    // Bit `kind` is set once the poses of that kind are computed
+    mutable uint8_t m_built = 0;
+
+    const std::array<uint64_t, SIZE_X> &getPoses(TetrominoKind_t kind,
+                                                   uint8_t orientation) const;
+    void build(TetrominoKind_t kind) const;
+    uint64_t getColumn(int x) const;
+
+  public:
+    BasicCollisionMap();
+    BasicCollisionMap(const BasicBitBoard<Width, Height> &board);
+
+    void reset(const BasicBitBoard<Width, Height> &board);
+    const BasicBitBoard<Width, Height> &getBoard() const;
+    bool fits(TetrominoKind_t kind, uint8_t orientation, int x, int y) const;
+    int dropY(TetrominoKind_t kind, uint8_t orientation, int x, int y) const;
+};
+
+using CollisionMap = BasicCollisionMap<GRID_SIZE_X, GRID_SIZE_Y>;
+using WideCollisionMap = BasicCollisionMap<WIDE_GRID_SIZE_X, GRID_SIZE_Y>;
@@ -0,0 +1,56 @@
+#pragma once
+#include <chrono>
+#include <string>
+
+#include "constants.h"
+
+/*
+ * How the active Tetromino responds to held keys. Delays are in (possibly
+ * fractional) milliseconds.
+ */
+struct Handling {
+    // Delayed auto shift: how long a movement key has to be held before the
+    // Tetromino starts moving repeatedly
+    double das_ms = KEY_INIT_DELAY_MS;
+    // Auto repeat rate: delay between repeated moves; 0 moves the Tetromino
+    // all the way to the wall at once
+    double arr_ms = KEY_REPEAT_DELAY_MS;
+    // How many times faster than falling soft dropping is; infinity drops the
+    // Tetromino to the bottom at once
+    double soft_drop_factor = 1 / SOFT_DROP_DELAY_MULT;
+};
+
+/*
+ * Thresholds for the left stick of a game controller, as a fraction of full
+ * deflection. A direction counts as pressed once the stick goes past
+ * `stick_press` and as released once it comes back below `stick_release`,
+ * so that a stick resting near the threshold doesn't restart DAS repeatedly.
+ */
+struct GamepadSettings {
+    double stick_press = 0.5;
+    double stick_release = 0.35;
+};
+
+struct AudioSettings {
+    // Volume of the sound effects from 0 (muted) to 1
+    double volume = 0.5;
+};
+
+/*
+ * All settings that can be changed in the config file
+ */
+struct Config {
+    Handling handling;
+    GamepadSettings gamepad;
+    AudioSettings audio;
+};
+
+/**
+ * Convert a duration in fractional milliseconds to clock ticks
+ */
+inline std::chrono::steady_clock::duration fromMs(double ms) {
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double, std::milli>(ms));
+}
+
+bool loadConfig(const std::string &path, Config &config);
@@ -35,6 +35,8 @@ inline const int QUEUE_LEN = 3;
 // Playfield
 inline const int GRID_SIZE_X = 10;
 inline const int GRID_SIZE_Y = 40;
+// Width of the board for wide board modes
+inline const int WIDE_GRID_SIZE_X = 20;
 // Visible portion of the grid; for width this is redundant, but regarding the
 // height it's very important since only half of the actual grid is show
 inline const int GRID_SIZE_VISIBLE_X = GRID_SIZE_X;
@@ -47,14 +49,42 @@ inline const int CELL_SIZE = 40;
 inline const int PLAYFIELD_WIDTH = GRID_SIZE_X * CELL_SIZE;
 inline const int PLAYFIELD_HEIGHT = GRID_SIZE_VISIBLE_Y * CELL_SIZE;
 
+// Value of an empty cell on the Playfield; values 0~6 correspond to the
+// different Minos
+inline const uint8_t EMPTY_MINO = 7;
+// Value of a cell filled by incoming garbage in versus mode
+inline const uint8_t GARBAGE_MINO = 8;
+
 // Game
 enum class GameState { PreInit, Running, Paused, GameOver };
 
+// Versus
+// Length of one simulation tick in versus mode; both players have to agree on
+// this, so it is independent of the framerate
+inline const int VERSUS_TICK_US = 16667;
+// Default number of ticks by which local inputs are delayed before they are
+// applied; gives the remote inputs time to arrive before they are needed
+inline const int VERSUS_DEFAULT_INPUT_DELAY = 2;
+// Maximum number of ticks that can be rolled back and re-simulated. When the
+// remote player falls further behind than this, the local simulation stalls
+inline const int VERSUS_MAX_ROLLBACK = 12;
+// Garbage lines sent for clearing 1~4 lines
+inline const std::array<int, 5> GARBAGE_LINES = {{0, 0, 1, 2, 4}};
+// Garbage lines sent for a T-Spin clearing 0~3 lines
+inline const std::array<int, 4> T_SPIN_GARBAGE_LINES = {{0, 2, 4, 6}};
+// Maximum number of garbage lines inserted at a single lock down; the rest
+// stays queued
+inline const int GARBAGE_CAP = 8;
+
 // Window
 // Include enough space to the right to show queue
 inline const int WINDOW_X = PLAYFIELD_WIDTH + 2 * (CELL_SIZE * 7);
 inline const int WINDOW_Y = PLAYFIELD_HEIGHT + 1;
 
+// In versus mode, the opponent's board is drawn in a second window-sized area
+// to the right
+inline const int VERSUS_WINDOW_X = 2 * WINDOW_X;
+
 // Position of the playfield on screen in pixels
 inline const int PLAYFIELD_DRAW_X = (WINDOW_X - PLAYFIELD_WIDTH) / 2;
 inline const int PLAYFIELD_DRAW_Y = 0;
@@ -73,6 +103,9 @@ inline const SDL_Color GRID_COLOR{152, 139, 162, 0};
 inline const SDL_Color BACKGROUND{48, 45, 65, 0};
 inline const SDL_Color GHOST_COLOR{152, 139, 163, 0};
 inline const SDL_Color TEXT_COLOR{217, 224, 238, 0};
+inline const SDL_Color GARBAGE_COLOR{110, 106, 124, 0};
+// Outline of the next placement of a perfect clear hint
+inline const SDL_Color PC_HINT_COLOR{250, 227, 176, 0};
 inline const std::array<SDL_Color, 7> TETROMINO_COLORS = {{
     {150, 205, 251, 0}, // I: Cyan
     {250, 227, 176, 0}, // O: Yellow
@@ -84,7 +117,6 @@ inline const std::array<SDL_Color, 7> TETROMINO_COLORS = {{
 }};
 
 // Text
-inline const char FONT_PATH_RELATIVE[] = "/futura-medium.ttf";
 inline const float FONT_SIZE_SCALE = 0.9;
 inline const int FONT_SIZE = (int)(CELL_SIZE * FONT_SIZE_SCALE);
 inline const int LINE_OFFSET = (int)(50 * FONT_SIZE_SCALE);
@@ -100,6 +132,10 @@ inline const int GOAL_TEXT_X = INFO_TEXT_X;
 inline const int GOAL_TEXT_Y = LEVEL_TEXT_Y + LINE_OFFSET;
 inline const int LINES_TEXT_X = INFO_TEXT_X;
 inline const int LINES_TEXT_Y = GOAL_TEXT_Y + LINE_OFFSET;
+// Live statistics, one line each
+inline const int STATS_TEXT_X = INFO_TEXT_X;
+inline const int STATS_TEXT_Y = LINES_TEXT_Y + (int)(2 * LINE_OFFSET);
+inline const int N_STATS_LINES = 4;
 
 // x-position of 'Paused' text is calculated dynamically
 inline const int PAUSED_TEXT_Y = PLAYFIELD_DRAW_Y + PLAYFIELD_HEIGHT * 0.45;
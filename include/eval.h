@@ -0,0 +1,134 @@
+#pragma once
+#include <array>
+#include <stdint.h>
+#include <utility>
+
+#include "bitboard.h"
+#include "constants.h"
+
+// Number of boards evaluated at once by BoardEvaluator::evaluateBatch
+inline const int EVAL_BATCH_SIZE = 16;
+
+/*
+ * Features of a board that the heuristic is made up of
+ */
+struct EvalFeatures {
+    // Sum of the heights of all columns
+    int aggregate_height;
+    // Empty cells with an occupied cell somewhere above them
+    int holes;
+    // Sum of the height differences between neighbouring columns
+    int bumpiness;
+    // Changes between empty and occupied cells along each row, counting the
+    // walls as occupied
+    int row_transitions;
+    // Changes between empty and occupied cells along each column, counting
+    // the floor as occupied
+    int column_transitions;
+    // Sum of the depths of all wells, i. e. of how far each column is below
+    // both of its neighbours (or the wall)
+    int wells;
+
+    bool operator==(const EvalFeatures &other) const;
+};
+
+/*
+ * Default weights as compile-time constants, for use with StaticEvaluator
+ */
+struct DefaultWeights {
+    static constexpr float aggregate_height = 0.51f;
+    static constexpr float holes = 3.6f;
+    static constexpr float bumpiness = 0.18f;
+    static constexpr float row_transitions = 0.32f;
+    static constexpr float column_transitions = 0.93f;
+    static constexpr float wells = 0.35f;
+};
+
+/*
+ * Weights of the features that can be changed at runtime; lower scores are
+ * better
+ */
+struct EvalWeights {
+    float aggregate_height = DefaultWeights::aggregate_height;
+    float holes = DefaultWeights::holes;
+    float bumpiness = DefaultWeights::bumpiness;
+    float row_transitions = DefaultWeights::row_transitions;
+    float column_transitions = DefaultWeights::column_transitions;
+    float wells = DefaultWeights::wells;
+};
+
+// Every weight with the name it goes by in bot files
+inline const std::array<std::pair<const char *, float EvalWeights::*>, 6>
+    EVAL_WEIGHT_NAMES = {{
+        {"aggregate_height", &EvalWeights::aggregate_height},
+        {"holes", &EvalWeights::holes},
+        {"bumpiness", &EvalWeights::bumpiness},
+        {"row_transitions", &EvalWeights::row_transitions},
+        {"column_transitions", &EvalWeights::column_transitions},
+        {"wells", &EvalWeights::wells},
+    }};
+
+uint64_t fingerprintWeights(const EvalWeights &weights);
+
+/*
+ * Evaluator policy with weights fixed at compile time, so that scoring
+ * inlines to a handful of multiplications by constants. Has the same score()
+ * interface as BoardEvaluator, which is used where weights change at runtime.
+ */
+template <class Weights> struct StaticEvaluator {
+    uint64_t fingerprint() const {
+        return fingerprintWeights(
+            {Weights::aggregate_height, Weights::holes, Weights::bumpiness,
+             Weights::row_transitions, Weights::column_transitions,
+             Weights::wells});
+    }
+
+    float score(const EvalFeatures &features) const {
+        return Weights::aggregate_height * features.aggregate_height +
+               Weights::holes * features.holes +
+               Weights::bumpiness * features.bumpiness +
+               Weights::row_transitions * features.row_transitions +
+               Weights::column_transitions * features.column_transitions +
+               Weights::wells * features.wells;
+    }
+};
+
+/*
+ * Up to EVAL_BATCH_SIZE boards stored row by row, so that the same row of all
+ * boards can be loaded into a single vector register
+ */
+struct BoardBatch {
+    alignas(32) std::array<std::array<BitRow_t, EVAL_BATCH_SIZE>, GRID_SIZE_Y>
+        rows{};
+    int size = 0;
+
+    void set(int i, const BitBoard &board);
+    void push(const BitBoard &board);
+};
+
+/*
+ * Scores boards with a linear combination of EvalFeatures. Batches of boards
+ * are evaluated with AVX2 or SSE4.1 if the CPU supports it; the
+ * implementation is chosen once at startup. All implementations compute the
+ * exact same integer features, so they give identical scores.
+ */
+class BoardEvaluator {
+  private:
+    EvalWeights m_weights;
+
+  public:
+    BoardEvaluator();
+    BoardEvaluator(const EvalWeights &weights);
+
+    const EvalWeights &getWeights() const;
+    uint64_t fingerprint() const;
+    float score(const EvalFeatures &features) const;
+
+    float evaluate(const BitBoard &board) const;
+    void evaluateBatch(const BoardBatch &batch, float *scores) const;
+
+    static EvalFeatures computeFeatures(const BitBoard &board);
+    static void computeFeaturesBatch(const BoardBatch &batch,
+                                     EvalFeatures *features);
+    static const char *getImplementationName();
+};
@@ -0,0 +1,100 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+#include <thread>
+
+#include "sim.h"
+#include "spscqueue.h"
+
+// Events a subscriber can fall behind by before events are dropped
+inline const int EVENT_QUEUE_SIZE = 1024;
+inline const int EVENT_BUS_MAX_SUBSCRIBERS = 4;
+
+enum class GameEventType : uint8_t {
+    // A Tetromino was locked down and the next one spawned. A lock down after
+    // which the next Tetromino can't spawn is only reported as TopOut.
+    PieceLocked,
+    LinesCleared,
+    // T-Spin or Mini T-Spin, with or without lines cleared
+    TSpin,
+    LevelUp,
+    Hold,
+    TopOut,
+    // The active Tetromino moved sideways, by one or more cells
+    Moved,
+    Rotated,
+};
+
+/*
+ * Something that happened in a Simulation. Plain data, so that publishing it
+ * is a copy into a ring buffer.
+ */
+struct GameEvent {
+    GameEventType type;
+    // Simulation time at which it happened
+    cl::time_point time;
+    // The lock down that caused the event. For Hold only `kind` is set, to
+    // the Tetromino that was put into hold; for Moved and Rotated nothing.
+    LockInfo lock;
+    // Level after the event
+    int level;
+};
+
+/*
+ * One subscriber's queue of events
+ */
+class EventSubscription {
+  private:
+    SpscQueue<GameEvent> m_queue{EVENT_QUEUE_SIZE};
+    // Events lost because the subscriber fell too far behind
+    std::atomic<int> m_dropped{0};
+
+    friend class EventBus;
+
+  public:
+    bool poll(GameEvent &event);
+    int takeDropped();
+};
+
+/*
+ * Hands the events of a Simulation to subscribers on other threads. Every
+ * subscriber gets its own single-producer single-consumer queue, so
+ * publishing never locks, allocates or waits: if a subscriber's queue is
+ * full, the event is dropped for that subscriber only.
+ *
+ * Events are published from one thread, the one running the Simulation.
+ * Subscribing is possible at any time, but only from one thread.
+ */
+class EventBus {
+  private:
+    std::array<std::unique_ptr<EventSubscription>, EVENT_BUS_MAX_SUBSCRIBERS>
+        m_subscriptions;
+    std::atomic<int> m_n_subscriptions{0};
+
+  public:
+    EventSubscription *subscribe();
+    void publish(const GameEvent &event);
+};
+
+/*
+ * Subscriber printing T-Spins to stdout from a thread of its own, so that the
+ * game thread doesn't wait for the terminal
+ */
+class EventLogger {
+  private:
+    EventSubscription *m_events;
+    std::atomic<bool> m_stop{false};
+    std::thread m_thread;
+
+    void run();
+    void log(const GameEvent &event);
+
+  public:
+    EventLogger(EventBus &bus);
+    ~EventLogger();
+
+    EventLogger(const EventLogger &) = delete;
+    EventLogger &operator=(const EventLogger &) = delete;
+};
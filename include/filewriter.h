@@ -0,0 +1,40 @@
+#pragma once
+#include <condition_variable>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Writes files on a background thread, so that saving something at game over
+ * never holds up a frame. Writes still queued when the writer is destroyed
+ * are done before that returns. Failures are reported on stderr.
+ */
+class FileWriter {
+  private:
+    struct PendingWrite {
+        std::string path;
+        std::vector<uint8_t> data;
+        // Whether to append to the file instead of replacing it
+        bool append;
+    };
+
+    std::vector<PendingWrite> m_pending;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stop = false;
+    std::thread m_thread;
+
+    void run();
+
+  public:
+    FileWriter();
+    ~FileWriter();
+
+    FileWriter(const FileWriter &) = delete;
+    FileWriter &operator=(const FileWriter &) = delete;
+
+    void write(const std::string &path, std::vector<uint8_t> data,
+               bool append = false);
+};
@@ -0,0 +1,54 @@
+#pragma once
+#include <array>
+#include <stdint.h>
+#include <vector>
+
+#include "action.h"
+#include "bitboard.h"
+#include "constants.h"
+#include "placement.h"
+
+/*
+ * Compares the keys pressed for each Tetromino against the fewest that reach
+ * the same final position. Every press of a shift key counts once, no matter
+ * whether it was tapped or held for DAS, as does every rotation and every
+ * soft drop. Hard drops and holds aren't counted.
+ *
+ * Positions that can be reached by dropping straight down from above are
+ * looked up in a table computed once at startup. Tucks and spins fall back to
+ * a search with the PlacementEnumerator on the actual board.
+ */
+class FinesseAnalyzer {
+  private:
+    PlacementEnumerator m_enumerator;
+    std::vector<Placement> m_placements;
+    std::vector<Move> m_path;
+
+    // Board and number of keys pressed for the current Tetromino
+    BitBoard m_board;
+    int m_inputs = 0;
+
+    // Totals since the last reset
+    int m_pieces = 0;
+    int m_total_inputs = 0;
+    int m_faults = 0;
+    int m_extra_inputs = 0;
+
+    int searchInputs(const BitBoard &board, TetrominoKind_t kind,
+                     const Placement &placement);
+
+  public:
+    static int dropInputs(TetrominoKind_t kind, uint8_t orientation, int x);
+    int optimalInputs(const BitBoard &board, TetrominoKind_t kind,
+                      const Placement &placement);
+
+    void reset(const BitBoard &board);
+    void onAction(Action action);
+    int onLock(TetrominoKind_t kind, const Placement &placement,
+               const BitBoard &board_after);
+
+    int getPieces() const;
+    int getInputs() const;
+    int getFaults() const;
+    int getExtraInputs() const;
+};
@@ -1,92 +1,102 @@
+#pragma once
 #include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include "SDL.h"
 
-#include "active.h"
-#include "bag.h"
+#include "audio.h"
 #include "constants.h"
+#include "config.h"
+#include "events.h"
+#include "filewriter.h"
+#include "finesse.h"
+#include "gamepad.h"
 #include "hud.h"
+#include "injection.h"
+#include "pcsolver.h"
+#include "replay.h"
+#include "sessionlog.h"
+#include "sim.h"
+#include "stateexport.h"
+#include "statestream.h"
+#include "stats.h"
 #include "timer.h"
 
 /*
- * Handles the main game mechanics.
+ * Interactive single player game: feeds keyboard and game controller input
+ * and the wall clock into a Simulation and draws it.
  */
 class Game {
   private:
-    // Current m_state of the game
-    GameState m_state = GameState::PreInit;
+    Simulation m_sim;
+    EventBus m_events;
+    EventLogger m_event_logger;
+    Audio m_audio;
+    HUD m_hud;
+    Gamepad m_gamepad;
 
-    // When to perform the next fall step
-    Timer m_next_fall;
-    // When to perform the next soft drop step
-    Timer m_next_soft_drop;
-    // Whether the Tetromino is currently Soft Dropping, i. e. the down arrow
-    // key is m_held
-    bool m_soft_dropping = false;
-    // When to lock down the active Tetromino
-    Timer m_lock_down;
-    // Whether the active Tetromino is currently in contact with a Mino on the
-    // Playfield; used in combination with m_lock_down Timer
-    bool m_surface_contact = false;
-    void startSoftDropping();
-    void stopSoftDropping();
-    bool performSoftDrop();
-    void incSoftDropTimer();
-    void resetSoftDropTimer();
+    FinesseAnalyzer m_finesse;
+    // Number of locks already passed to m_finesse
+    int m_n_locks = 0;
+    void checkLocks();
 
-    bool performFall();
-    void incFallTimer();
-    void resetFallTimer();
+    LiveStats m_stats;
+    // File the statistics are appended to at game over, if any
+    std::string m_stats_path;
+    bool m_stats_exported = false;
+    void exportStats();
+    // Writes the statistics and replays, if either is saved, so that the
+    // game thread never waits for the disk
+    std::unique_ptr<FileWriter> m_file_writer;
 
-    void scheduleLockDown();
-    void lockDownAndRespawnActive();
-    bool respawnActive();
-    bool respawnActiveWithKind(TetrominoKind_t kind);
+    // Log file the result of each game is written to, if any
+    SessionLog *m_session_log;
+    uint32_t m_seed = 0;
+    void logSession();
 
-    // Horizontal movement
-    bool m_moving_right = false;
-    bool m_moving_left = false;
-    Timer m_next_mv_right;
-    Timer m_next_mv_left;
-    void initMoveLeft();
-    void stopMoveLeft();
-    void moveLeft();
-    void initMoveRight();
-    void stopMoveRight();
-    void moveRight();
+    // Directory the replay of each game is saved to, if any
+    std::string m_replay_dir;
+    ReplayRecorder m_recorder;
+    void saveReplay(SessionRecord &record);
 
-    // T-Spins
-    // Store the last rotation point (a value in the range [0, 4] determined by
-    // what rotation was used by SRS)
-    int m_last_rotation_point;
-    // Whether the last action was a spin
-    bool m_last_spin = false;
-    // Check if the last action was a T-Spin or a Mini T-Spin and award points
-    // accordingly
-    int checkTSpin();
-    void getCorners(bool &tl, bool &tr, bool &bl, bool &br);
-    bool inTSlot();
-    bool inMiniTSlot();
+    // Where the state is published after every tick, if anywhere
+    StateExport *m_state_export;
+    // Where the changes of the state are streamed to, if anywhere
+    StateStreamWriter *m_state_stream;
+    void exportState(cl::time_point now);
 
-    void hold();
-    TetrominoKind_t m_held = -1;
-    bool m_can_hold = true;
+    // Perfect clear hint, only if enabled
+    std::unique_ptr<PerfectClearWorker> m_pc_worker;
+    // Hash of the Simulation the hint was last asked for
+    uint64_t m_pc_hint_hash = 0;
+    std::vector<PerfectClearStep> m_pc_hint;
+    void updatePerfectClearHint();
+    void drawPerfectClearHint(SDL_Renderer *renderer);
 
-    SevenBag m_bag;
-    HUD m_hud;
-    FixedGoalScoring m_scoring = FixedGoalScoring(1);
+    // Actions injected by bots, applied at their own times
+    ActionInjector m_injector;
+    std::vector<InjectedAction> m_due_actions;
+    void applyInjectedActions(cl::time_point now);
 
+    void applyAction(Action action, cl::time_point now);
+    void togglePause();
     void restart();
 
   public:
-    Game(const std::string &assets_path);
-
-    Playfield playfield;
-    Active active;
+    Game(bool pc_hint = false, const std::string &stats_path = "",
+         SessionLog *session_log = nullptr,
+         StateExport *state_export = nullptr,
+         StateStreamWriter *state_stream = nullptr,
+         const std::string &replay_dir = "");
 
     void init();
+    void finishLoading(SDL_Renderer *renderer);
+    void configure(const Config &config);
     void update();
     GameState getState();
     void handleEvent(const SDL_Event &e);
     void draw(SDL_Renderer *renderer);
+    ActionInjector &getInjector();
 };
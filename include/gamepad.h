@@ -0,0 +1,55 @@
+#pragma once
+#include <stdint.h>
+
+#include "SDL.h"
+
+#include "action.h"
+#include "config.h"
+
+/*
+ * Reads a game controller and translates it into the same Actions as the
+ * keyboard:
+ *
+ *   D-pad / left stick left, right, down    move left, right, soft drop
+ *   D-pad up                                 hard drop
+ *   A, Y                                     rotate counter-clockwise
+ *   B, X                                     rotate clockwise
+ *   shoulder buttons                         hold
+ *
+ * Instead of waiting for controller events, the state of the controller is
+ * read right before each simulation tick and compared to the previous one,
+ * so a press reaches the simulation as soon as the keyboard's would.
+ *
+ * The first game controller found is used; others are ignored until it is
+ * disconnected. Controllers can be connected and disconnected at any time
+ * once init() has been called.
+ */
+class Gamepad {
+  private:
+    GamepadSettings m_settings;
+    bool m_initialized = false;
+    SDL_GameController *m_controller = nullptr;
+    SDL_JoystickID m_id = -1;
+    // Press actions whose buttons are held down, one bit per Action
+    InputFrame_t m_held = 0;
+
+    void open(int device_index);
+    void close();
+    InputFrame_t readHeld() const;
+    bool stickPast(SDL_GameControllerAxis axis, int direction,
+                   bool held) const;
+
+  public:
+    Gamepad(const GamepadSettings &settings = GamepadSettings());
+    ~Gamepad();
+
+    Gamepad(const Gamepad &) = delete;
+    Gamepad &operator=(const Gamepad &) = delete;
+
+    void init();
+    void setSettings(const GamepadSettings &settings);
+    void handleEvent(const SDL_Event &e);
+    InputFrame_t poll();
+    bool isConnected() const;
+    bool isStartEvent(const SDL_Event &e) const;
+};
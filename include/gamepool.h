@@ -0,0 +1,75 @@
+#pragma once
+#include <functional>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "eval.h"
+
+// Default number of Tetrominos a bot game is cut off at
+inline const int GAME_POOL_DEFAULT_PIECES = 500;
+// Default size of the transposition table of each worker: 2^20 entries, 16 MiB
+inline const int GAME_POOL_DEFAULT_TABLE_SIZE_LOG2 = 20;
+
+/*
+ * A bot taking part in a tournament or tuning run
+ */
+struct BotConfig {
+    std::string name;
+    // Number of Tetrominos the bot looks ahead
+    int depth = 2;
+    EvalWeights weights;
+};
+
+// One game to play: a bot and the seed of its Tetromino sequence
+struct GameRequest {
+    int bot;
+    uint32_t seed;
+};
+
+struct GameResult {
+    int pieces;
+    int lines;
+    int score;
+    // Whether the game ended by topping out rather than at the piece limit
+    bool topped_out;
+};
+
+/*
+ * Mean of a sample and the half width of its 95% confidence interval
+ */
+struct Estimate {
+    double mean = 0;
+    double error = 0;
+};
+
+Estimate estimate(const std::vector<double> &sample);
+
+/*
+ * Plays bot games with the Guideline rules in a pool of worker processes.
+ * Workers are forked for each call to run(), so they see the bots exactly as
+ * the caller does, and take games one at a time from a table in shared
+ * memory, where they also put the results. Games with the same seed get the
+ * same Tetromino sequence, so results of different bots on the same seed can
+ * be compared directly. All bots of a worker share one TranspositionTable,
+ * which is kept from game to game.
+ */
+class GamePool {
+  private:
+    int m_n_workers;
+    int m_max_pieces;
+    int m_table_size_log2;
+
+  public:
+    // Called with the number of finished games whenever it changes
+    using Progress = std::function<void(int finished, int total)>;
+
+    GamePool(int n_workers = 0, int max_pieces = GAME_POOL_DEFAULT_PIECES,
+             int table_size_log2 = GAME_POOL_DEFAULT_TABLE_SIZE_LOG2);
+
+    int getWorkers() const;
+    bool run(const std::vector<BotConfig> &bots,
+             const std::vector<GameRequest> &games,
+             std::vector<GameResult> &results,
+             const Progress &progress = nullptr) const;
+};
@@ -0,0 +1,39 @@
+#pragma once
+#include <array>
+
+#include "SDL.h"
+#include "SDL_ttf.h"
+
+// Range of characters in the atlas: printable ASCII
+inline const char GLYPH_ATLAS_FIRST = ' ';
+inline const char GLYPH_ATLAS_LAST = '~';
+inline const int GLYPH_ATLAS_SIZE = GLYPH_ATLAS_LAST - GLYPH_ATLAS_FIRST + 1;
+
+/*
+ * All printable ASCII characters of a font, rendered once into a single
+ * texture. Text is then put together by copying glyphs out of the atlas,
+ * which is much cheaper than rasterizing it with SDL_ttf whenever it changes.
+ * Kerning is ignored.
+ */
+class GlyphAtlas {
+  private:
+    SDL_Texture *m_texture = nullptr;
+    // Where each glyph is in the atlas
+    std::array<SDL_Rect, GLYPH_ATLAS_SIZE> m_glyphs;
+    // Horizontal distance from one glyph to the next
+    std::array<int, GLYPH_ATLAS_SIZE> m_advances;
+    SDL_Color m_background;
+    int m_height = 0;
+
+    int index(char c) const;
+
+  public:
+    ~GlyphAtlas();
+
+    bool build(SDL_Renderer *renderer, TTF_Font *font,
+               const SDL_Color &text_color, const SDL_Color &background);
+    bool isBuilt() const;
+    int measure(const char *text) const;
+    SDL_Texture *renderText(SDL_Renderer *renderer, const char *text,
+                            int &width, int &height) const;
+};
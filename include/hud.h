@@ -1,10 +1,13 @@
+#pragma once
 #include <array>
 #include <string>
 
 #include "SDL_ttf.h"
 
 #include "constants.h"
+#include "glyphatlas.h"
 #include "scoring.h"
+#include "stats.h"
 #include "tetrovis.h"
 
 enum class TextRenderMode { SHADED, BLENDED };
@@ -21,6 +24,11 @@ class HUD {
 
     // Font
     TTF_Font *m_font;
+#ifdef GLYPH_ATLAS
+    // Built once the first frame is shown; text is rendered with the font
+    // until then
+    GlyphAtlas m_atlas;
+#endif
     // Store last value of level, goal etc. so that we know when to re-render
     int m_last_level;
     SDL_Texture *m_level_texture;
@@ -42,6 +50,13 @@ class HUD {
     SDL_Rect m_score_rect;
     void renderScore(SDL_Renderer *renderer);
 
+    // Live statistics, only shown if set
+    const LiveStats *m_stats = nullptr;
+    std::array<std::string, N_STATS_LINES> m_last_stats;
+    std::array<SDL_Texture *, N_STATS_LINES> m_stats_textures{};
+    std::array<SDL_Rect, N_STATS_LINES> m_stats_rects;
+    void renderStats(SDL_Renderer *renderer);
+
     void renderAllInfo(SDL_Renderer *renderer);
 
     SDL_Texture *m_paused_texture = nullptr;
@@ -66,8 +81,8 @@ class HUD {
     void drawGameOverOverlay(SDL_Renderer *renderer);
 
   public:
-    HUD(const std::string &assets_path, const ScoringSystem &p_scoring);
-    HUD(const std::string &assets_path, const ScoringSystem &p_scoring,
+    HUD(const ScoringSystem &p_scoring);
+    HUD(const ScoringSystem &p_scoring,
         const std::array<TetrominoKind_t, QUEUE_LEN> &queue);
     ~HUD();
 
@@ -75,5 +90,7 @@ class HUD {
 
     void setQueue(const std::array<TetrominoKind_t, QUEUE_LEN> &queue);
     void setHold(TetrominoKind_t hold);
+    void setStats(const LiveStats *stats);
+    void buildGlyphAtlas(SDL_Renderer *renderer);
     void draw(SDL_Renderer *renderer, GameState state);
 };
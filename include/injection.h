@@ -0,0 +1,86 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "action.h"
+#include "mpscqueue.h"
+
+using cl = std::chrono::steady_clock;
+
+// Injected actions that can be waiting for the next tick
+inline const int INJECTION_QUEUE_SIZE = 4096;
+
+struct InjectedAction {
+    cl::time_point time;
+    Action action;
+};
+
+/*
+ * Actions fed to a game directly rather than through SDL's event queue, e.
+ * g. by a bot. Any thread can inject actions; the game takes them at the
+ * start of every tick and applies each one at its own time, so bot inputs
+ * keep their exact timing regardless of the framerate.
+ */
+class ActionInjector {
+  private:
+    MpscQueue<InjectedAction> m_queue{INJECTION_QUEUE_SIZE};
+    // Actions taken from the queue that are due in a later tick; only used
+    // by the game thread
+    std::vector<InjectedAction> m_scheduled;
+
+  public:
+    bool inject(Action action, cl::time_point time);
+    void takeDue(cl::time_point now, std::vector<InjectedAction> &due);
+};
+
+// Magic number of action socket messages: "TAI" + protocol version
+inline const uint32_t ACTION_SOCKET_MAGIC = 0x54414901;
+
+/*
+ * Datagram sent to the action socket: this header followed by `n_actions`
+ * ActionMessages. All fields are in host byte order.
+ */
+struct ActionMessageHeader {
+    uint32_t magic;
+    uint32_t n_actions;
+};
+
+struct ActionMessage {
+    // When to apply the action, as CLOCK_MONOTONIC in nanoseconds (the clock
+    // of std::chrono::steady_clock); 0 or any time in the past applies it at
+    // the next tick
+    int64_t time_ns;
+    // Action in the order of the Action enum
+    uint8_t action;
+    uint8_t reserved[7];
+};
+
+static_assert(sizeof(ActionMessageHeader) == 8 && sizeof(ActionMessage) == 16,
+              "the message layout is part of the protocol");
+
+/*
+ * Unix domain datagram socket through which other processes inject actions.
+ * Messages are read by a thread of its own and passed to an ActionInjector.
+ */
+class ActionSocket {
+  private:
+    int m_fd = -1;
+    std::string m_path;
+    ActionInjector &m_injector;
+    std::atomic<bool> m_stop{false};
+    std::thread m_thread;
+
+    void run();
+    void handleMessage(const char *data, size_t len);
+
+  public:
+    ActionSocket(const std::string &path, ActionInjector &injector);
+    ~ActionSocket();
+
+    ActionSocket(const ActionSocket &) = delete;
+    ActionSocket &operator=(const ActionSocket &) = delete;
+};
@@ -0,0 +1,27 @@
+#pragma once
+#include <array>
+#include <stdint.h>
+#include <vector>
+
+#include "SDL.h"
+
+#include "constants.h"
+
+/*
+ * Minos and outlines of any number of boards, drawn with one call to the
+ * renderer per color instead of several calls per Mino. Meant for views with
+ * many small boards, where drawing each Mino on its own can't keep up with
+ * the framerate.
+ */
+class MinoBatch {
+  private:
+    // Filled cells by their value on the Playfield, up to GARBAGE_MINO
+    std::array<std::vector<SDL_Rect>, GARBAGE_MINO + 1> m_minos;
+    std::vector<SDL_Rect> m_outlines;
+
+  public:
+    void addMino(int x, int y, int size, uint8_t mino_type);
+    void addOutline(const SDL_Rect &rect);
+    void draw(SDL_Renderer *renderer);
+    void clear();
+};
@@ -0,0 +1,98 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "spscqueue.h"
+
+/*
+ * Bounded lock-free queue for any number of producer threads and a single
+ * consumer. Every slot carries a sequence number telling whose turn it is:
+ * producers claim a slot by advancing the shared tail with a compare and swap
+ * and then publish it through the slot's sequence, so a producer that is
+ * interrupted halfway only holds up the consumer, never other producers.
+ */
+template <class T> class MpscQueue {
+  private:
+    struct Slot {
+        // Equals the position that may be written next to this slot, or that
+        // position plus one once it has been written
+        std::atomic<size_t> sequence;
+        T item;
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    size_t m_mask;
+
+    // Next position to push to; shared by all producers
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_tail{0};
+    // Next position to pop; only used by the consumer
+    alignas(CACHE_LINE_SIZE) size_t m_head = 0;
+
+  public:
+    /**
+     * @param capacity rounded up to a power of two
+     */
+    explicit MpscQueue(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) {
+            size *= 2;
+        }
+        m_slots = std::make_unique<Slot[]>(size);
+        m_mask = size - 1;
+        for (size_t i = 0; i < size; i++) {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    /**
+     * Append an item; may be called from any thread
+     *
+     * @return false if the queue is full
+     */
+    bool push(const T &item) {
+        size_t position = m_tail.load(std::memory_order_relaxed);
+        Slot *slot;
+        while (true) {
+            slot = &m_slots[position & m_mask];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+            if (difference == 0) {
+                if (m_tail.compare_exchange_weak(position, position + 1,
+                                                 std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                // The slot still holds an item from one lap ago
+                return false;
+            } else {
+                position = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+        slot->item = item;
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Take the oldest item; only to be called by the consumer
+     *
+     * @return false if the queue is empty
+     */
+    bool pop(T &item) {
+        Slot &slot = m_slots[m_head & m_mask];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != m_head + 1) {
+            return false;
+        }
+        item = slot.item;
+        // Hand the slot to the producer of the next lap
+        slot.sequence.store(m_head + m_mask + 1, std::memory_order_release);
+        m_head++;
+        return true;
+    }
+};
@@ -0,0 +1,34 @@
+#pragma once
+#include <string>
+
+#include "sys/socket.h"
+
+/*
+ * Non-blocking datagram socket connected to a single peer. Addresses are
+ * either "unix:<path>" for a Unix domain socket or "<ipv4>:<port>" for UDP,
+ * e. g. "127.0.0.1:7000".
+ *
+ * Only works on Unix systems.
+ */
+class Connection {
+  private:
+    int m_fd = -1;
+    sockaddr_storage m_peer;
+    socklen_t m_peer_len;
+    // Path of the bound Unix domain socket, removed again on destruction
+    std::string m_unix_path;
+
+  public:
+    Connection(const std::string &bind_address,
+               const std::string &peer_address);
+    ~Connection();
+    Connection(const Connection &) = delete;
+    Connection &operator=(const Connection &) = delete;
+
+    bool send(const void *data, size_t len);
+    int receive(void *data, size_t max_len);
+    int getFd() const;
+};
+
+bool parseAddress(const std::string &address, sockaddr_storage &result,
+                  socklen_t &len);
@@ -0,0 +1,113 @@
+#pragma once
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+#include "bitboard.h"
+#include "constants.h"
+#include "placement.h"
+#include "ttable.h"
+
+// Maximum number of Tetrominos in a solution
+inline const int PC_MAX_PIECES = 15;
+// Maximum number of lines a perfect clear may span
+inline const int PC_MAX_HEIGHT = 6;
+
+// Single step of a perfect clear
+struct PerfectClearStep {
+    TetrominoKind_t kind;
+    Placement placement;
+    // Whether to hold before placing, i. e. whether `kind` is the held (or
+    // next) Tetromino instead of the active one
+    bool hold;
+};
+
+/*
+ * Searches for sequences of placements that leave the board completely
+ * empty. The Tetromino sequence is known up front (active Tetromino, hold and
+ * preview), so the search only branches on hold and placement.
+ *
+ * Branches are cut as soon as the remaining empty cells can't be filled with
+ * the Tetrominos left (cell count) or with the kinds left (column parity).
+ * Dead positions are remembered in a TranspositionTable which all worker
+ * threads share. The placements of the first Tetromino are distributed among
+ * the threads; the solution found for the earliest of them is returned, so
+ * the result doesn't depend on thread timing.
+ */
+class PerfectClearSolver {
+  private:
+    struct Worker;
+    struct Problem;
+
+    int m_n_threads;
+    TranspositionTable m_table;
+
+    static bool search(Worker &worker, const Problem &problem,
+                       const BitBoard &board, TetrominoKind_t active,
+                       TetrominoKind_t held, int next, int height, int depth);
+    static bool canStillClear(const Problem &problem, const BitBoard &board,
+                              TetrominoKind_t active, TetrominoKind_t held,
+                              int next, int height, int depth);
+    bool solveHeight(const Problem &problem,
+                     std::vector<PerfectClearStep> &solution);
+
+  public:
+    PerfectClearSolver(int n_threads = 0, int table_size_log2 = 20);
+
+    bool solve(const BitBoard &board, TetrominoKind_t active,
+               TetrominoKind_t held, bool can_hold,
+               const std::vector<TetrominoKind_t> &preview, int max_pieces,
+               std::vector<PerfectClearStep> &solution);
+};
+
+/*
+ * Runs a PerfectClearSolver on a thread of its own, so that the game thread
+ * never waits for a solution. Only the latest request is solved: a request
+ * made while another is being solved replaces any that is still waiting, and
+ * results of requests that were replaced are dropped.
+ */
+class PerfectClearWorker {
+  private:
+    struct Request {
+        // Identifies the position, handed back with the solution
+        uint64_t key;
+        BitBoard board;
+        TetrominoKind_t active;
+        TetrominoKind_t held;
+        bool can_hold;
+        std::vector<TetrominoKind_t> preview;
+        int max_pieces;
+    };
+
+    PerfectClearSolver m_solver;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    Request m_request;
+    // Incremented by every request; the worker has started on the latest
+    // one once m_solved catches up with it
+    uint64_t m_generation = 0;
+    uint64_t m_solved = 0;
+    // Solution of the latest request, if it is done and not taken yet
+    bool m_has_result = false;
+    uint64_t m_result_key = 0;
+    std::vector<PerfectClearStep> m_result;
+    bool m_stop = false;
+    std::thread m_thread;
+
+    void run();
+
+  public:
+    PerfectClearWorker();
+    ~PerfectClearWorker();
+
+    PerfectClearWorker(const PerfectClearWorker &) = delete;
+    PerfectClearWorker &operator=(const PerfectClearWorker &) = delete;
+
+    void request(uint64_t key, const BitBoard &board, TetrominoKind_t active,
+                 TetrominoKind_t held, bool can_hold,
+                 const std::vector<TetrominoKind_t> &preview, int max_pieces);
+    bool takeResult(uint64_t &key, std::vector<PerfectClearStep> &solution);
+};
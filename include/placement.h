@@ -0,0 +1,66 @@
+#pragma once
+#include <array>
+#include <stdint.h>
+#include <vector>
+
+#include "bitboard.h"
+#include "collision.h"
+#include "constants.h"
+
+// Single step of a Tetromino's movement
+enum class Move : uint8_t { Left, Right, Down, RotateClockw, RotateCounterclockw };
+
+/*
+ * Final position of a Tetromino, i. e. one where it can't step down anymore
+ */
+struct Placement {
+    int8_t x, y;
+    uint8_t orientation;
+    // Whether the last move into this position was a rotation
+    bool spin;
+};
+
+/*
+ * Finds all positions a Tetromino can lock down at, starting from the spawn
+ * position and using any sequence of shifts, soft drops and SRS rotations
+ * (including tucks and spins). Positions that occupy the same cells are only
+ * reported once.
+ */
+template <class Board> class BasicPlacementEnumerator {
+  private:
+    using Size = typename Board::Size;
+    // Search space; x and y are offset so that Tetrominos sticking out of the
+    // top and left of the board still have non-negative indices
+    static const int OFFSET = 3;
+    static const int SIZE_X = Size::WIDTH + OFFSET;
+    static const int SIZE_Y = Size::HEIGHT + OFFSET;
+    static const int N_STATES = 4 * SIZE_X * SIZE_Y;
+
+    struct Node {
+        int8_t x, y;
+        uint8_t orientation;
+        bool spin;
+    };
+    // Breadth first search state, reused between calls to avoid allocations
+    std::vector<uint8_t> m_visited;
+    std::vector<uint8_t> m_locked;
+    std::vector<int16_t> m_parent;
+    std::vector<Move> m_parent_move;
+    std::vector<Node> m_queue;
+
+    static int index(int x, int y, uint8_t orientation);
+    bool visit(const Node &node, int parent, Move move);
+    bool tryRotate(const Board &board, TetrominoKind_t kind, const Node &from,
+                   int8_t direction, Node &result);
+
+  public:
+    BasicPlacementEnumerator();
+
+    int enumerate(const Board &board, TetrominoKind_t kind,
+                  std::vector<Placement> &result);
+    void getPath(const Placement &placement, std::vector<Move> &path) const;
+};
+
+// Searching on a CollisionMap is about twice as fast as on a BitBoard, even
+// when the map is built just for one search
+using PlacementEnumerator = BasicPlacementEnumerator<CollisionMap>;
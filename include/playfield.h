@@ -3,11 +3,26 @@
 
 #include "SDL.h"
 
+#include "bitboard.h"
+#include "boardsize.h"
+#include "collision.h"
 #include "constants.h"
+#include "minobatch.h"
 
-class Playfield {
-    uint8_t m_grid[GRID_SIZE_Y][GRID_SIZE_X];
+template <int Width, int Height> class BasicPlayfield {
+  public:
+    using Size = BoardSize<Width, Height>;
+
+  private:
+    uint8_t m_grid[Height][Width];
     int m_draw_x, m_draw_y; // Where to draw the p_playfield on the screen
+    int m_cell_size = CELL_SIZE;
+    // Zobrist hash of the occupied cells, updated whenever a cell changes
+    uint64_t m_hash;
+    // Poses that fit on the current cells; rebuilt when first needed after
+    // a cell changed
+    mutable BasicCollisionMap<Width, Height> m_collisions;
+    mutable bool m_collisions_valid = false;
 
     void drawOutline(SDL_Renderer *renderer);
     void drawPlayfield(SDL_Renderer *renderer);
@@ -18,8 +33,8 @@ class Playfield {
     void setAtHard(int x, int y, uint8_t mino_type);
 
   public:
-    Playfield();
-    Playfield(int draw_x, int draw_y);
+    BasicPlayfield();
+    BasicPlayfield(int draw_x, int draw_y);
 
     /**
      * Reset the Playfield to its initial state
@@ -27,16 +42,26 @@ class Playfield {
     void reset();
 
     uint8_t getAt(int x, int y);
+    uint64_t getHash() const;
+    BasicBitBoard<Width, Height> getBitBoard() const;
     bool isObstructed(int x, int y);
+    const BasicCollisionMap<Width, Height> &getCollisionMap() const;
+    bool fits(TetrominoKind_t kind, uint8_t orientation, int x, int y) const;
+    int dropY(TetrominoKind_t kind, uint8_t orientation, int x, int y) const;
     bool setAt(int x, int y, uint8_t mino_type);
     void clearAt(int x, int y);
     int clearEmptyLines();
+    bool addGarbage(int n_lines, int hole_x);
 
     void draw(SDL_Renderer *renderer);
-    void setDrawPosition(int x, int y);
+    void draw(MinoBatch &batch) const;
+    void setDrawPosition(int x, int y, int cell_size = CELL_SIZE);
 
     std::array<int, 2> cellToPixelPosition(int cell_x, int cell_y);
     static void drawMino(SDL_Renderer *renderer, int x, int y,
-                         const SDL_Color &color);
+                         const SDL_Color &color, int size = CELL_SIZE);
     static void drawGhostMino(SDL_Renderer *renderer, int x, int y);
 };
+
+using Playfield = BasicPlayfield<GRID_SIZE_X, GRID_SIZE_Y>;
+using WidePlayfield = BasicPlayfield<WIDE_GRID_SIZE_X, GRID_SIZE_Y>;
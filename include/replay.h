@@ -0,0 +1,128 @@
+#pragma once
+#include <chrono>
+#include <iosfwd>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "action.h"
+#include "config.h"
+#include "timer.h"
+
+class Simulation;
+
+// Magic number at the start of a replay file: "TRP" + format version. Any
+// change to the format below, or to the Tetrominos a seed deals, has to
+// change the version.
+inline const uint32_t REPLAY_MAGIC = 0x54525002;
+
+// Size of the header in front of the records
+inline const size_t REPLAY_HEADER_SIZE = 32;
+// Every this many ticks, a replay stores the checksum of the Simulation
+inline const int REPLAY_CHECKSUM_INTERVAL = 60;
+
+// Tags of the records of a replay; smaller tags are actions
+inline const uint8_t REPLAY_UPDATE = 0x40;
+inline const uint8_t REPLAY_CHECKED_UPDATE = 0x41;
+inline const uint8_t REPLAY_PAUSE = 0x42;
+inline const uint8_t REPLAY_RESUME = 0x43;
+inline const uint8_t REPLAY_END = 0x44;
+
+/*
+ * Replays record every call into a Simulation, so that playing them back on a
+ * new Simulation reproduces the game exactly. All numbers are little endian.
+ *
+ *   4       REPLAY_MAGIC
+ *   4       seed
+ *   3 * 8   handling: das_ms, arr_ms and soft_drop_factor as IEEE doubles
+ *
+ * The header is followed by records, each a tag and, except for REPLAY_END,
+ * the time of the call in nanoseconds since the last record's (or since the
+ * game started), as a zigzag encoded LEB128 varint:
+ *
+ *   0 .. N_ACTIONS - 1      apply() with that action
+ *   REPLAY_UPDATE           update()
+ *   REPLAY_CHECKED_UPDATE   update(), then 4 bytes with the checksum the
+ *                           Simulation had before it; used for every
+ *                           REPLAY_CHECKSUM_INTERVAL-th update
+ *   REPLAY_PAUSE            pause()
+ *   REPLAY_RESUME           resume()
+ *   REPLAY_END              end of the game, followed by the final score,
+ *                           lines, level and number of locked Tetrominos as
+ *                           varints and 4 bytes with the final checksum
+ */
+
+/*
+ * Records the game of a Simulation it is set on, see
+ * Simulation::setRecorder(). Recording starts at every restart and stops
+ * when the replay is finished.
+ */
+class ReplayRecorder {
+  private:
+    std::vector<uint8_t> m_data;
+    cl::time_point m_last;
+    uint64_t m_updates = 0;
+
+    void putRecord(uint8_t tag, cl::time_point now);
+
+  public:
+    void onRestart(cl::time_point now, uint32_t seed,
+                   const Handling &handling);
+    void onAction(Action action, cl::time_point now);
+    void onUpdate(Simulation &sim, cl::time_point now);
+    void onPause(cl::time_point now);
+    void onResume(cl::time_point now);
+
+    bool finish(Simulation &sim, std::vector<uint8_t> &replay);
+};
+
+/*
+ * Outcome of playing a replay back
+ */
+struct ReplayResult {
+    // Final values recorded in the replay
+    int32_t score, lines, level, pieces;
+    // The same after playing it back
+    int32_t replayed_score, replayed_lines, replayed_level, replayed_pieces;
+    // Number of ticks played back and the time they spanned in the game
+    uint64_t ticks;
+    int64_t duration_ms;
+    // First tick whose checksum differed from the recorded one, -1 if none
+    // did; the Simulations diverged in this tick or, at most
+    // REPLAY_CHECKSUM_INTERVAL ticks, before it
+    int64_t desync_tick;
+    // Last tick whose checksum matched before that, -1 if none did
+    int64_t last_good_tick;
+};
+
+/*
+ * A recorded game, loaded from a replay file
+ */
+class Replay {
+  private:
+    std::vector<uint8_t> m_data;
+    uint32_t m_seed;
+    Handling m_handling;
+
+  public:
+    Replay(const std::string &path);
+
+    uint32_t getSeed() const;
+    bool play(ReplayResult &result, std::ostream *dump = nullptr) const;
+};
+
+/*
+ * A replay played back by verifyReplays()
+ */
+struct ReplayCheck {
+    std::string path;
+    // Why the replay couldn't be played back, empty if it could
+    std::string error;
+    ReplayResult result;
+    // State of the game at the first differing checksum, if asked for
+    std::string dump;
+};
+
+void verifyReplays(const std::vector<std::string> &paths, int n_threads,
+                   bool dump, std::vector<ReplayCheck> &checks);
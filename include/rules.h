@@ -0,0 +1,148 @@
+#pragma once
+#include <algorithm>
+
+#include "constants.h"
+
+/*
+ * Compile-time policies for the rules of the game. They are plain structs with
+ * static inline functions, so templated code like SimCore gets them inlined.
+ * The interactive game wraps them in the virtual ScoringSystem instead.
+ */
+
+// Score related state shared by all scoring rules
+struct ScoreState {
+    int level;
+    int goal;
+    int score;
+    int lines;
+    bool b2b = false; // Whether a back-to-back sequence is currently active
+};
+
+/*
+ * Scoring of the Tetris Guideline with a fixed goal of LINES_PER_LEVEL lines
+ * per level
+ */
+struct FixedGoalRule {
+    static ScoreState initial(int starting_level) {
+        ScoreState state;
+        state.level = starting_level;
+        // When starting on a level higher than one, the first goal is equal to
+        // the sum of all the goals up to the current one
+        // TODO: Implement this (i.e. uncomment that second part)
+        state.goal = 5; // starting_level * LINES_PER_LEVEL;
+        state.score = 0;
+        state.lines = 0;
+        return state;
+    }
+
+    /**
+     * Award points depending on whether a back-to-back sequence is active
+     */
+    static void awardAction(ScoreState &state, int points) {
+        if (state.b2b) {
+            points = (int)(points * 1.5);
+        }
+        state.score += points;
+    }
+
+    static void onLinesCleared(ScoreState &state, int n_lines) {
+        // Award points for line clear
+        if (n_lines > 0) {
+            // A line clear that doesn't clear 4 lines at once end's a
+            // back-to-back sequence
+            state.b2b = n_lines == 4;
+            awardAction(state, LINE_CLEAR_REWARD[n_lines - 1] * state.level);
+        }
+
+        // If the amount of cleared lines is bigger than the current goal,
+        // subtract the 'overhead' from the subsequent goal
+        int overhead = n_lines - state.goal;
+        // Subtract cleared lines from current goal
+        state.goal = std::max(state.goal - n_lines, 0);
+
+        // Current goal was reached
+        if (overhead >= 0) {
+            // Increase level
+            state.level++;
+            // Set new goal
+            state.goal = LINES_PER_LEVEL;
+            state.goal -= overhead;
+        }
+
+        state.lines += n_lines;
+    }
+
+    static void onTSpin(ScoreState &state, int n_lines_cleared) {
+        awardAction(state, T_SPIN_REWARD[n_lines_cleared]);
+    }
+
+    static void onMiniTSpin(ScoreState &state, int n_lines_cleared) {
+        awardAction(state, MINI_T_SPIN_REWARD[n_lines_cleared]);
+    }
+
+    static void onSoftDrop(ScoreState &state) {
+        state.score++;
+    }
+
+    static void onHardDrop(ScoreState &state, int n_lines) {
+        state.score += n_lines * 2;
+    }
+};
+
+/*
+ * Only counts cleared lines, as score and as lines. Levels never change.
+ * Useful for bots that should survive and clear as much as possible.
+ */
+struct LinesOnlyRule {
+    static ScoreState initial(int starting_level) {
+        return {starting_level, 0, 0, 0, false};
+    }
+    static void onLinesCleared(ScoreState &state, int n_lines) {
+        state.score += n_lines;
+        state.lines += n_lines;
+    }
+    static void onTSpin(ScoreState &state, int n_lines_cleared) {
+        onLinesCleared(state, n_lines_cleared);
+    }
+    static void onMiniTSpin(ScoreState &state, int n_lines_cleared) {
+        onLinesCleared(state, n_lines_cleared);
+    }
+    static void onSoftDrop(ScoreState &) {}
+    static void onHardDrop(ScoreState &, int) {}
+};
+
+/*
+ * Fall delay per level according to the Tetris Guideline
+ */
+struct GuidelineGravity {
+    static int fallDelayMs(int level) {
+        // clang-format off
+        switch (level) {
+        case 1:  return 1000;
+        case 2:  return 793;
+        case 3:  return 618;
+        case 4:  return 473;
+        case 5:  return 355;
+        case 6:  return 262;
+        case 7:  return 190;
+        case 8:  return 135;
+        case 9:  return 94;
+        case 10: return 64;
+        case 11: return 43;
+        case 12: return 28;
+        case 13: return 18;
+        case 14: return 11;
+        default: return 7;
+        }
+        // clang-format on
+    }
+};
+
+/*
+ * The same fall delay on every level
+ */
+template <int DelayMs> struct ConstantGravity {
+    static int fallDelayMs(int) {
+        return DelayMs;
+    }
+};
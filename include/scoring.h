@@ -1,15 +1,11 @@
 #pragma once
 
+#include "rules.h"
+
 class ScoringSystem {
   protected:
-    int m_level;
-    int m_goal;
-    int m_score;
-    int m_lines;
-    bool m_b2b = false; // Whether a back-to-back sequence is currently active
+    ScoreState m_state;
     int m_fall_speed_ms;
-    void updateFallSpeed();
-    void awardAction(int points);
 
   public:
     int getLevel() const;
@@ -17,16 +13,52 @@ class ScoringSystem {
     int getScore() const;
     int getLines() const;
     int getFallSpeedMs() const;
-    void onSoftDrop();
-    void onHardDrop(int n_lines);
-    void onTSpin(int n_lines_cleared);
-    void onMiniTSpin(int n_lines_cleared);
+    const ScoreState &getState() const;
+    virtual void onSoftDrop() = 0;
+    virtual void onHardDrop(int n_lines) = 0;
+    virtual void onTSpin(int n_lines_cleared) = 0;
+    virtual void onMiniTSpin(int n_lines_cleared) = 0;
     // This is dependent on the specific scoring system, so subclasses must
     // define it
     virtual void onLinesCleared(int n_lines) = 0;
 };
 
-class FixedGoalScoring : public ScoringSystem {
+/*
+ * Scoring system of the interactive game. Delegates to a scoring rule and a
+ * gravity curve, which can also be used directly as compile-time policies.
+ */
+template <class Rule, class Gravity>
+class RuleScoring : public ScoringSystem {
+  public:
+    RuleScoring(int starting_level) {
+        m_state = Rule::initial(starting_level);
+        updateFallSpeed();
+    }
+
+    void onSoftDrop() override {
+        Rule::onSoftDrop(m_state);
+    }
+    void onHardDrop(int n_lines) override {
+        Rule::onHardDrop(m_state, n_lines);
+    }
+    void onTSpin(int n_lines_cleared) override {
+        Rule::onTSpin(m_state, n_lines_cleared);
+    }
+    void onMiniTSpin(int n_lines_cleared) override {
+        Rule::onMiniTSpin(m_state, n_lines_cleared);
+    }
+    void onLinesCleared(int n_lines) override {
+        Rule::onLinesCleared(m_state, n_lines);
+        updateFallSpeed();
+    }
+
+  protected:
+    void updateFallSpeed() {
+        m_fall_speed_ms = Gravity::fallDelayMs(m_state.level);
+    }
+};
+
+class FixedGoalScoring : public RuleScoring<FixedGoalRule, GuidelineGravity> {
   public:
     FixedGoalScoring();
     FixedGoalScoring(int starting_level);
@@ -0,0 +1,128 @@
+#pragma once
+#include <condition_variable>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <sys/types.h>
+#include <thread>
+#include <vector>
+
+/*
+ * Result of a single finished game
+ */
+struct SessionRecord {
+    // End of the game in milliseconds since the Unix epoch
+    uint64_t end_time;
+    uint32_t seed;
+    int32_t score;
+    int32_t lines;
+    int32_t level;
+    int32_t pieces;
+    // Play time in milliseconds, not counting pauses
+    uint32_t duration_ms;
+    // Name of the replay of the game, empty if none was recorded
+    char replay[32];
+};
+
+/*
+ * Entry of the session log file: a record and a checksum over it. Entries
+ * are only ever appended, so a crash can at most leave a torn entry at the
+ * end of the file, which is detected by the checksum and cut off when the log
+ * is opened again.
+ */
+struct SessionLogEntry {
+    uint32_t magic;
+    uint32_t crc;
+    SessionRecord record;
+};
+
+inline const uint32_t SESSION_LOG_MAGIC = 0x544c4701; // "TLG" + version 1
+
+/*
+ * Entry of the session index: where to find a record in the log and the keys
+ * it is sorted by
+ */
+struct SessionIndexEntry {
+    int32_t score;
+    uint32_t seed;
+    uint32_t record;
+};
+
+/*
+ * Header of the session index file. It is followed by two arrays of
+ * `capacity` entries each, the first sorted by descending score and the
+ * second by seed and then by descending score.
+ */
+struct SessionIndexHeader {
+    uint32_t magic;
+    // Set while the index is being modified; a dirty index is rebuilt
+    uint32_t dirty;
+    // Number of log entries covered by the index
+    uint32_t count;
+    uint32_t capacity;
+};
+
+inline const uint32_t SESSION_INDEX_MAGIC = 0x54494401; // "TID" + version 1
+inline const uint32_t SESSION_INDEX_MIN_CAPACITY = 1024;
+
+/*
+ * Append-only log of finished games, with a memory mapped index for looking up
+ * the best games overall or for one seed.
+ *
+ * Records are written by a background thread, so that `append()` never waits
+ * for the disk. The index lives next to the log (with ".idx" appended to the
+ * path) and is rebuilt from the log whenever it is missing or out of date.
+ */
+class SessionLog {
+  private:
+    std::string m_path;
+    int m_log_fd = -1;
+    int m_index_fd = -1;
+    uint32_t m_count = 0;
+    // Set when a failed write couldn't be undone; nothing is written then
+    bool m_broken = false;
+
+    // Memory mapped index file
+    SessionIndexHeader *m_index = nullptr;
+    size_t m_index_size = 0;
+    SessionIndexEntry *byScore() const;
+    SessionIndexEntry *bySeed() const;
+    // Guards the index and the log file descriptor
+    mutable std::mutex m_file_mutex;
+
+    // Records waiting to be written
+    std::vector<SessionRecord> m_pending;
+    std::mutex m_pending_mutex;
+    std::condition_variable m_pending_cv;
+    // Whether the writer thread is busy with records taken from m_pending
+    bool m_writing = false;
+    bool m_stop = false;
+    std::thread m_writer;
+
+    uint32_t recover(uint32_t first);
+    void cutOff(uint32_t count, off_t size);
+    bool read(uint32_t record, SessionLogEntry &entry) const;
+    void openIndex();
+    void rebuildIndex();
+    void mapIndex(uint32_t capacity);
+    void unmapIndex();
+    void insertIndex(const SessionIndexEntry &entry);
+    void write(const std::vector<SessionRecord> &records);
+    void run();
+
+  public:
+    SessionLog(const std::string &path);
+    ~SessionLog();
+
+    SessionLog(const SessionLog &) = delete;
+    SessionLog &operator=(const SessionLog &) = delete;
+
+    void append(const SessionRecord &record);
+    void flush();
+
+    size_t size() const;
+    bool read(uint32_t record, SessionRecord &result) const;
+    void top(size_t n, std::vector<SessionRecord> &result) const;
+    void topForSeed(uint32_t seed, size_t n,
+                    std::vector<SessionRecord> &result) const;
+};
@@ -0,0 +1,201 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <iosfwd>
+#include <random>
+
+#include "SDL.h"
+
+#include "action.h"
+#include "active.h"
+#include "bag.h"
+#include "config.h"
+#include "constants.h"
+#include "placement.h"
+#include "playfield.h"
+#include "scoring.h"
+#include "timer.h"
+#include "tspin.h"
+
+class EventBus;
+class ReplayRecorder;
+enum class GameEventType : uint8_t;
+
+/*
+ * Where a Tetromino was locked down and what it cleared
+ */
+struct LockInfo {
+    TetrominoKind_t kind;
+    Placement placement;
+    int cleared;
+    TSpinType t_spin;
+    // Garbage lines sent by this lock down, before cancelling
+    int attack;
+};
+
+/*
+ * Complete state of a Simulation at one point in time. Restoring a snapshot
+ * and feeding the same actions at the same times reproduces the same game,
+ * which is what rollback in versus mode relies on.
+ */
+struct SimSnapshot {
+    GameState state;
+    cl::time_point now;
+    Playfield playfield;
+    // Pose of the active Tetromino
+    int active_x, active_y;
+    uint8_t active_orientation;
+    uint8_t active_type;
+    SevenBag bag;
+    FixedGoalScoring scoring;
+    cl::time_point next_fall, next_soft_drop, lock_down;
+    cl::time_point next_mv_right, next_mv_left;
+    bool soft_dropping, surface_contact;
+    bool moving_right, moving_left, right_held, left_held;
+    int last_rotation_point;
+    bool last_spin;
+    TetrominoKind_t held;
+    bool can_hold;
+    int pending_garbage, outgoing_garbage;
+    std::minstd_rand garbage_rng;
+    int n_locks;
+    LockInfo last_lock;
+};
+
+/*
+ * Game mechanics without any presentation. The simulation never reads the
+ * clock itself: every call receives the current time, so it can be driven by
+ * the wall clock for interactive play or by a tick counter for versus play.
+ */
+class Simulation {
+  private:
+    GameState m_state = GameState::PreInit;
+    // Time of the last call into the simulation
+    cl::time_point m_now;
+
+    // When to perform the next fall step
+    Timer m_next_fall;
+    // When to perform the next soft drop step
+    Timer m_next_soft_drop;
+    // Whether the Tetromino is currently Soft Dropping, i. e. the down arrow
+    // key is m_held
+    bool m_soft_dropping = false;
+    // When to lock down the active Tetromino
+    Timer m_lock_down;
+    // Whether the active Tetromino is currently in contact with a Mino on the
+    // Playfield; used in combination with m_lock_down Timer
+    bool m_surface_contact = false;
+    void startSoftDropping();
+    void stopSoftDropping();
+    bool performSoftDrop();
+    void performSoftDrops(cl::time_point now);
+    void incSoftDropTimer();
+    void resetSoftDropTimer();
+    cl::duration getSoftDropDelay() const;
+
+    bool performFall();
+    void incFallTimer();
+    void resetFallTimer();
+
+    void scheduleLockDown();
+    void lockDownAndRespawnActive();
+    bool respawnActive();
+    bool respawnActiveWithKind(TetrominoKind_t kind);
+
+    // Horizontal movement
+    bool m_moving_right = false;
+    bool m_moving_left = false;
+    // Whether the movement keys are physically held; used to resume moving in
+    // the other direction when one of them is released
+    bool m_right_held = false;
+    bool m_left_held = false;
+    Timer m_next_mv_right;
+    Timer m_next_mv_left;
+    void initMoveLeft();
+    void stopMoveLeft();
+    void moveLeft();
+    void initMoveRight();
+    void stopMoveRight();
+    void moveRight();
+    void repeatMove(Timer &timer, bool (Active::*move)(), cl::time_point now);
+    Handling m_handling;
+
+    // T-Spins
+    // Store the last rotation point (a value in the range [0, 4] determined by
+    // what rotation was used by SRS)
+    int m_last_rotation_point = 0;
+    // Whether the last action was a spin
+    bool m_last_spin = false;
+    // Check if the last action was a T-Spin or a Mini T-Spin and award points
+    // accordingly
+    int checkTSpin();
+
+    void hold();
+    TetrominoKind_t m_held = -1;
+    bool m_can_hold = true;
+
+    // Garbage
+    // Lines received from the opponent that will be inserted at the next lock
+    // down which doesn't clear any lines
+    int m_pending_garbage = 0;
+    // Lines sent to the opponent that haven't been collected yet
+    int m_outgoing_garbage = 0;
+    std::minstd_rand m_garbage_rng;
+    void sendGarbage(int n_lines);
+    void insertPendingGarbage();
+
+    SevenBag m_bag;
+    FixedGoalScoring m_scoring = FixedGoalScoring(1);
+
+    // Number of Tetrominos locked down since the start of the game
+    int m_n_locks = 0;
+    LockInfo m_last_lock{};
+
+    // Where events are published, if anywhere
+    EventBus *m_events = nullptr;
+    void publish(GameEventType type, const LockInfo &lock);
+
+    // Where calls into the simulation are recorded, if anywhere
+    ReplayRecorder *m_recorder = nullptr;
+
+  public:
+    Simulation();
+    Simulation(uint32_t seed);
+
+    Playfield playfield;
+    Active active;
+
+    void setHandling(const Handling &handling);
+    const Handling &getHandling() const;
+    void setEventBus(EventBus *events);
+    void setRecorder(ReplayRecorder *recorder);
+
+    void restart(cl::time_point now);
+    void restart(cl::time_point now, uint32_t seed);
+    void update(cl::time_point now);
+    void apply(Action action, cl::time_point now);
+    void apply(InputFrame_t input, cl::time_point now);
+    void pause(cl::time_point now);
+    void resume(cl::time_point now);
+
+    GameState getState() const;
+    cl::time_point getTime() const;
+    const ScoringSystem &getScoring() const;
+    std::array<TetrominoKind_t, QUEUE_LEN> getQueue();
+    TetrominoKind_t getHeld() const;
+    bool canHold() const;
+    int getLockCount() const;
+    const LockInfo &getLastLock() const;
+    uint64_t getHash();
+    uint32_t getChecksum();
+    void dump(std::ostream &out);
+
+    void receiveGarbage(int n_lines);
+    int takeOutgoingGarbage();
+    int getPendingGarbage() const;
+
+    void save(SimSnapshot &snapshot) const;
+    void load(const SimSnapshot &snapshot);
+
+    void draw(SDL_Renderer *renderer);
+};
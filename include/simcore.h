@@ -0,0 +1,137 @@
+#pragma once
+#include <stdint.h>
+
+#include "bag.h"
+#include "bitboard.h"
+#include "constants.h"
+#include "placement.h"
+#include "rules.h"
+#include "tspin.h"
+
+/**
+ * Check whether locking a T Tetromino at a placement is a T-Spin, using the
+ * same corner rules as Simulation
+ */
+inline TSpinType detectTSpin(const BitBoard &board, TetrominoKind_t kind,
+                             const Placement &placement) {
+    if (kind != T_KIND || !placement.spin) {
+        return NoTSpin;
+    }
+    return T_SPIN_TABLE[placement.orientation]
+                       [getCornerMask(board, placement.x, placement.y)];
+}
+
+/*
+ * Headless game that advances one placement at a time instead of one tick at
+ * a time. The scoring rule and gravity curve are compile-time policies (see
+ * rules.h), so common configurations are fully inlined; this is what bots,
+ * solvers and tuners simulate millions of placements with.
+ */
+template <class Rule, class Gravity> class SimCore {
+  private:
+    SevenBag m_bag;
+    TetrominoKind_t m_active;
+    TetrominoKind_t m_held = 255;
+    bool m_can_hold = true;
+    ScoreState m_score;
+    bool m_over = false;
+    int m_pieces = 0;
+    // Time gravity alone would have taken to bring the Tetrominos down
+    int64_t m_gravity_ms = 0;
+
+    void spawn(TetrominoKind_t kind) {
+        m_active = kind;
+        if (!board.fits(kind, 0, STARTING_POSITION_X, STARTING_POSITION_Y)) {
+            // Block Out
+            m_over = true;
+        }
+    }
+
+  public:
+    BitBoard board;
+
+    SimCore(uint32_t seed, int starting_level = 1)
+        : m_bag(seed), m_score(Rule::initial(starting_level)) {
+        spawn(m_bag.popQueue());
+    }
+
+    /**
+     * Swap the active Tetromino with the held one (or the next one, if none
+     * is held)
+     *
+     * @return whether holding was allowed
+     */
+    bool hold() {
+        if (!m_can_hold) {
+            return false;
+        }
+        m_can_hold = false;
+        TetrominoKind_t active = m_active;
+        spawn(m_held == 255 ? m_bag.popQueue() : m_held);
+        m_held = active;
+        return true;
+    }
+
+    /**
+     * Lock the active Tetromino at a placement, which must be reachable,
+     * clear lines and spawn the next Tetromino
+     *
+     * @return the number of cleared lines
+     */
+    int place(const Placement &placement) {
+        TSpinType t_spin = detectTSpin(board, m_active, placement);
+        board.place(m_active, placement.orientation, placement.x, placement.y);
+        int cleared = board.clearLines();
+        // Score as if the Tetromino was hard dropped from where it spawned
+        int distance = placement.y - STARTING_POSITION_Y;
+        Rule::onHardDrop(m_score, std::max(distance, 0));
+        m_gravity_ms += (int64_t)std::max(distance, 0) *
+                        Gravity::fallDelayMs(m_score.level);
+        switch (t_spin) {
+        case NoTSpin:
+            Rule::onLinesCleared(m_score, cleared);
+            break;
+        case MiniTSpin:
+            Rule::onMiniTSpin(m_score, cleared);
+            break;
+        case FullTSpin:
+            Rule::onTSpin(m_score, cleared);
+            break;
+        }
+        m_pieces++;
+        m_can_hold = true;
+        spawn(m_bag.popQueue());
+        return cleared;
+    }
+
+    TetrominoKind_t getActive() const {
+        return m_active;
+    }
+    TetrominoKind_t getHeld() const {
+        return m_held;
+    }
+    bool canHold() const {
+        return m_can_hold;
+    }
+    std::array<TetrominoKind_t, QUEUE_LEN> getQueue() {
+        return m_bag.getQueue();
+    }
+    const ScoreState &getScore() const {
+        return m_score;
+    }
+    bool isOver() const {
+        return m_over;
+    }
+    int getPieces() const {
+        return m_pieces;
+    }
+    int getFallDelayMs() const {
+        return Gravity::fallDelayMs(m_score.level);
+    }
+    int64_t getGravityMs() const {
+        return m_gravity_ms;
+    }
+};
+
+// The rules of the interactive game
+using GuidelineCore = SimCore<FixedGoalRule, GuidelineGravity>;
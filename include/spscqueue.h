@@ -0,0 +1,86 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <stddef.h>
+
+// Size of a cache line, to keep data written by different threads apart
+inline const size_t CACHE_LINE_SIZE = 64;
+
+/*
+ * Bounded lock-free queue for exactly one producer and one consumer thread.
+ * Neither side ever blocks or allocates: pushing to a full queue fails and
+ * popping from an empty one does, too. The indices only ever grow and are
+ * masked into the ring, so a full queue is told apart from an empty one
+ * without wasting a slot.
+ */
+template <class T> class SpscQueue {
+  private:
+    std::unique_ptr<T[]> m_items;
+    size_t m_mask;
+
+    // Next item to pop; written by the consumer only
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_head{0};
+    // Producer's copy of m_head, so that it only has to read the consumer's
+    // cache line when the queue looks full
+    size_t m_head_cache = 0;
+    // Next slot to push to; written by the producer only
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_tail{0};
+    // Consumer's copy of m_tail
+    size_t m_tail_cache = 0;
+
+  public:
+    /**
+     * @param capacity rounded up to a power of two
+     */
+    explicit SpscQueue(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) {
+            size *= 2;
+        }
+        m_items = std::make_unique<T[]>(size);
+        m_mask = size - 1;
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    size_t capacity() const {
+        return m_mask + 1;
+    }
+
+    /**
+     * Append an item; only to be called by the producer
+     *
+     * @return false if the queue is full
+     */
+    bool push(const T &item) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head_cache > m_mask) {
+            m_head_cache = m_head.load(std::memory_order_acquire);
+            if (tail - m_head_cache > m_mask) {
+                return false;
+            }
+        }
+        m_items[tail & m_mask] = item;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Take the oldest item; only to be called by the consumer
+     *
+     * @return false if the queue is empty
+     */
+    bool pop(T &item) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail_cache) {
+            m_tail_cache = m_tail.load(std::memory_order_acquire);
+            if (head == m_tail_cache) {
+                return false;
+            }
+        }
+        item = m_items[head & m_mask];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+};
@@ -0,0 +1,125 @@
+#pragma once
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+
+#include "constants.h"
+
+// Magic number at the start of the segment: "TSE" + layout version. Any
+// change to the layout below has to change the version.
+inline const uint32_t STATE_EXPORT_MAGIC = 0x54534501;
+inline const char *const STATE_EXPORT_DEFAULT_NAME = "/tetris-state";
+
+/*
+ * State of a single player game as seen by external tools. All fields have a
+ * fixed size and there is no padding, so the layout is the same for readers
+ * written in any language:
+ *
+ *   offset  size  field
+ *        0     8  tick
+ *        8     8  time_ns
+ *       16     4  score, lines, level, pieces, pending_garbage,
+ *                 active_x, active_y, ghost_y (each)
+ *       48     1  state, active_kind, active_orientation, held, can_hold,
+ *                 queue[3] (each)
+ *       56   400  cells[40][10]
+ *
+ * Tetromino kinds are numbered I, J, L, O, S, T, Z from 0 to 6.
+ */
+struct ExportedState {
+    // Goes up by one whenever the state is published, i. e. once per tick
+    uint64_t tick;
+    // Simulation time in nanoseconds of the game's steady clock
+    int64_t time_ns;
+    int32_t score;
+    int32_t lines;
+    int32_t level;
+    // Tetrominos locked down since the start of the game
+    int32_t pieces;
+    // Garbage lines about to be inserted
+    int32_t pending_garbage;
+    // Cell of the top left corner of the active Tetromino's 4x4 box, and the
+    // row that corner would land on
+    int32_t active_x;
+    int32_t active_y;
+    int32_t ghost_y;
+    // 0: not started, 1: running, 2: paused, 3: game over
+    uint8_t state;
+    uint8_t active_kind;
+    // 0: spawn orientation, 1-3: rotated clockwise that many times
+    uint8_t active_orientation;
+    // 255 if nothing is held
+    uint8_t held;
+    // 1 if the active Tetromino may be held
+    uint8_t can_hold;
+    uint8_t queue[QUEUE_LEN];
+    // Kind of Tetromino each locked Mino belongs to, EMPTY_MINO (7) for empty
+    // cells. Row 0 is the top of the buffer zone above the visible rows,
+    // which start at row GRID_START_Y (20).
+    uint8_t cells[GRID_SIZE_Y][GRID_SIZE_X];
+};
+
+static_assert(std::is_standard_layout_v<ExportedState> &&
+                  sizeof(ExportedState) == 456,
+              "the exported layout is fixed; change STATE_EXPORT_MAGIC");
+
+/*
+ * The shared memory segment. Readers have to check `magic` and `size` before
+ * looking at the state.
+ *
+ * The state is guarded by a seqlock: `sequence` is odd while the game writes
+ * the state and goes up by two with every update. A reader copies the state
+ * between two reads of an even `sequence` and retries if the two differ, so
+ * the game never waits for readers.
+ */
+struct StateSegment {
+    uint32_t magic;
+    uint32_t size;
+    std::atomic<uint32_t> sequence;
+    uint32_t reserved;
+    ExportedState state;
+};
+
+static_assert(offsetof(StateSegment, state) == 16 &&
+                  std::atomic<uint32_t>::is_always_lock_free,
+              "the segment layout is fixed");
+
+/*
+ * Publishes the state of a game in a POSIX shared memory segment. The
+ * segment is removed when the export is destroyed; readers that still have it
+ * mapped keep their view of the last state.
+ */
+class StateExport {
+  private:
+    std::string m_name;
+    StateSegment *m_segment = nullptr;
+    uint64_t m_tick = 0;
+
+  public:
+    StateExport(const std::string &name = STATE_EXPORT_DEFAULT_NAME);
+    ~StateExport();
+
+    StateExport(const StateExport &) = delete;
+    StateExport &operator=(const StateExport &) = delete;
+
+    void publish(const ExportedState &state);
+};
+
+/*
+ * Reading end of a StateExport, for tools
+ */
+class StateExportReader {
+  private:
+    const StateSegment *m_segment = nullptr;
+
+  public:
+    StateExportReader(const std::string &name = STATE_EXPORT_DEFAULT_NAME);
+    ~StateExportReader();
+
+    StateExportReader(const StateExportReader &) = delete;
+    StateExportReader &operator=(const StateExportReader &) = delete;
+
+    bool read(ExportedState &state) const;
+};
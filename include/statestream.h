@@ -0,0 +1,145 @@
+#pragma once
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sys/un.h"
+
+#include "stateexport.h"
+
+// Magic number at the start of a stream file: "TSS" + format version. Any
+// change to the format below has to change the version.
+inline const uint32_t STATE_STREAM_MAGIC = 0x54535301;
+
+// A keyframe with the full state is written at least this often, so viewers
+// that join late or lose a datagram catch up
+inline const int STATE_STREAM_KEYFRAME_MS = 10000;
+// Moves of the active Tetromino and score changes are written at most this
+// often; anything else is written in the tick it happens
+inline const int STATE_STREAM_MINOR_MS = 50;
+// Frames for a file are written and flushed by a background thread this often
+inline const int STATE_STREAM_FLUSH_MS = 100;
+
+// Parts of the state a frame carries
+inline const uint8_t STREAM_KEYFRAME = 1 << 0;
+inline const uint8_t STREAM_LOCK = 1 << 1;
+inline const uint8_t STREAM_ROWS = 1 << 2;
+inline const uint8_t STREAM_NEXT = 1 << 3;
+inline const uint8_t STREAM_PIECES = 1 << 4;
+inline const uint8_t STREAM_POSE = 1 << 5;
+inline const uint8_t STREAM_STATS = 1 << 6;
+inline const uint8_t STREAM_STATE = 1 << 7;
+
+// Tags of a row in STREAM_ROWS; 1 to 4 copy the row that many rows higher
+inline const uint8_t STREAM_ROW_LITERAL = 0;
+inline const uint8_t STREAM_ROW_EMPTY = 5;
+
+// Largest possible frame, a keyframe with every row filled
+inline const size_t STATE_STREAM_MAX_FRAME = 512;
+
+/*
+ * Compact stream of the states of a game, for remote viewers and archives.
+ * Frames are only written when something changed and only carry what did.
+ * A Tetromino locking down takes two bytes, its pose, from which viewers
+ * place it and clear lines themselves; other changes to the board are sent
+ * as the rows that changed.
+ *
+ * A stream file starts with STATE_STREAM_MAGIC (4 bytes, little endian),
+ * followed by frames; every datagram sent to a socket holds a single frame.
+ * Varints are LEB128, signed ones zigzag encoded first. A frame is:
+ *
+ *   varint  length of the rest of the frame
+ *   1       sequence number, one more than the last frame's (modulo 256)
+ *   1       flags (STREAM_*)
+ *   varint  milliseconds since the last frame; for a keyframe, the time
+ *
+ * followed by a section for each flag that is set, in this order:
+ *
+ *   LOCK    2 bytes: x + 4 | orientation << 6, y. The active Tetromino locks
+ *           down there and full rows are cleared. Then the first Tetromino
+ *           of the queue becomes the active one at its spawn pose, the rest
+ *           of the queue moves up, holding is allowed again and `pieces`
+ *           goes up by one.
+ *   ROWS    varint mask of the rows that changed, bit 0 being the bottom
+ *           row, then a tag for each of them, from the top:
+ *           STREAM_ROW_LITERAL followed by the 10 cells in 5 bytes (low
+ *           nibble first), STREAM_ROW_EMPTY, or 1 to 4 to repeat the row
+ *           that many rows higher as it was before this section
+ *   NEXT    1 byte: the Tetromino that joined the end of the queue
+ *   PIECES  5 bytes: active_kind | can_hold << 7, held, queue[0..2]
+ *   POSE    2 bytes: active_x + 4 | active_orientation << 6, active_y
+ *   STATS   1 byte telling which of score, lines, level, pieces and
+ *           pending_garbage changed (bit 0 to 4), followed by a signed
+ *           varint with the change of each of them; for a keyframe, with
+ *           their values
+ *   STATE   1 byte: game state as in ExportedState
+ *
+ * A keyframe has all flags but LOCK and NEXT set and lists every row that
+ * isn't empty, with literal tags only. Viewers work out `ghost_y` from the
+ * pose; `tick` counts the frames they applied.
+ */
+class StateStreamWriter {
+  private:
+    std::FILE *m_file = nullptr;
+    int m_socket = -1;
+    sockaddr_un m_peer{};
+
+    // The state as viewers know it
+    ExportedState m_last{};
+    // The state passed to the last call to write()
+    ExportedState m_previous{};
+    bool m_started = false;
+    int64_t m_last_ms = 0;
+    int64_t m_last_keyframe_ms = 0;
+    int64_t m_last_minor_ms = 0;
+    uint8_t m_sequence = 0;
+    std::vector<uint8_t> m_frame;
+    uint64_t m_bytes = 0;
+
+    // Frames waiting for the writer thread to write them to m_file
+    std::vector<uint8_t> m_pending;
+    std::mutex m_pending_mutex;
+    std::condition_variable m_pending_cv;
+    bool m_stop = false;
+    std::thread m_writer;
+
+    bool findLock(const ExportedState &state, uint8_t pose[2]) const;
+    void send();
+    void run();
+
+  public:
+    StateStreamWriter(const std::string &destination);
+    ~StateStreamWriter();
+
+    StateStreamWriter(const StateStreamWriter &) = delete;
+    StateStreamWriter &operator=(const StateStreamWriter &) = delete;
+
+    void write(const ExportedState &state);
+    uint64_t getBytesWritten() const;
+};
+
+/*
+ * Rebuilds the state of a game from the frames of a stream
+ */
+class StateStreamDecoder {
+  private:
+    ExportedState m_state{};
+    uint64_t m_frames = 0;
+    int64_t m_time_ms = 0;
+    bool m_synced = false;
+    uint8_t m_sequence = 0;
+
+  public:
+    bool apply(const uint8_t *frame, size_t len);
+    bool isSynced() const;
+    const ExportedState &getState() const;
+    int64_t getTimeMs() const;
+};
+
+bool readStreamFrameLength(const uint8_t *data, size_t len, size_t &header,
+                           size_t &frame_len);
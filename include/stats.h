@@ -0,0 +1,100 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <ostream>
+
+#include "action.h"
+#include "constants.h"
+#include "sim.h"
+
+// Number of recent lock downs kept for the windowed statistics
+inline const int STATS_HISTORY = 256;
+// Length of the window over which the windowed rates are computed
+inline const int STATS_WINDOW_MS = 10000;
+
+/*
+ * Rates over some period of play
+ */
+struct StatsRates {
+    // Pieces per second
+    double pps;
+    // Attack (garbage lines sent) per minute
+    double apm;
+    // Keys per piece
+    double kpp;
+};
+
+/*
+ * Statistics of a single game, updated incrementally from the events of the
+ * game. Besides totals since the start of the game, the rates over the last
+ * STATS_WINDOW_MS of play are kept in a ring buffer of recent lock downs, so
+ * that nothing has to be allocated or recomputed while playing.
+ *
+ * All times are play time, i. e. time spent paused isn't counted.
+ */
+class LiveStats {
+  private:
+    struct LockEvent {
+        cl::duration time;
+        int keys;
+        int attack;
+    };
+    // Recent lock downs, indexed by lock count modulo STATS_HISTORY
+    std::array<LockEvent, STATS_HISTORY> m_history;
+    // Lock downs [m_window_begin, m_pieces) are inside the window
+    int m_window_begin = 0;
+    int m_window_keys = 0;
+    int m_window_attack = 0;
+    // Play time at which the window starts
+    cl::duration m_window_start;
+
+    cl::time_point m_start;
+    cl::time_point m_pause_start;
+    cl::duration m_paused;
+    bool m_is_paused = false;
+    // Play time of the last update
+    cl::duration m_time;
+
+    // Totals
+    int m_pieces = 0;
+    int m_keys = 0;
+    int m_attack = 0;
+    int m_lines = 0;
+    // Keys pressed for the current Tetromino
+    int m_piece_keys = 0;
+    // Lock downs by number of lines cleared, not counting T-Spins
+    std::array<int, 5> m_clears;
+    // T-Spins by TSpinType (minus one) and number of lines cleared
+    std::array<std::array<int, 4>, 2> m_t_spins;
+    int m_perfect_clears = 0;
+    int m_finesse_faults = 0;
+
+    cl::duration playTime(cl::time_point now) const;
+    void expire();
+    static StatsRates rates(int pieces, int keys, int attack,
+                            cl::duration time);
+
+  public:
+    LiveStats();
+
+    void reset(cl::time_point now);
+    void update(cl::time_point now);
+    void pause(cl::time_point now);
+    void resume(cl::time_point now);
+    void onAction(Action action);
+    void onLock(const LockInfo &lock, bool perfect_clear, int extra_inputs,
+                cl::time_point now);
+
+    double getSeconds() const;
+    int getPieces() const;
+    int getKeys() const;
+    int getAttack() const;
+    int getClears(int n_lines) const;
+    int getTSpins(TSpinType type, int n_lines) const;
+    int getPerfectClears() const;
+    int getFinesseFaults() const;
+    StatsRates getTotalRates() const;
+    StatsRates getWindowRates() const;
+
+    void write(std::ostream &out) const;
+};
@@ -7,10 +7,8 @@
 class TetroVisual {
   private:
     TetrominoKind_t m_kind;
-    TetroGrid_t m_grid;
     SDL_Color m_color;
     void drawMino(SDL_Renderer *renderer, int x, int y);
-    void loadGrid();
 
   public:
     TetroVisual();
@@ -1,3 +1,4 @@
+#pragma once
 #include <chrono>
 
 // Alias for less typing
@@ -18,7 +19,9 @@ class Timer {
     bool hasPassed() const;
 
     void pause();
+    void pause(cl::time_point now);
     void resume();
+    void resume(cl::time_point now);
     bool isPaused() const;
 
     void operator=(const cl::time_point other);
@@ -0,0 +1,67 @@
+#pragma once
+#include <array>
+#include <stdint.h>
+#include <vector>
+
+#include "bitboard.h"
+#include "constants.h"
+
+// Kind of the T Tetromino
+inline const TetrominoKind_t T_KIND = 5;
+
+// Corners of the 3x3 box around a T Tetromino, in clockwise order. A T facing
+// in orientation `o` points at corners `o` and `o + 1`.
+inline const uint8_t CORNER_TOP_LEFT = 1 << 0;
+inline const uint8_t CORNER_TOP_RIGHT = 1 << 1;
+inline const uint8_t CORNER_BOTTOM_RIGHT = 1 << 2;
+inline const uint8_t CORNER_BOTTOM_LEFT = 1 << 3;
+
+enum TSpinType : uint8_t { NoTSpin = 0, MiniTSpin = 1, FullTSpin = 2 };
+
+/**
+ * Classify a T-Spin by the orientation of the T and which corners are
+ * obstructed: both corners in front and one behind make a T-Spin, one in
+ * front and both behind a Mini T-Spin
+ */
+constexpr TSpinType classifyTSpin(uint8_t orientation, uint8_t corners) {
+    auto has = [corners](int i) -> bool { return corners & (1 << (i % 4)); };
+    bool front_a = has(orientation), front_b = has(orientation + 1);
+    bool back_a = has(orientation + 2), back_b = has(orientation + 3);
+    if (front_a && front_b && (back_a || back_b)) {
+        return FullTSpin;
+    }
+    if ((front_a || front_b) && back_a && back_b) {
+        return MiniTSpin;
+    }
+    return NoTSpin;
+}
+
+constexpr std::array<std::array<TSpinType, 16>, 4> makeTSpinTable() {
+    std::array<std::array<TSpinType, 16>, 4> table{};
+    for (int orientation = 0; orientation < 4; orientation++) {
+        for (int corners = 0; corners < 16; corners++) {
+            table[orientation][corners] = classifyTSpin(orientation, corners);
+        }
+    }
+    return table;
+}
+
+// T-Spin type by orientation and corner mask
+inline constexpr std::array<std::array<TSpinType, 16>, 4> T_SPIN_TABLE =
+    makeTSpinTable();
+
+uint8_t getCornerMask(const BitBoard &board, int x, int y);
+
+/*
+ * Empty spot on a board that a T Tetromino would exactly fill with a T-Spin
+ * clearing `lines` lines. Only the shape is checked; whether the T can be
+ * rotated into it is up to the PlacementEnumerator.
+ */
+struct TSlot {
+    int8_t x, y;
+    uint8_t orientation;
+    uint8_t lines;
+};
+
+int findTSlots(const BitBoard &board, std::vector<TSlot> &slots,
+               int min_lines = 2);
@@ -0,0 +1,33 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+
+/*
+ * Fixed-size hash table caching evaluations of game states by their Zobrist
+ * hash. Can be shared by any number of search threads without locking.
+ *
+ * Each entry consists of two words, the data and the hash XORed with the
+ * data. Two threads writing the same entry at once may leave it torn, but a
+ * torn entry fails the check on lookup and is simply treated as a miss.
+ */
+class TranspositionTable {
+  private:
+    struct Entry {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> data;
+    };
+    std::unique_ptr<Entry[]> m_entries;
+    uint64_t m_mask;
+
+    static uint64_t pack(float value, uint8_t depth);
+    static void unpack(uint64_t data, float &value, uint8_t &depth);
+
+  public:
+    TranspositionTable(int size_log2);
+
+    void clear();
+    void store(uint64_t hash, float value, uint8_t depth);
+    bool probe(uint64_t hash, float &value, uint8_t &depth) const;
+    uint64_t size() const;
+};
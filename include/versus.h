@@ -0,0 +1,143 @@
+#pragma once
+#include <array>
+#include <chrono>
+
+#include "action.h"
+#include "constants.h"
+#include "net.h"
+#include "sim.h"
+
+// Number of ticks of input history that are kept for both players; must be
+// larger than the input delay plus VERSUS_MAX_ROLLBACK
+inline const int VERSUS_INPUT_HISTORY = 128;
+// Maximum number of ticks of input carried by a single packet
+inline const int VERSUS_MAX_PACKET_INPUTS = 32;
+
+enum class VersusPacketType : uint8_t { Hello, Input };
+
+/*
+ * Datagram exchanged between the two instances. Every input packet repeats
+ * all inputs the peer hasn't acknowledged yet, so lost or reordered packets
+ * don't need to be retransmitted separately.
+ */
+struct VersusPacket {
+    // Identifies the protocol and its version
+    uint32_t magic;
+    VersusPacketType type;
+    // Hello: seed used by both Simulations
+    uint32_t seed;
+    // Next tick the sender is going to simulate
+    int32_t frame;
+    // Last tick up to which the sender has received all of our inputs
+    int32_t ack;
+    // How many ticks the sender is ahead of us, as seen by the sender
+    int32_t advantage;
+    // Input: the inputs for ticks [start, start + count)
+    int32_t start;
+    uint8_t count;
+    std::array<InputFrame_t, VERSUS_MAX_PACKET_INPUTS> inputs;
+    // Last tick for which the sender has the inputs of both players, -1 if
+    // there is none yet, and the checksums of the sender's Simulations after
+    // it, its own player first
+    int32_t checksum_frame;
+    std::array<uint32_t, 2> checksums;
+};
+
+inline const uint32_t VERSUS_MAGIC = 0x54565303; // "TVS" + version 3
+
+/*
+ * Two player versus match between two instances of the game, synchronized
+ * in lockstep over a Connection.
+ *
+ * Both instances simulate both players. Local inputs are delayed by a
+ * configurable number of ticks and sent to the peer right away. Remote inputs
+ * that haven't arrived yet are predicted to be empty (i. e. the remote player
+ * keeps holding the same keys); when the actual input arrives and differs,
+ * the session rolls back to the snapshot taken before that tick and
+ * re-simulates up to the present.
+ */
+class VersusSession {
+  private:
+    Connection &m_conn;
+    bool m_host;
+    uint32_t m_seed;
+    int m_input_delay;
+    bool m_started = false;
+
+    // Index 0 is the local player, index 1 the remote one
+    std::array<Simulation, 2> m_sims;
+    // State of both Simulations before each of the last ticks, indexed by
+    // tick modulo array size
+    std::array<std::array<SimSnapshot, 2>, VERSUS_MAX_ROLLBACK + 2>
+        m_snapshots;
+
+    // Next tick to be simulated
+    int m_frame = 0;
+    // Inputs for each tick, indexed by tick modulo VERSUS_INPUT_HISTORY
+    std::array<InputFrame_t, VERSUS_INPUT_HISTORY> m_local_inputs{};
+    std::array<InputFrame_t, VERSUS_INPUT_HISTORY> m_remote_inputs{};
+    // Local inputs collected while the session was stalled
+    InputFrame_t m_pending_input = 0;
+    // Last tick for which the remote input is known; all later ticks are
+    // simulated with predicted input
+    int m_remote_last = -1;
+    // Last tick up to which the peer has acknowledged our inputs
+    int m_remote_ack = -1;
+    // Earliest tick that was simulated with a wrong prediction
+    int m_rollback_frame;
+    // Tick in which one of the players topped out
+    int m_over_frame;
+    // Time synchronization
+    int m_local_advantage = 0;
+    int m_remote_advantage = 0;
+    int m_last_sync_stall = 0;
+    int m_hello_timer = 0;
+
+    // Checksums of both Simulations after each tick, indexed by tick modulo
+    // VERSUS_INPUT_HISTORY
+    std::array<std::array<uint32_t, 2>, VERSUS_INPUT_HISTORY> m_checksums{};
+    // Checksums received from the peer that haven't been compared yet
+    int m_peer_checksum_frame = -1;
+    std::array<uint32_t, 2> m_peer_checksums{};
+    // Last tick compared with the peer's checksums, and the first one whose
+    // checksums differed
+    int m_checked_frame = -1;
+    int m_desync_frame = -1;
+    bool m_dump_desync = false;
+    void checkSync();
+    void dumpDesync(int frame);
+
+    // Statistics
+    int m_n_rollbacks = 0;
+    int m_n_resimulated = 0;
+    int m_n_stalls = 0;
+
+    void start(uint32_t seed);
+    void poll();
+    void handlePacket(const VersusPacket &packet);
+    void sendInputs();
+    void sendHello();
+    bool shouldStall();
+    void rollback();
+    void simulateFrame(int frame);
+    InputFrame_t getRemoteInput(int frame) const;
+    static cl::time_point frameTime(int frame);
+
+  public:
+    VersusSession(Connection &conn, bool host, uint32_t seed,
+                  int input_delay);
+
+    void tick(InputFrame_t local_input);
+    void setDumpDesync(bool dump);
+
+    bool isStarted() const;
+    bool isOver() const;
+    int getFrame() const;
+    Simulation &getLocal();
+    Simulation &getRemote();
+
+    int getRollbacks() const;
+    int getResimulatedFrames() const;
+    int getStalls() const;
+    int getDesyncFrame() const;
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include <chrono>
+#include <string>
+
+#include "SDL.h"
+
+#include "action.h"
+#include "config.h"
+#include "gamepad.h"
+#include "hud.h"
+#include "timer.h"
+#include "versus.h"
+
+/*
+ * Interactive versus match: collects keyboard and game controller input,
+ * runs the VersusSession at a fixed tick rate and draws both players next to
+ * each other.
+ */
+class VersusGame {
+  private:
+    VersusSession m_session;
+    HUD m_hud;
+    Gamepad m_gamepad;
+    // Keyboard inputs collected since the last tick
+    InputFrame_t m_input = 0;
+    Timer m_next_tick;
+    bool m_reported = false;
+
+    void drawGarbageMeter(SDL_Renderer *renderer, const Simulation &sim,
+                          int x);
+
+  public:
+    VersusGame(Connection &conn, bool host, uint32_t seed, int input_delay);
+
+    void finishLoading(SDL_Renderer *renderer);
+    void setGamepadSettings(const GamepadSettings &settings);
+    void setDumpDesync(bool dump);
+    void update();
+    void handleEvent(const SDL_Event &e);
+    void draw(SDL_Renderer *renderer);
+};
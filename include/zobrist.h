@@ -0,0 +1,76 @@
+#pragma once
+#include <array>
+#include <stdint.h>
+
+#include "constants.h"
+
+/*
+ * Random keys for Zobrist hashing of game states. The hash of a state is the
+ * XOR of the keys of all its features, so it can be updated incrementally
+ * whenever a single feature changes. The keys of the cells depend on the size
+ * of the board, see ZOBRIST_CELLS.
+ */
+struct ZobristKeys {
+    // Kind of the active Tetromino
+    std::array<uint64_t, N_TETROMINOS> active;
+    // Kind of the held Tetromino, the last entry stands for none
+    std::array<uint64_t, N_TETROMINOS + 1> hold;
+    uint64_t can_hold;
+    // Kind of Tetromino at each position of the queue
+    std::array<std::array<uint64_t, N_TETROMINOS>, QUEUE_LEN> queue;
+    // Number of Tetrominos already pulled from the current bag
+    std::array<uint64_t, N_TETROMINOS + 1> bag_position;
+};
+
+/**
+ * SplitMix64 step; used to fill the key table deterministically at compile
+ * time
+ */
+constexpr uint64_t splitMix64(uint64_t &state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+constexpr ZobristKeys makeZobristKeys() {
+    ZobristKeys keys{};
+    uint64_t state = 0x5a0b7157;
+    for (int i = 0; i < N_TETROMINOS; i++) {
+        keys.active[i] = splitMix64(state);
+    }
+    for (int i = 0; i <= N_TETROMINOS; i++) {
+        keys.hold[i] = splitMix64(state);
+        keys.bag_position[i] = splitMix64(state);
+    }
+    keys.can_hold = splitMix64(state);
+    for (int pos = 0; pos < QUEUE_LEN; pos++) {
+        for (int i = 0; i < N_TETROMINOS; i++) {
+            keys.queue[pos][i] = splitMix64(state);
+        }
+    }
+    return keys;
+}
+
+inline constexpr ZobristKeys ZOBRIST = makeZobristKeys();
+
+// One key per occupied cell of a board; the kind of Mino doesn't matter for
+// the game, so it isn't part of the hash
+template <int Width, int Height>
+using ZobristCells = std::array<std::array<uint64_t, Width>, Height>;
+
+template <int Width, int Height>
+constexpr ZobristCells<Width, Height> makeZobristCells() {
+    ZobristCells<Width, Height> cells{};
+    uint64_t state = 0x3c6ef372 ^ ((uint64_t)Width << 32 | Height);
+    for (int row = 0; row < Height; row++) {
+        for (int col = 0; col < Width; col++) {
+            cells[row][col] = splitMix64(state);
+        }
+    }
+    return cells;
+}
+
+template <int Width, int Height>
+inline constexpr ZobristCells<Width, Height> ZOBRIST_CELLS =
+    makeZobristCells<Width, Height>();
@@ -0,0 +1,58 @@
+#include "action.h"
+
+/**
+ * Translate a keyboard event into an Action
+ *
+ * @param e the event to translate
+ * @param action store the resulting action here
+ *
+ * @return whether the event corresponds to an action
+ */
+bool actionFromEvent(const SDL_Event &e, Action &action) {
+    switch (e.type) {
+    case SDL_KEYDOWN:
+        // Ignore repeated keys, we implement our own repeated inputs
+        if (e.key.repeat) {
+            return false;
+        }
+        switch (e.key.keysym.sym) {
+        case SDLK_RIGHT:
+            action = Action::MoveRight;
+            return true;
+        case SDLK_LEFT:
+            action = Action::MoveLeft;
+            return true;
+        case SDLK_DOWN:
+            action = Action::SoftDrop;
+            return true;
+        case SDLK_UP:
+            action = Action::RotateClockw;
+            return true;
+        case SDLK_LCTRL:
+        case SDLK_RCTRL:
+            action = Action::RotateCounterclockw;
+            return true;
+        case SDLK_SPACE:
+            action = Action::HardDrop;
+            return true;
+        case SDLK_c:
+            action = Action::Hold;
+            return true;
+        }
+        return false;
+    case SDL_KEYUP:
+        switch (e.key.keysym.sym) {
+        case SDLK_RIGHT:
+            action = Action::MoveRightRelease;
+            return true;
+        case SDLK_LEFT:
+            action = Action::MoveLeftRelease;
+            return true;
+        case SDLK_DOWN:
+            action = Action::SoftDropRelease;
+            return true;
+        }
+        return false;
+    }
+    return false;
+}
@@ -6,25 +6,28 @@
 #include "constants.h"
 #include "playfield.h"
 
-Active::Active(uint8_t type, Playfield &_p_playfield)
+template <int Width, int Height>
+BasicActive<Width, Height>::BasicActive(
+    uint8_t type, BasicPlayfield<Width, Height> &_p_playfield)
     : m_playfield(_p_playfield) {
     respawn(type);
 }
 
 /**
- * Update the grid representation of the Tetromino with the
- * one that corresponds to the current type
+ * Get the cells occupied by the Tetromino in its current orientation
  */
-void Active::loadGrid() {
-    m_grid = TETROMINOS[m_type];
+template <int Width, int Height>
+PieceMask_t BasicActive<Width, Height>::getMask() const {
+    return getPieceMask(m_type, m_orientation);
 }
 
 /*
- * Load new Tetromino into the grid and move it to the respawn position;
+ * Load new Tetromino and move it to the respawn position;
  *
  * @return whether respawning was successful
  */
-bool Active::respawn(uint8_t type) {
+template <int Width, int Height>
+bool BasicActive<Width, Height>::respawn(uint8_t type) {
 
     if (type < 0 || type >= N_TETROMINOS) {
         throw std::out_of_range("Tetromino type must be in range [0..6].");
@@ -33,29 +36,24 @@ bool Active::respawn(uint8_t type) {
     m_type = type;
     // Reset orientation
     m_orientation = 0;
-    // Load corresponding Tetromino into grid
-    loadGrid();
     // Check if respawn position is obstructed
-    if (gridConflict(m_grid, STARTING_POSITION_X, STARTING_POSITION_Y)) {
+    if (conflict(0, Size::SPAWN_X, Size::SPAWN_Y)) {
         return false;
     }
     // Set starting position
-    m_x = STARTING_POSITION_X;
-    m_y = STARTING_POSITION_Y;
+    m_x = Size::SPAWN_X;
+    m_y = Size::SPAWN_Y;
     return true;
 }
 
 /*
  * Bake the current Tetromino into the playfield
  */
-void Active::lockDown() {
-    for (int x = 0; x < 4; x++) {
-        for (int y = 0; y < 4; y++) {
-            if (m_grid[y][x]) {
-                m_playfield.setAt(m_x + x, m_y + y, m_type);
-            }
-        }
-    }
+template <int Width, int Height>
+void BasicActive<Width, Height>::lockDown() {
+    forEachMino(getMask(), [this](int x, int y) {
+        m_playfield.setAt(m_x + x, m_y + y, m_type);
+    });
 }
 
 /*
@@ -63,40 +61,13 @@ void Active::lockDown() {
  *
  * @return vertical position
  */
-int Active::getGhostY() {
-    int ghost_y = GRID_SIZE_Y;
-    // Iterate over all columns of the Tetromino and see which has the least
-    // space below until the next Mino on the playfield, calculate new
-    // position to be 1 cell above that
-    for (int col = 0; col < 4; col++) {
-        // Vertical position of the lowest Mino contained in the current column
-        // of the Tetromino, relative to the postition of the Tetromino
-        int lowest_mino_rel = -1;
-        for (int row = 0; row < 4; row++) {
-            if (m_grid[row][col]) {
-                lowest_mino_rel = row;
-            }
-        }
-        if (lowest_mino_rel == -1) {
-            // No Mino in current column -> skip
-            continue;
-        }
-        // Lowest position for each column: at the very bottom
-        ghost_y = std::min(ghost_y, GRID_SIZE_Y - lowest_mino_rel - 1);
-        // Check the corresponding playfield column and get position of lowest
-        // free cell below.
-        // Absolute position of the lowest Mino in the current column
-        int lowest_mino = m_y + lowest_mino_rel;
-        for (int cell_y = lowest_mino + 1; cell_y < GRID_SIZE_Y; cell_y++) {
-            if (m_playfield.isObstructed(m_x + col, cell_y)) {
-                ghost_y = std::min(ghost_y, cell_y - lowest_mino_rel - 1);
-            }
-        }
-    }
-    return ghost_y;
+template <int Width, int Height>
+int BasicActive<Width, Height>::getGhostY() {
+    return m_playfield.dropY(m_type, m_orientation, m_x, m_y);
 }
 
-bool Active::moveRight() {
+template <int Width, int Height>
+bool BasicActive<Width, Height>::moveRight() {
     bool can_move = canMoveRight();
     if (can_move) {
         m_x++;
@@ -109,22 +80,14 @@ bool Active::moveRight() {
  *
  * @return the above
  */
-bool Active::canMoveRight() {
-    uint8_t rightmost = 0;
-    for (uint8_t row = 0; row < 4; row++) {
-        for (uint8_t col = 0; col < 4; col++) {
-            if (m_grid[row][col]) {
-                // Spot to the right is filled or lies outside the playfield
-                if (m_playfield.isObstructed(m_x + col + 1, m_y + row)) {
-                    return false;
-                }
-            }
-        }
-    }
-    return true;
+template <int Width, int Height>
+bool BasicActive<Width, Height>::canMoveRight() {
+    // Spot to the right of any Mino is filled or lies outside the playfield
+    return !conflict(m_orientation, m_x + 1, m_y);
 }
 
-bool Active::moveLeft() {
+template <int Width, int Height>
+bool BasicActive<Width, Height>::moveLeft() {
     bool can_move = canMoveLeft();
     if (can_move) {
         m_x--;
@@ -137,18 +100,10 @@ bool Active::moveLeft() {
  *
  * @return the above
  */
-bool Active::canMoveLeft() {
-    for (uint8_t row = 0; row < 4; row++) {
-        for (uint8_t col = 0; col < 4; col++) {
-            if (m_grid[row][col]) {
-                // Spot to the left is filled or lies outside playfield
-                if (m_playfield.isObstructed(m_x + col - 1, m_y + row)) {
-                    return false;
-                }
-            }
-        }
-    }
-    return true;
+template <int Width, int Height>
+bool BasicActive<Width, Height>::canMoveLeft() {
+    // Spot to the left of any Mino is filled or lies outside the playfield
+    return !conflict(m_orientation, m_x - 1, m_y);
 }
 
 /*
@@ -156,7 +111,8 @@ bool Active::canMoveLeft() {
  *
  * @return whether it was successful
  */
-bool Active::stepDown() {
+template <int Width, int Height>
+bool BasicActive<Width, Height>::stepDown() {
     if (canStepDown()) {
         m_y++;
         return true;
@@ -171,22 +127,11 @@ bool Active::stepDown() {
  *
  * @return the above
  */
-bool Active::canStepDown() {
-
+template <int Width, int Height>
+bool BasicActive<Width, Height>::canStepDown() {
     // Check if already at the bottom or if there would
     // be any collision with a Mino on the p_playfield
-    // TODO: Use gridConflict() for this check
-    for (uint8_t row = 0; row < 4; row++) {
-        for (uint8_t col = 0; col < 4; col++) {
-            if (m_grid[row][col]) {
-                // Spot below is filled or lies outside playfield
-                if (m_playfield.isObstructed(m_x + col, m_y + row + 1)) {
-                    return false;
-                }
-            }
-        }
-    }
-    return true;
+    return !conflict(m_orientation, m_x, m_y + 1);
 }
 
 /*
@@ -195,7 +140,8 @@ bool Active::canStepDown() {
  *
  * @return the number of lines the Tetromino was dropped
  */
-int Active::hardDrop() {
+template <int Width, int Height>
+int BasicActive<Width, Height>::hardDrop() {
 
     int ghost_y = getGhostY();
     int diff = ghost_y - m_y;
@@ -204,119 +150,60 @@ int Active::hardDrop() {
 }
 
 /*
- * Create a new grid with the contents of the current one rotated clockwise
- *
- * @return the new grid
- */
-TetroGrid_t Active::getGridRotatedClockw() {
-
-    TetroGrid_t new_grid{};
-    switch (m_type) {
-    case 0: // I
-        for (int row = 0; row < 4; row++) {
-            for (int col = 0; col < 4; col++) {
-                new_grid[col][3 - row] = m_grid[row][col];
-            }
-        }
-        break;
-    case 3: // O
-        new_grid = m_grid;
-        break;
-    default: // all other Tetrominos
-        for (int row = 0; row < 3; row++) {
-            for (int col = 0; col < 3; col++) {
-                new_grid[col][2 - row] = m_grid[row][col];
-            }
-        }
-    }
-    return new_grid;
-}
-
-/*
- * Create a new grid with the contents of the current one rotated
- * counterclockwise
- *
- * @return the new grid
- */
-TetroGrid_t Active::getGridRotatedCounterclockw() {
-    TetroGrid_t new_grid{};
-    switch (m_type) {
-    case 0: // I
-        for (int row = 0; row < 4; row++) {
-            for (int col = 0; col < 4; col++) {
-                new_grid[3 - col][row] = m_grid[row][col];
-            }
-        }
-        break;
-    case 3: // O
-        new_grid = m_grid;
-        break;
-    default: // all other Tetrominos
-        for (int row = 0; row < 3; row++) {
-            for (int col = 0; col < 3; col++) {
-                new_grid[2 - col][row] = m_grid[row][col];
-            }
-        }
-    }
-    return new_grid;
-}
-
-/*
- * Check if the given grid, placed at the given location, overlaps with any Mino
- * on the Playfield
+ * Check if the Tetromino in the given orientation, placed at the given
+ * location, overlaps with any Mino on the Playfield or lies outside of it.
+ * Looked up in the Playfield's collision map, which only changes on lock
+ * down.
  *
  * @return whether there is an overlap
  */
-bool Active::gridConflict(const TetroGrid_t &grid, int x, int y) {
-    for (int row = 0; row < 4; row++) {
-        for (int col = 0; col < 4; col++) {
-            if (grid[row][col]) {
-                if (m_playfield.isObstructed(x + col, y + row) || x + col < 0 ||
-                    x + col >= GRID_SIZE_X || y + col < 0 ||
-                    y + col >= GRID_SIZE_Y) {
-                    return true;
-                }
-            }
-        }
-    }
-    return false;
+template <int Width, int Height>
+bool BasicActive<Width, Height>::conflict(uint8_t orientation, int x, int y) {
+    return !m_playfield.fits(m_type, orientation, x, y);
 }
 
 /**
- * Try all wall kicks for clockwise rotation with the given grid and store the
- * first found non-conflicting one in `success`.
+ * Try all wall kicks for clockwise rotation into the given orientation and
+ * store the first found non-conflicting one in `success`.
  *
  * @return whether a non-conflicting wall kick was found
  */
-bool Active::tryWallkicksC(const TetroGrid_t &new_grid, Wallkick_t &success,
-                           int &rotation_point) {
-    return tryWallkicks(new_grid, 1, success, rotation_point);
+template <int Width, int Height>
+bool BasicActive<Width, Height>::tryWallkicksC(uint8_t new_orientation,
+                                               Wallkick_t &success,
+                                               int &rotation_point) {
+    return tryWallkicks(new_orientation, 1, success, rotation_point);
 }
 
 /**
- * Try all wall kicks for counterclockwise rotation with the given grid and
- * store the first found non-conflicting one in `success`.
+ * Try all wall kicks for counterclockwise rotation into the given orientation
+ * and store the first found non-conflicting one in `success`.
  *
  * @return whether a non-conflicting wall kick was found
  */
-bool Active::tryWallkicksCC(const TetroGrid_t &new_grid, Wallkick_t &success,
-                            int &rotation_point) {
-    return tryWallkicks(new_grid, -1, success, rotation_point);
+template <int Width, int Height>
+bool BasicActive<Width, Height>::tryWallkicksCC(uint8_t new_orientation,
+                                                Wallkick_t &success,
+                                                int &rotation_point) {
+    return tryWallkicks(new_orientation, -1, success, rotation_point);
 }
 
 /**
  * Try all wall kicks and store the first found successful (non-conflicting) one
  * in `success`
  *
- * @param new_grid grid to check
+ * @param new_orientation orientation to check
  * @param direction direction of rotation
  * @param success store succesful wall kick here
  * @param rotation_point rotation of point of the successful wall kick
  *
  * @return whether a non-conflicting wall kick was found
  */
-bool Active::tryWallkicks(const TetroGrid_t &new_grid, int8_t direction,
-                          Wallkick_t &success, int &rotation_point) {
+template <int Width, int Height>
+bool BasicActive<Width, Height>::tryWallkicks(uint8_t new_orientation,
+                                              int8_t direction,
+                                              Wallkick_t &success,
+                                              int &rotation_point) {
     // O Tetromino; doesn't perform Wall Kicks
     if (m_type == 3) {
         success = Wallkick_t{0, 0};
@@ -339,7 +226,8 @@ bool Active::tryWallkicks(const TetroGrid_t &new_grid, int8_t direction,
         }
     }
     // Try out all Wall Kicks
-    return tryWallkickData(new_grid, wallkick_data, success, rotation_point);
+    return tryWallkickData(new_orientation, wallkick_data, success,
+                           rotation_point);
 }
 
 /**
@@ -347,13 +235,14 @@ bool Active::tryWallkicks(const TetroGrid_t &new_grid, int8_t direction,
  *
  * @return whether a non-conflicting wall kick was found
  */
-bool Active::tryWallkickData(const TetroGrid_t &new_grid,
-                             const WallkickData_t *wallkick_data,
-                             Wallkick_t &success, int &rotation_point) {
+template <int Width, int Height>
+bool BasicActive<Width, Height>::tryWallkickData(
+    uint8_t new_orientation, const WallkickData_t *wallkick_data,
+    Wallkick_t &success, int &rotation_point) {
     for (uint8_t i = 0; i < wallkick_data->size(); i++) {
         // Check if there would be a conflict using the current Wall Kick
-        if (!gridConflict(new_grid, m_x + (*wallkick_data)[i][0],
-                          m_y + (*wallkick_data)[i][1])) {
+        if (!conflict(new_orientation, m_x + (*wallkick_data)[i][0],
+                      m_y + (*wallkick_data)[i][1])) {
             // Possible Wall Kick found
             success = (*wallkick_data)[i];
             rotation_point = i + 1;
@@ -369,21 +258,20 @@ bool Active::tryWallkickData(const TetroGrid_t &new_grid,
  *
  * @return whether the rotation was successful
  */
-bool Active::rotateClockw(int &rotation_point) {
-    TetroGrid_t new_grid = getGridRotatedClockw();
+template <int Width, int Height>
+bool BasicActive<Width, Height>::rotateClockw(int &rotation_point) {
+    uint8_t new_orientation = (m_orientation + 1) % 4;
     // Try to perform Wall Kick. Note that no offset (i. e. [0, 0]) is the
     // first Wall Kick that is tried first, therefore it isn't necesarry to
-    // exclusively check if the new grid fits without a wall kick.
+    // exclusively check if the new orientation fits without a wall kick.
     Wallkick_t wallkick;
-    if (!tryWallkicksC(new_grid, wallkick, rotation_point)) {
+    if (!tryWallkicksC(new_orientation, wallkick, rotation_point)) {
         // No Wall Kick found -> rotation is impossible
         return false;
     }
     // Wall Kick found, apply it
     m_x += wallkick[0];
     m_y += wallkick[1];
-    // Replace old grid with new, rotated grid
-    m_grid = new_grid;
     // Change rotation accordingly
     m_orientation = (m_orientation + 1) % 4;
     return true;
@@ -394,57 +282,50 @@ bool Active::rotateClockw(int &rotation_point) {
  *
  * @return whether the rotation was successful
  */
-bool Active::rotateCounterclockw(int &rotation_point) {
-    TetroGrid_t new_grid = getGridRotatedCounterclockw();
+template <int Width, int Height>
+bool BasicActive<Width, Height>::rotateCounterclockw(int &rotation_point) {
+    uint8_t new_orientation = (m_orientation + 3) % 4;
     Wallkick_t wallkick;
-    if (!tryWallkicksCC(new_grid, wallkick, rotation_point)) {
+    if (!tryWallkicksCC(new_orientation, wallkick, rotation_point)) {
         // No Wall Kick found -> rotation is impossible
         return false;
     }
     // Wall Kick found, apply it
     m_x += wallkick[0];
     m_y += wallkick[1];
-    // Replace old grid with new, rotated grid
-    m_grid = new_grid;
     // We can't use (m_orientation - 1) here since that might overflow to
     // 255. Adding 3 works just fine tho since 3 ≡ -1 (mod 4)
     m_orientation = (m_orientation + 3) % 4;
     return true;
 }
 
-void Active::draw(SDL_Renderer *renderer) {
-    std::array<int, 2> pos;
-    for (int row = 0; row < 4; row++) {
-        for (int col = 0; col < 4; col++) {
-            if (m_grid[row][col]) {
-                pos = m_playfield.cellToPixelPosition(m_x + col, m_y + row);
-                Playfield::drawMino(renderer, pos[0], pos[1],
-                                    TETROMINO_COLORS[m_type]);
-            }
-        }
-    }
+template <int Width, int Height>
+void BasicActive<Width, Height>::draw(SDL_Renderer *renderer) {
+    forEachMino(getMask(), [&](int col, int row) {
+        std::array<int, 2> pos =
+            m_playfield.cellToPixelPosition(m_x + col, m_y + row);
+        Playfield::drawMino(renderer, pos[0], pos[1],
+                            TETROMINO_COLORS[m_type]);
+    });
 }
 
 /**
  * Draw the Ghost Tetromino using the given renderer
  */
-void Active::drawGhost(SDL_Renderer *renderer) {
+template <int Width, int Height>
+void BasicActive<Width, Height>::drawGhost(SDL_Renderer *renderer) {
     int ghost_y = getGhostY();
     //  Don't draw the Ghost if it's at the same position as the actual
     //  Tetromino
     if (ghost_y == m_y) {
         return;
     }
-    std::array<int, 2> pos;
-    for (int row = 0; row < 4; row++) {
-        for (int row = 0; row < 4; row++) {
-            for (int col = 0; col < 4; col++) {
-                if (m_grid[row][col]) {
-                    pos = m_playfield.cellToPixelPosition(m_x + col,
-                                                          ghost_y + row);
-                    Playfield::drawGhostMino(renderer, pos[0], pos[1]);
-                }
-            }
-        }
-    }
+    forEachMino(getMask(), [&](int col, int row) {
+        std::array<int, 2> pos =
+            m_playfield.cellToPixelPosition(m_x + col, ghost_y + row);
+        Playfield::drawGhostMino(renderer, pos[0], pos[1]);
+    });
 }
+
+template class BasicActive<GRID_SIZE_X, GRID_SIZE_Y>;
+template class BasicActive<WIDE_GRID_SIZE_X, GRID_SIZE_Y>;
@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "audio.h"
+
+namespace {
+
+// Part of a sound effect: a tone gliding from one frequency to another
+struct Note {
+    float start_hz;
+    float end_hz;
+    float duration_ms;
+};
+
+struct SoundDesign {
+    float gain;
+    std::vector<Note> notes;
+};
+
+SoundDesign getDesign(Sound sound) {
+    switch (sound) {
+    case Sound::Move:
+        return {0.15f, {{1200, 1200, 12}}};
+    case Sound::Rotate:
+        return {0.2f, {{900, 1150, 20}}};
+    case Sound::Lock:
+        return {0.5f, {{220, 110, 45}}};
+    case Sound::Hold:
+        return {0.3f, {{600, 600, 30}, {800, 800, 30}}};
+    case Sound::LineClear:
+        return {0.4f, {{523, 523, 60}, {659, 659, 60}, {784, 784, 90}}};
+    case Sound::Tetris:
+        return {0.45f,
+                {{523, 523, 60}, {659, 659, 60}, {784, 784, 60},
+                 {1047, 1047, 160}}};
+    case Sound::TSpin:
+        return {0.4f, {{400, 1200, 120}, {1200, 1200, 60}}};
+    case Sound::LevelUp:
+        return {0.4f,
+                {{784, 784, 70}, {988, 988, 70}, {1175, 1175, 70},
+                 {1568, 1568, 150}}};
+    case Sound::TopOut:
+        return {0.5f, {{440, 110, 500}}};
+    }
+    return {0, {}};
+}
+
+} // namespace
+
+Audio::Audio(EventBus &bus, const AudioSettings &settings)
+    : m_bus(bus), m_volume(settings.volume) {}
+
+/**
+ * Open the audio device, synthesize the sounds for it and start playing.
+ * Until this is called, events are not listened to.
+ *
+ * Some drivers take a noticeable time to open a device, which is why this
+ * isn't done until main has presented the first frame.
+ */
+void Audio::open() {
+    if (m_initialized) {
+        return;
+    }
+    if (SDL_InitSubSystem(SDL_INIT_AUDIO) != 0) {
+        std::cout << "WARNING: Couldn't initialize audio: " << SDL_GetError()
+                  << "\n";
+        return;
+    }
+    m_initialized = true;
+    SDL_AudioSpec desired{};
+    desired.freq = AUDIO_SAMPLE_RATE;
+    desired.format = AUDIO_F32SYS;
+    desired.channels = 1;
+    desired.samples = AUDIO_BUFFER_FRAMES;
+    desired.callback = callback;
+    desired.userdata = this;
+    SDL_AudioSpec obtained;
+    m_device = SDL_OpenAudioDevice(nullptr, 0, &desired, &obtained,
+                                   SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+    if (m_device == 0) {
+        std::cout << "WARNING: Couldn't open audio device: " << SDL_GetError()
+                  << "\n";
+        return;
+    }
+    load(obtained.freq);
+    // Devices start paused, so the callback doesn't run before this
+    m_events = m_bus.subscribe();
+    SDL_PauseAudioDevice(m_device, 0);
+}
+
+Audio::~Audio() {
+    // If SDL was shut down first, it has closed the device already
+    if (!m_initialized || !SDL_WasInit(SDL_INIT_AUDIO)) {
+        return;
+    }
+    if (m_device != 0) {
+        SDL_CloseAudioDevice(m_device);
+    }
+    SDL_QuitSubSystem(SDL_INIT_AUDIO);
+}
+
+void Audio::setSettings(const AudioSettings &settings) {
+    m_volume = settings.volume;
+}
+
+bool Audio::isOpen() const {
+    return m_device != 0;
+}
+
+/**
+ * Synthesize all sounds for the given sample rate; must not be called while
+ * the device is running
+ */
+void Audio::load(int sample_rate) {
+    for (int i = 0; i < N_SOUNDS; i++) {
+        m_sounds[i] = synthesize((Sound)i, sample_rate);
+    }
+}
+
+/**
+ * Synthesize the samples of a sound effect. Every note fades in over 2 ms
+ * and decays exponentially, so that notes neither click nor ring on.
+ */
+std::vector<float> Audio::synthesize(Sound sound, int sample_rate) {
+    SoundDesign design = getDesign(sound);
+    std::vector<float> samples;
+    double phase = 0;
+    for (const Note &note : design.notes) {
+        int n_samples = note.duration_ms * sample_rate / 1000;
+        int attack = std::max(1, 2 * sample_rate / 1000);
+        for (int i = 0; i < n_samples; i++) {
+            double t = (double)i / n_samples;
+            double hz =
+                note.start_hz * std::pow(note.end_hz / note.start_hz, t);
+            phase += 2 * M_PI * hz / sample_rate;
+            double envelope =
+                std::min(1.0, (double)i / attack) * std::exp(-4 * t);
+            double wave = std::sin(phase) + 0.3 * std::sin(2 * phase);
+            samples.push_back(design.gain * envelope * wave / 1.3);
+        }
+    }
+    return samples;
+}
+
+/**
+ * The sounds started by an event, one bit per Sound
+ */
+uint32_t Audio::soundsFor(const GameEvent &event) {
+    auto bit = [](Sound sound) { return (uint32_t)1 << (int)sound; };
+    switch (event.type) {
+    case GameEventType::PieceLocked:
+        // Line clears and T-Spins have sounds of their own
+        return event.lock.cleared == 0 && event.lock.t_spin == NoTSpin
+                   ? bit(Sound::Lock)
+                   : 0;
+    case GameEventType::LinesCleared:
+        if (event.lock.t_spin != NoTSpin) {
+            return 0;
+        }
+        return bit(event.lock.cleared == 4 ? Sound::Tetris : Sound::LineClear);
+    case GameEventType::TSpin:
+        return bit(Sound::TSpin);
+    case GameEventType::LevelUp:
+        return bit(Sound::LevelUp);
+    case GameEventType::Hold:
+        return bit(Sound::Hold);
+    case GameEventType::TopOut:
+        return bit(Sound::TopOut);
+    case GameEventType::Moved:
+        return bit(Sound::Move);
+    case GameEventType::Rotated:
+        return bit(Sound::Rotate);
+    }
+    return 0;
+}
+
+/**
+ * Play a sound on a free voice, or else on the one that has played longest
+ */
+void Audio::start(Sound sound) {
+    Voice *voice = &m_voices[0];
+    for (Voice &candidate : m_voices) {
+        if (candidate.sound < 0) {
+            voice = &candidate;
+            break;
+        }
+        if (candidate.position > voice->position) {
+            voice = &candidate;
+        }
+    }
+    voice->sound = (int)sound;
+    voice->position = 0;
+}
+
+/**
+ * Start the sounds of new events and mix everything that is playing into
+ * `out`. Runs on the audio thread, or wherever a test calls it from.
+ */
+void Audio::mix(float *out, int n_frames) {
+    // A sound starts at most once per buffer, however often it was triggered
+    uint32_t triggered = 0;
+    GameEvent event;
+    while (m_events && m_events->poll(event)) {
+        triggered |= soundsFor(event);
+    }
+    for (int i = 0; i < N_SOUNDS; i++) {
+        if (triggered & ((uint32_t)1 << i)) {
+            start((Sound)i);
+        }
+    }
+
+    std::fill(out, out + n_frames, 0.0f);
+    float volume = m_volume.load(std::memory_order_relaxed);
+    for (Voice &voice : m_voices) {
+        if (voice.sound < 0) {
+            continue;
+        }
+        const std::vector<float> &samples = m_sounds[voice.sound];
+        int n = std::min<size_t>(n_frames, samples.size() - voice.position);
+        for (int i = 0; i < n; i++) {
+            out[i] += volume * samples[voice.position + i];
+        }
+        voice.position += n;
+        if (voice.position == samples.size()) {
+            voice.sound = -1;
+        }
+    }
+    for (int i = 0; i < n_frames; i++) {
+        out[i] = std::clamp(out[i], -1.0f, 1.0f);
+    }
+}
+
+void Audio::callback(void *userdata, Uint8 *stream, int len) {
+    static_cast<Audio *>(userdata)->mix(reinterpret_cast<float *>(stream),
+                                         len / sizeof(float));
+}
@@ -8,9 +8,18 @@ SevenBag::SevenBag() {
     reset();
 }
 
+SevenBag::SevenBag(uint32_t seed) {
+    reset(seed);
+}
+
 void SevenBag::reset() {
+    reset(std::random_device{}());
+}
+
+void SevenBag::reset(uint32_t seed) {
     // Initialize PRNG
-    srand(time(0));
+    m_rng.seed(seed);
+    m_queue_head = 0;
     // Initialize Seven-Bag
     shuffleBag();
     // Initialize Tetromino queue
@@ -21,7 +30,12 @@ void SevenBag::shuffleBag() {
     for (int i = 0; i < N_TETROMINOS; i++) {
         m_bag[i] = i;
     }
-    std::random_shuffle(m_bag.begin(), m_bag.end());
+    // Fisher-Yates, spelled out because how std::shuffle draws from the
+    // generator is up to the standard library; this way a seed deals the
+    // same Tetrominos whatever the compiler
+    for (int i = N_TETROMINOS - 1; i > 0; i--) {
+        std::swap(m_bag[i], m_bag[m_rng() % (i + 1)]);
+    }
     m_next_bag_element = 0;
 }
 
@@ -75,3 +89,10 @@ std::array<TetrominoKind_t, QUEUE_LEN> SevenBag::getQueue() {
     }
     return ret_queue;
 }
+
+/*
+ * Return how many Tetrominos have been pulled from the current bag
+ */
+int SevenBag::getBagPosition() const {
+    return m_next_bag_element;
+}
@@ -0,0 +1,183 @@
+#include "bitboard.h"
+#include "zobrist.h"
+
+namespace {
+
+// Row masks and grid masks of every Tetromino in every orientation
+struct PieceTables {
+    std::array<std::array<PieceRows_t, 4>, N_TETROMINOS> rows;
+    std::array<std::array<PieceMask_t, 4>, N_TETROMINOS> masks;
+
+    PieceTables() {
+        for (int kind = 0; kind < N_TETROMINOS; kind++) {
+            TetroGrid_t grid = TETROMINOS[kind];
+            for (int orientation = 0; orientation < 4; orientation++) {
+                masks[kind][orientation] = 0;
+                for (int row = 0; row < 4; row++) {
+                    uint16_t mask = 0;
+                    for (int col = 0; col < 4; col++) {
+                        if (grid[row][col]) {
+                            mask |= 1 << col;
+                        }
+                    }
+                    rows[kind][orientation][row] = mask;
+                    masks[kind][orientation] |= mask << (row * 4);
+                }
+                grid = rotateClockw(kind, grid);
+            }
+        }
+    }
+
+    // Rotation according to the Super Rotation System: the I Tetromino turns
+    // within its 4x4 grid, the O doesn't turn and all others turn within the
+    // top left 3x3 part
+    static TetroGrid_t rotateClockw(int kind, const TetroGrid_t &grid) {
+        TetroGrid_t new_grid{};
+        switch (kind) {
+        case 0: // I
+            for (int row = 0; row < 4; row++) {
+                for (int col = 0; col < 4; col++) {
+                    new_grid[col][3 - row] = grid[row][col];
+                }
+            }
+            break;
+        case 3: // O
+            new_grid = grid;
+            break;
+        default: // all other Tetrominos
+            for (int row = 0; row < 3; row++) {
+                for (int col = 0; col < 3; col++) {
+                    new_grid[col][2 - row] = grid[row][col];
+                }
+            }
+        }
+        return new_grid;
+    }
+};
+
+const PieceTables &getPieceTables() {
+    static const PieceTables tables;
+    return tables;
+}
+
+} // namespace
+
+const PieceRows_t &getPieceRows(TetrominoKind_t kind, uint8_t orientation) {
+    return getPieceTables().rows[kind][orientation];
+}
+
+PieceMask_t getPieceMask(TetrominoKind_t kind, uint8_t orientation) {
+    return getPieceTables().masks[kind][orientation];
+}
+
+template <int Width, int Height>
+bool BasicBitBoard<Width, Height>::isObstructed(int x, int y) const {
+    if (x < 0 || x >= Width || y < 0 || y >= Height) {
+        return true;
+    }
+    return rows[y] & ((Row_t)1 << x);
+}
+
+/**
+ * Check whether a Tetromino with its top left corner at (x, y) overlaps
+ * neither any occupied cell nor the borders of the board
+ */
+template <int Width, int Height>
+bool BasicBitBoard<Width, Height>::fits(TetrominoKind_t kind,
+                                        uint8_t orientation, int x,
+                                        int y) const {
+    using WallRow_t = typename Size::WallRow_t;
+    // Cells outside the board when a row is shifted left by 4 bits, which
+    // leaves room for Tetrominos sticking out on the left
+    constexpr WallRow_t WALLS = ~((WallRow_t)Size::FULL_ROW << 4);
+
+    const PieceRows_t &piece = getPieceRows(kind, orientation);
+    for (int row = 0; row < 4; row++) {
+        if (!piece[row]) {
+            continue;
+        }
+        int board_y = y + row;
+        if (board_y < 0 || board_y >= Height || x < -4) {
+            return false;
+        }
+        WallRow_t board_row = ((WallRow_t)rows[board_y] << 4) | WALLS;
+        if (((WallRow_t)piece[row] << (x + 4)) & board_row) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Occupy the cells of a Tetromino. Doesn't check whether it fits.
+ */
+template <int Width, int Height>
+void BasicBitBoard<Width, Height>::place(TetrominoKind_t kind,
+                                         uint8_t orientation, int x, int y) {
+    const PieceRows_t &piece = getPieceRows(kind, orientation);
+    for (int row = 0; row < 4; row++) {
+        if (piece[row] && y + row >= 0 && y + row < Height) {
+            rows[y + row] |= (Row_t)(x >= 0 ? (Row_t)piece[row] << x
+                                            : (Row_t)piece[row] >> -x) &
+                             Size::FULL_ROW;
+        }
+    }
+}
+
+/**
+ * Remove full rows and move everything above them down
+ *
+ * @return the number of removed rows
+ */
+template <int Width, int Height>
+int BasicBitBoard<Width, Height>::clearLines() {
+    int to = Height - 1;
+    for (int from = Height - 1; from >= 0; from--) {
+        if (rows[from] != Size::FULL_ROW) {
+            rows[to--] = rows[from];
+        }
+    }
+    int n_cleared = to + 1;
+    for (; to >= 0; to--) {
+        rows[to] = 0;
+    }
+    return n_cleared;
+}
+
+/**
+ * Get the vertical position a Tetromino would land at if hard dropped from
+ * (x, y), which must fit
+ */
+template <int Width, int Height>
+int BasicBitBoard<Width, Height>::dropY(TetrominoKind_t kind,
+                                        uint8_t orientation, int x,
+                                        int y) const {
+    while (fits(kind, orientation, x, y + 1)) {
+        y++;
+    }
+    return y;
+}
+
+/**
+ * Get the Zobrist hash of the occupied cells; equal to the hash of a
+ * Playfield with the same cells occupied
+ */
+template <int Width, int Height>
+uint64_t BasicBitBoard<Width, Height>::getHash() const {
+    uint64_t hash = 0;
+    for (int row = 0; row < Height; row++) {
+        for (Row_t bits = rows[row]; bits; bits &= bits - 1) {
+            hash ^= ZOBRIST_CELLS<Width, Height>[row][__builtin_ctzll(bits)];
+        }
+    }
+    return hash;
+}
+
+template <int Width, int Height>
+bool BasicBitBoard<Width, Height>::operator==(
+    const BasicBitBoard &other) const {
+    return rows == other.rows;
+}
+
+template struct BasicBitBoard<GRID_SIZE_X, GRID_SIZE_Y>;
+template struct BasicBitBoard<WIDE_GRID_SIZE_X, GRID_SIZE_Y>;
@@ -0,0 +1,120 @@
+#include "collision.h"
+
+template <int Width, int Height>
+BasicCollisionMap<Width, Height>::BasicCollisionMap()
+    : BasicCollisionMap(BasicBitBoard<Width, Height>()) {}
+
+template <int Width, int Height>
+BasicCollisionMap<Width, Height>::BasicCollisionMap(
+    const BasicBitBoard<Width, Height> &board) {
+    reset(board);
+}
+
+/**
+ * Switch to another board; the poses are computed again when needed
+ */
+template <int Width, int Height>
+void BasicCollisionMap<Width, Height>::reset(
+    const BasicBitBoard<Width, Height> &board) {
+    m_board = board;
+    m_built = 0;
+    // Rows below the board are always obstructed
+    m_columns.fill(~(uint64_t)0 << Height);
+    for (int y = 0; y < Height; y++) {
+        for (auto bits = board.rows[y]; bits; bits &= bits - 1) {
+            m_columns[OFFSET_X + __builtin_ctzll(bits)] |= (uint64_t)1 << y;
+        }
+    }
+    // Walls
+    for (int i = 0; i < (int)m_columns.size(); i++) {
+        if (i < OFFSET_X || i >= OFFSET_X + Width) {
+            m_columns[i] = ~(uint64_t)0;
+        }
+    }
+}
+
+template <int Width, int Height>
+const BasicBitBoard<Width, Height> &
+BasicCollisionMap<Width, Height>::getBoard() const {
+    return m_board;
+}
+
+/**
+ * Occupied cells of column `x`, which may lie up to 3 columns left of the
+ * board or 3 columns right of it
+ */
+template <int Width, int Height>
+uint64_t BasicCollisionMap<Width, Height>::getColumn(int x) const {
+    return m_columns[x + OFFSET_X];
+}
+
+/**
+ * Compute the poses of one kind of Tetromino. A Tetromino fits at (x, y) if
+ * none of its Minos at (x + col, y + row) is occupied, i. e. if bit y is
+ * clear in every column of the board shifted right by the Mino's row.
+ */
+template <int Width, int Height>
+void BasicCollisionMap<Width, Height>::build(TetrominoKind_t kind) const {
+    for (int orientation = 0; orientation < 4; orientation++) {
+        PieceMask_t mask = getPieceMask(kind, orientation);
+        for (int i = 0; i < SIZE_X; i++) {
+            int x = i - OFFSET_X;
+            uint64_t blocked = 0;
+            forEachMino(mask, [&](int col, int row) {
+                blocked |= getColumn(x + col) >> row;
+            });
+            m_fits[kind][orientation][i] = ~blocked;
+        }
+    }
+    m_built |= 1 << kind;
+}
+
+template <int Width, int Height>
+const std::array<uint64_t, BasicCollisionMap<Width, Height>::SIZE_X> &
+BasicCollisionMap<Width, Height>::getPoses(TetrominoKind_t kind,
+                                             uint8_t orientation) const {
+    if (!(m_built & (1 << kind))) {
+        build(kind);
+    }
+    return m_fits[kind][orientation];
+}
+
+/**
+ * Check whether a Tetromino with its top left corner at (x, y) overlaps
+ * neither any occupied cell nor the borders of the board; same as
+ * BitBoard::fits
+ */
+template <int Width, int Height>
+bool BasicCollisionMap<Width, Height>::fits(TetrominoKind_t kind,
+                                            uint8_t orientation, int x,
+                                            int y) const {
+    if (x < -OFFSET_X || x >= Width || y >= Height) {
+        return false;
+    }
+    if (y < 0) {
+        // Only the top rows of a Tetromino can stick out of the board, which
+        // is rare enough to not be worth storing
+        return m_board.fits(kind, orientation, x, y);
+    }
+    return (getPoses(kind, orientation)[x + OFFSET_X] >> y) & 1;
+}
+
+/**
+ * Get the vertical position a Tetromino would land at if hard dropped from
+ * (x, y), which must fit
+ */
+template <int Width, int Height>
+int BasicCollisionMap<Width, Height>::dropY(TetrominoKind_t kind,
+                                            uint8_t orientation, int x,
+                                            int y) const {
+    if (y < 0) {
+        return m_board.dropY(kind, orientation, x, y);
+    }
+    // The first pose below that doesn't fit; there always is one since
+    // nothing fits below the board
+    uint64_t blocked = ~getPoses(kind, orientation)[x + OFFSET_X];
+    return y + __builtin_ctzll(blocked >> (y + 1));
+}
+
+template class BasicCollisionMap<GRID_SIZE_X, GRID_SIZE_Y>;
+template class BasicCollisionMap<WIDE_GRID_SIZE_X, GRID_SIZE_Y>;
@@ -0,0 +1,99 @@
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+#include "config.h"
+
+static std::string trim(const std::string &s) {
+    size_t begin = s.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = s.find_last_not_of(" \t\r");
+    return s.substr(begin, end - begin + 1);
+}
+
+/*
+ * A setting in the config file and the range of valid values
+ */
+struct Setting {
+    const char *key;
+    double *value;
+    double min, max;
+};
+
+/**
+ * Load settings from a config file. Each line holds a `key = value` pair;
+ * empty lines and lines starting with '#' are ignored. Settings that don't
+ * appear in the file keep their current value.
+ *
+ *     das = 133.3
+ *     arr = 0
+ *     soft_drop_factor = inf
+ *     stick_press = 0.5
+ *     stick_release = 0.35
+ *     volume = 0.5
+ *
+ * @return false if the file doesn't exist
+ * @throws std::invalid_argument if the file contains an invalid line
+ */
+bool loadConfig(const std::string &path, Config &config) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    const Setting settings[] = {
+        {"das", &config.handling.das_ms, 0, 10000},
+        {"arr", &config.handling.arr_ms, 0, 10000},
+        {"soft_drop_factor", &config.handling.soft_drop_factor, 1, INFINITY},
+        {"stick_press", &config.gamepad.stick_press, 0.05, 1},
+        {"stick_release", &config.gamepad.stick_release, 0.05, 1},
+        {"volume", &config.audio.volume, 0, 1},
+    };
+    std::string line;
+    for (int line_number = 1; std::getline(file, line); line_number++) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::string where = path + ":" + std::to_string(line_number);
+        size_t equals = line.find('=');
+        if (equals == std::string::npos) {
+            throw std::invalid_argument(where + ": expected 'key = value'");
+        }
+        std::string key = trim(line.substr(0, equals));
+        std::string value = trim(line.substr(equals + 1));
+        double number;
+        try {
+            size_t n_parsed;
+            number = std::stod(value, &n_parsed);
+            if (n_parsed != value.size()) {
+                throw std::invalid_argument(value);
+            }
+        } catch (const std::exception &) {
+            throw std::invalid_argument(where + ": invalid number '" + value +
+                                        "'");
+        }
+        const Setting *setting = nullptr;
+        for (const Setting &candidate : settings) {
+            if (key == candidate.key) {
+                setting = &candidate;
+            }
+        }
+        if (!setting) {
+            throw std::invalid_argument(where + ": unknown setting '" + key +
+                                        "'");
+        }
+        // Also rejects NaN
+        if (!(number >= setting->min && number <= setting->max)) {
+            throw std::invalid_argument(where + ": " + key +
+                                        " out of range");
+        }
+        *setting->value = number;
+    }
+    if (config.gamepad.stick_release > config.gamepad.stick_press) {
+        throw std::invalid_argument(path +
+                                    ": stick_release above stick_press");
+    }
+    return true;
+}
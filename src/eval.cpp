@@ -0,0 +1,374 @@
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define EVAL_X86
+#include <immintrin.h>
+#endif
+
+#include "eval.h"
+#include "zobrist.h"
+
+/**
+ * Hash of a set of weights, telling apart scores of different evaluators
+ * that share a TranspositionTable
+ */
+uint64_t fingerprintWeights(const EvalWeights &weights) {
+    uint64_t state = 0;
+    uint64_t hash = 0;
+    for (const auto &[name, weight] : EVAL_WEIGHT_NAMES) {
+        uint32_t bits;
+        std::memcpy(&bits, &(weights.*weight), sizeof(bits));
+        state ^= bits;
+        hash = splitMix64(state);
+    }
+    return hash;
+}
+
+bool EvalFeatures::operator==(const EvalFeatures &other) const {
+    return aggregate_height == other.aggregate_height &&
+           holes == other.holes && bumpiness == other.bumpiness &&
+           row_transitions == other.row_transitions &&
+           column_transitions == other.column_transitions &&
+           wells == other.wells;
+}
+
+void BoardBatch::set(int i, const BitBoard &board) {
+    for (int row = 0; row < GRID_SIZE_Y; row++) {
+        rows[row][i] = board.rows[row];
+    }
+}
+
+/**
+ * Append a board to the batch, which must not be full
+ */
+void BoardBatch::push(const BitBoard &board) {
+    set(size++, board);
+}
+
+namespace {
+
+// Masks used by the bitwise implementations, see computeFeaturesBatchScalar
+// Walls on both sides of a row shifted left by one
+const BitRow_t WALL_BITS = 1 | (1 << (GRID_SIZE_X + 1));
+// Pairs of neighbouring cells (including the walls) in a shifted row
+const BitRow_t ROW_PAIRS = (1 << (GRID_SIZE_X + 1)) - 1;
+// Pairs of neighbouring columns in an unshifted row
+const BitRow_t COLUMN_PAIRS = FULL_ROW >> 1;
+// Columns in a shifted row
+const BitRow_t SHIFTED_COLUMNS = FULL_ROW << 1;
+
+/*
+ * Compute the features of all boards with bit operations, row by row from top
+ * to bottom. `seen` holds the columns that have an occupied cell in the
+ * current row or above, i. e. the columns whose height reaches the current
+ * row. Every feature can be expressed as a sum of per-row population counts:
+ * - aggregate height: columns in `seen`
+ * - holes: empty cells in columns that were in `seen` already
+ * - bumpiness: neighbouring columns of which only one is in `seen`
+ * - row transitions: neighbouring cells that differ, with walls
+ * - column transitions: cells that differ from the one above
+ * - wells: columns not in `seen` whose neighbours (or walls) are
+ */
+void computeFeaturesBatchScalar(const BoardBatch &batch,
+                                EvalFeatures *features) {
+    for (int i = 0; i < EVAL_BATCH_SIZE; i++) {
+        BitRow_t seen = 0, prev = 0;
+        EvalFeatures f{};
+        for (int r = 0; r < GRID_SIZE_Y; r++) {
+            BitRow_t row = batch.rows[r][i];
+            f.holes += __builtin_popcount(seen & ~row);
+            seen |= row;
+            f.aggregate_height += __builtin_popcount(seen);
+            f.bumpiness += __builtin_popcount((seen ^ (seen >> 1)) &
+                                              COLUMN_PAIRS);
+            BitRow_t walled = (row << 1) | WALL_BITS;
+            f.row_transitions +=
+                __builtin_popcount((walled ^ (walled >> 1)) & ROW_PAIRS);
+            f.column_transitions += __builtin_popcount(row ^ prev);
+            prev = row;
+            BitRow_t seen_walled = (seen << 1) | WALL_BITS;
+            f.wells += __builtin_popcount(~seen_walled & (seen_walled << 1) &
+                                          (seen_walled >> 1) &
+                                          SHIFTED_COLUMNS);
+        }
+        // The floor counts as occupied
+        f.column_transitions += __builtin_popcount(~prev & FULL_ROW);
+        features[i] = f;
+    }
+}
+
+#ifdef EVAL_X86
+
+/*
+ * Population count of every 16 bit lane, using a lookup table for nibbles
+ */
+__attribute__((target("sse4.1"))) inline __m128i popcount16(__m128i v) {
+    const __m128i lut =
+        _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    __m128i lo = _mm_and_si128(v, nibble);
+    __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), nibble);
+    __m128i bytes =
+        _mm_add_epi8(_mm_shuffle_epi8(lut, lo), _mm_shuffle_epi8(lut, hi));
+    return _mm_add_epi16(_mm_and_si128(bytes, _mm_set1_epi16(0xff)),
+                         _mm_srli_epi16(bytes, 8));
+}
+
+__attribute__((target("avx2"))) inline __m256i popcount16(__m256i v) {
+    const __m256i lut =
+        _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1,
+                         1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    __m256i lo = _mm256_and_si256(v, nibble);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble);
+    __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(lut, lo),
+                                    _mm256_shuffle_epi8(lut, hi));
+    return _mm256_add_epi16(_mm256_and_si256(bytes, _mm256_set1_epi16(0xff)),
+                            _mm256_srli_epi16(bytes, 8));
+}
+
+// Same algorithm as computeFeaturesBatchScalar, 8 boards at a time
+__attribute__((target("sse4.1"))) void
+computeFeaturesBatchSSE41(const BoardBatch &batch, EvalFeatures *features) {
+    const __m128i wall_bits = _mm_set1_epi16(WALL_BITS);
+    const __m128i row_pairs = _mm_set1_epi16(ROW_PAIRS);
+    const __m128i column_pairs = _mm_set1_epi16(COLUMN_PAIRS);
+    const __m128i shifted_columns = _mm_set1_epi16(SHIFTED_COLUMNS);
+    const __m128i full_row = _mm_set1_epi16(FULL_ROW);
+    for (int half = 0; half < EVAL_BATCH_SIZE; half += 8) {
+        __m128i seen = _mm_setzero_si128(), prev = _mm_setzero_si128();
+        __m128i height = _mm_setzero_si128(), holes = _mm_setzero_si128();
+        __m128i bumpiness = _mm_setzero_si128(), wells = _mm_setzero_si128();
+        __m128i row_trans = _mm_setzero_si128();
+        __m128i col_trans = _mm_setzero_si128();
+        for (int r = 0; r < GRID_SIZE_Y; r++) {
+            __m128i row = _mm_load_si128((const __m128i *)&batch.rows[r][half]);
+            holes = _mm_add_epi16(holes, popcount16(_mm_andnot_si128(row, seen)));
+            seen = _mm_or_si128(seen, row);
+            height = _mm_add_epi16(height, popcount16(seen));
+            bumpiness = _mm_add_epi16(
+                bumpiness,
+                popcount16(_mm_and_si128(
+                    _mm_xor_si128(seen, _mm_srli_epi16(seen, 1)), column_pairs)));
+            __m128i walled = _mm_or_si128(_mm_slli_epi16(row, 1), wall_bits);
+            row_trans = _mm_add_epi16(
+                row_trans,
+                popcount16(_mm_and_si128(
+                    _mm_xor_si128(walled, _mm_srli_epi16(walled, 1)), row_pairs)));
+            col_trans =
+                _mm_add_epi16(col_trans, popcount16(_mm_xor_si128(row, prev)));
+            prev = row;
+            __m128i seen_walled = _mm_or_si128(_mm_slli_epi16(seen, 1), wall_bits);
+            __m128i well = _mm_and_si128(_mm_slli_epi16(seen_walled, 1),
+                                         _mm_srli_epi16(seen_walled, 1));
+            well = _mm_and_si128(_mm_andnot_si128(seen_walled, well),
+                                 shifted_columns);
+            wells = _mm_add_epi16(wells, popcount16(well));
+        }
+        col_trans = _mm_add_epi16(col_trans,
+                                  popcount16(_mm_andnot_si128(prev, full_row)));
+
+        alignas(16) uint16_t out[6][8];
+        _mm_store_si128((__m128i *)out[0], height);
+        _mm_store_si128((__m128i *)out[1], holes);
+        _mm_store_si128((__m128i *)out[2], bumpiness);
+        _mm_store_si128((__m128i *)out[3], row_trans);
+        _mm_store_si128((__m128i *)out[4], col_trans);
+        _mm_store_si128((__m128i *)out[5], wells);
+        for (int i = 0; i < 8; i++) {
+            features[half + i] = {out[0][i], out[1][i], out[2][i],
+                                  out[3][i], out[4][i], out[5][i]};
+        }
+    }
+}
+
+// Same algorithm as computeFeaturesBatchScalar, all 16 boards at once
+__attribute__((target("avx2"))) void
+computeFeaturesBatchAVX2(const BoardBatch &batch, EvalFeatures *features) {
+    const __m256i wall_bits = _mm256_set1_epi16(WALL_BITS);
+    const __m256i row_pairs = _mm256_set1_epi16(ROW_PAIRS);
+    const __m256i column_pairs = _mm256_set1_epi16(COLUMN_PAIRS);
+    const __m256i shifted_columns = _mm256_set1_epi16(SHIFTED_COLUMNS);
+    const __m256i full_row = _mm256_set1_epi16(FULL_ROW);
+    __m256i seen = _mm256_setzero_si256(), prev = _mm256_setzero_si256();
+    __m256i height = _mm256_setzero_si256(), holes = _mm256_setzero_si256();
+    __m256i bumpiness = _mm256_setzero_si256();
+    __m256i wells = _mm256_setzero_si256();
+    __m256i row_trans = _mm256_setzero_si256();
+    __m256i col_trans = _mm256_setzero_si256();
+    for (int r = 0; r < GRID_SIZE_Y; r++) {
+        __m256i row = _mm256_load_si256((const __m256i *)&batch.rows[r][0]);
+        holes = _mm256_add_epi16(holes,
+                                 popcount16(_mm256_andnot_si256(row, seen)));
+        seen = _mm256_or_si256(seen, row);
+        height = _mm256_add_epi16(height, popcount16(seen));
+        bumpiness = _mm256_add_epi16(
+            bumpiness, popcount16(_mm256_and_si256(
+                           _mm256_xor_si256(seen, _mm256_srli_epi16(seen, 1)),
+                           column_pairs)));
+        __m256i walled = _mm256_or_si256(_mm256_slli_epi16(row, 1), wall_bits);
+        row_trans = _mm256_add_epi16(
+            row_trans,
+            popcount16(_mm256_and_si256(
+                _mm256_xor_si256(walled, _mm256_srli_epi16(walled, 1)),
+                row_pairs)));
+        col_trans = _mm256_add_epi16(col_trans,
+                                     popcount16(_mm256_xor_si256(row, prev)));
+        prev = row;
+        __m256i seen_walled =
+            _mm256_or_si256(_mm256_slli_epi16(seen, 1), wall_bits);
+        __m256i well = _mm256_and_si256(_mm256_slli_epi16(seen_walled, 1),
+                                        _mm256_srli_epi16(seen_walled, 1));
+        well = _mm256_and_si256(_mm256_andnot_si256(seen_walled, well),
+                                shifted_columns);
+        wells = _mm256_add_epi16(wells, popcount16(well));
+    }
+    col_trans = _mm256_add_epi16(
+        col_trans, popcount16(_mm256_andnot_si256(prev, full_row)));
+
+    alignas(32) uint16_t out[6][16];
+    _mm256_store_si256((__m256i *)out[0], height);
+    _mm256_store_si256((__m256i *)out[1], holes);
+    _mm256_store_si256((__m256i *)out[2], bumpiness);
+    _mm256_store_si256((__m256i *)out[3], row_trans);
+    _mm256_store_si256((__m256i *)out[4], col_trans);
+    _mm256_store_si256((__m256i *)out[5], wells);
+    for (int i = 0; i < EVAL_BATCH_SIZE; i++) {
+        features[i] = {out[0][i], out[1][i], out[2][i],
+                       out[3][i], out[4][i], out[5][i]};
+    }
+}
+
+#endif
+
+using BatchFunction = void (*)(const BoardBatch &, EvalFeatures *);
+
+struct BatchImplementation {
+    BatchFunction function;
+    const char *name;
+};
+
+BatchImplementation selectImplementation() {
+#ifdef EVAL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {computeFeaturesBatchAVX2, "AVX2"};
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return {computeFeaturesBatchSSE41, "SSE4.1"};
+    }
+#endif
+    return {computeFeaturesBatchScalar, "scalar"};
+}
+
+const BatchImplementation &getImplementation() {
+    static const BatchImplementation implementation = selectImplementation();
+    return implementation;
+}
+
+} // namespace
+
+BoardEvaluator::BoardEvaluator() : BoardEvaluator(EvalWeights{}) {}
+
+BoardEvaluator::BoardEvaluator(const EvalWeights &weights)
+    : m_weights(weights) {}
+
+const EvalWeights &BoardEvaluator::getWeights() const {
+    return m_weights;
+}
+
+uint64_t BoardEvaluator::fingerprint() const {
+    return fingerprintWeights(m_weights);
+}
+
+float BoardEvaluator::score(const EvalFeatures &features) const {
+    return m_weights.aggregate_height * features.aggregate_height +
+           m_weights.holes * features.holes +
+           m_weights.bumpiness * features.bumpiness +
+           m_weights.row_transitions * features.row_transitions +
+           m_weights.column_transitions * features.column_transitions +
+           m_weights.wells * features.wells;
+}
+
+/**
+ * Score a single board using the reference implementation
+ */
+float BoardEvaluator::evaluate(const BitBoard &board) const {
+    return score(computeFeatures(board));
+}
+
+/**
+ * Score all boards of a batch
+ *
+ * @param scores receives `batch.size` scores
+ */
+void BoardEvaluator::evaluateBatch(const BoardBatch &batch,
+                                   float *scores) const {
+    std::array<EvalFeatures, EVAL_BATCH_SIZE> features;
+    computeFeaturesBatch(batch, features.data());
+    for (int i = 0; i < batch.size; i++) {
+        scores[i] = score(features[i]);
+    }
+}
+
+/**
+ * Reference implementation: compute the features cell by cell, straight from
+ * their definitions
+ */
+EvalFeatures BoardEvaluator::computeFeatures(const BitBoard &board) {
+    EvalFeatures f{};
+    std::array<int, GRID_SIZE_X> heights{};
+    for (int col = 0; col < GRID_SIZE_X; col++) {
+        bool above = false;
+        for (int row = 0; row < GRID_SIZE_Y; row++) {
+            bool filled = board.isObstructed(col, row);
+            if (filled && !above) {
+                heights[col] = GRID_SIZE_Y - row;
+            }
+            if (!filled && above) {
+                f.holes++;
+            }
+            above = above || filled;
+            // The cell above the top row is empty
+            bool filled_above = row > 0 && board.isObstructed(col, row - 1);
+            f.column_transitions += filled != filled_above;
+        }
+        // The floor counts as occupied
+        f.column_transitions += !board.isObstructed(col, GRID_SIZE_Y - 1);
+        f.aggregate_height += heights[col];
+    }
+    for (int col = 0; col + 1 < GRID_SIZE_X; col++) {
+        f.bumpiness += std::abs(heights[col] - heights[col + 1]);
+    }
+    for (int col = 0; col < GRID_SIZE_X; col++) {
+        // Walls are as high as the board
+        int left = col > 0 ? heights[col - 1] : GRID_SIZE_Y;
+        int right = col + 1 < GRID_SIZE_X ? heights[col + 1] : GRID_SIZE_Y;
+        f.wells += std::max(0, std::min(left, right) - heights[col]);
+    }
+    for (int row = 0; row < GRID_SIZE_Y; row++) {
+        // isObstructed() treats the walls as occupied
+        for (int col = -1; col < GRID_SIZE_X; col++) {
+            f.row_transitions +=
+                board.isObstructed(col, row) != board.isObstructed(col + 1, row);
+        }
+    }
+    return f;
+}
+
+/**
+ * Compute the features of all EVAL_BATCH_SIZE boards of a batch (unused
+ * slots included) using the fastest implementation the CPU supports
+ */
+void BoardEvaluator::computeFeaturesBatch(const BoardBatch &batch,
+                                          EvalFeatures *features) {
+    getImplementation().function(batch, features);
+}
+
+/**
+ * Get the name of the batch implementation chosen for this CPU
+ */
+const char *BoardEvaluator::getImplementationName() {
+    return getImplementation().name;
+}
@@ -0,0 +1,94 @@
+#include <chrono>
+#include <iostream>
+
+#include "events.h"
+
+// How often the logger looks for new events
+inline const int EVENT_LOGGER_POLL_MS = 10;
+
+/**
+ * Take the oldest event not seen yet; only to be called by the subscriber
+ *
+ * @return false if there is none
+ */
+bool EventSubscription::poll(GameEvent &event) {
+    return m_queue.pop(event);
+}
+
+/**
+ * @return the number of events dropped since the last call
+ */
+int EventSubscription::takeDropped() {
+    return m_dropped.exchange(0, std::memory_order_relaxed);
+}
+
+/**
+ * Add a subscriber, which receives all events published from now on
+ *
+ * @return nullptr if there are EVENT_BUS_MAX_SUBSCRIBERS already
+ */
+EventSubscription *EventBus::subscribe() {
+    int n = m_n_subscriptions.load(std::memory_order_relaxed);
+    if (n == EVENT_BUS_MAX_SUBSCRIBERS) {
+        return nullptr;
+    }
+    m_subscriptions[n] = std::make_unique<EventSubscription>();
+    EventSubscription *subscription = m_subscriptions[n].get();
+    // The publisher only looks at the subscription once it's complete
+    m_n_subscriptions.store(n + 1, std::memory_order_release);
+    return subscription;
+}
+
+void EventBus::publish(const GameEvent &event) {
+    int n = m_n_subscriptions.load(std::memory_order_acquire);
+    for (int i = 0; i < n; i++) {
+        EventSubscription &subscription = *m_subscriptions[i];
+        if (!subscription.m_queue.push(event)) {
+            subscription.m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+EventLogger::EventLogger(EventBus &bus) : m_events(bus.subscribe()) {
+    if (m_events) {
+        m_thread = std::thread(&EventLogger::run, this);
+    }
+}
+
+EventLogger::~EventLogger() {
+    m_stop = true;
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+/**
+ * Logger thread: print events until the logger is destroyed
+ */
+void EventLogger::run() {
+    bool stopping = false;
+    while (!stopping) {
+        // Events published before stopping are still printed
+        stopping = m_stop;
+        GameEvent event;
+        while (m_events->poll(event)) {
+            log(event);
+        }
+        if (int dropped = m_events->takeDropped()) {
+            std::cout << "WARNING: Missed " << dropped << " game events\n";
+        }
+        std::cout.flush();
+        if (!stopping) {
+            std::this_thread::sleep_for(
+                std::chrono::milliseconds(EVENT_LOGGER_POLL_MS));
+        }
+    }
+}
+
+void EventLogger::log(const GameEvent &event) {
+    if (event.type != GameEventType::TSpin) {
+        return;
+    }
+    std::cout << (event.lock.t_spin == MiniTSpin ? "Mini T-Spin" : "T-Spin")
+              << ", clearing " << event.lock.cleared << " lines!\n";
+}
@@ -0,0 +1,58 @@
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+#include "filewriter.h"
+
+FileWriter::FileWriter() : m_thread(&FileWriter::run, this) {}
+
+FileWriter::~FileWriter() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+}
+
+/**
+ * Queue `data` for writing to `path`; returns right away
+ *
+ * @param append whether to append to the file instead of replacing it
+ */
+void FileWriter::write(const std::string &path, std::vector<uint8_t> data,
+                       bool append) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.push_back({path, std::move(data), append});
+    }
+    m_cv.notify_all();
+}
+
+/**
+ * Writer thread: do queued writes until the writer is destroyed
+ */
+void FileWriter::run() {
+    std::vector<PendingWrite> writes;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_cv.wait(lock, [this] { return m_stop || !m_pending.empty(); });
+        if (m_pending.empty()) {
+            return;
+        }
+        writes.swap(m_pending);
+        lock.unlock();
+        for (const PendingWrite &write : writes) {
+            std::ofstream out(write.path, write.append
+                                              ? std::ios::binary |
+                                                    std::ios::app
+                                              : std::ios::binary);
+            out.write((const char *)write.data.data(), write.data.size());
+            if (!out) {
+                std::cerr << "ERROR: Couldn't write " << write.path << "\n";
+            }
+        }
+        writes.clear();
+        lock.lock();
+    }
+}
@@ -0,0 +1,267 @@
+#include <algorithm>
+#include <map>
+
+#include "finesse.h"
+
+namespace {
+
+// Columns are offset so that Tetrominos sticking out of the left wall have
+// non-negative indices
+const int OFFSET = 3;
+const int SIZE_X = GRID_SIZE_X + OFFSET;
+const uint8_t UNREACHABLE = 255;
+
+/*
+ * Fewest keys needed to hard drop each Tetromino with each orientation and
+ * column on an empty board, starting from the spawn position. Rotations are
+ * only considered where they succeed without a kick.
+ */
+struct FinesseTable {
+    std::array<std::array<std::array<uint8_t, SIZE_X>, 4>, N_TETROMINOS>
+        inputs;
+
+    FinesseTable() {
+        for (int kind = 0; kind < N_TETROMINOS; kind++) {
+            search(kind);
+            mergeEquivalent(kind);
+        }
+    }
+
+    static bool fits(int kind, int orientation, int x) {
+        static const BitBoard empty;
+        return empty.fits(kind, orientation, x, STARTING_POSITION_Y);
+    }
+
+    // Breadth first search over (orientation, column), where every key press
+    // is one step
+    void search(int kind) {
+        for (auto &row : inputs[kind]) {
+            row.fill(UNREACHABLE);
+        }
+        std::vector<std::pair<int, int>> queue;
+        inputs[kind][0][STARTING_POSITION_X + OFFSET] = 0;
+        queue.push_back({0, STARTING_POSITION_X});
+        for (size_t head = 0; head < queue.size(); head++) {
+            auto [orientation, x] = queue[head];
+            uint8_t cost = inputs[kind][orientation][x + OFFSET];
+            // Tap left and right, DAS to either wall, rotate both ways
+            int das_left = x, das_right = x;
+            while (fits(kind, orientation, das_left - 1)) {
+                das_left--;
+            }
+            while (fits(kind, orientation, das_right + 1)) {
+                das_right++;
+            }
+            std::array<std::pair<int, int>, 6> next = {{
+                {orientation, x - 1},
+                {orientation, x + 1},
+                {orientation, das_left},
+                {orientation, das_right},
+                {(orientation + 1) % 4, x},
+                {(orientation + 3) % 4, x},
+            }};
+            for (auto [o, nx] : next) {
+                if (nx + OFFSET < 0 || nx >= GRID_SIZE_X ||
+                    !fits(kind, o, nx)) {
+                    continue;
+                }
+                uint8_t &known = inputs[kind][o][nx + OFFSET];
+                if (known == UNREACHABLE) {
+                    known = cost + 1;
+                    queue.push_back({o, nx});
+                }
+            }
+        }
+    }
+
+    // Positions occupying the same cells after the drop are interchangeable,
+    // e. g. the horizontal S in orientation 0 and 2
+    void mergeEquivalent(int kind) {
+        std::map<uint64_t, uint8_t> best;
+        auto cells = [kind](int orientation, int x) {
+            BitBoard board;
+            board.place(kind, orientation, x,
+                        board.dropY(kind, orientation, x, STARTING_POSITION_Y));
+            uint64_t key = 0;
+            for (int row = GRID_SIZE_Y - 4; row < GRID_SIZE_Y; row++) {
+                key = key << 16 | board.rows[row];
+            }
+            return key;
+        };
+        for (int pass = 0; pass < 2; pass++) {
+            for (int orientation = 0; orientation < 4; orientation++) {
+                for (int x = -OFFSET; x < GRID_SIZE_X; x++) {
+                    uint8_t &known = inputs[kind][orientation][x + OFFSET];
+                    if (known == UNREACHABLE) {
+                        continue;
+                    }
+                    auto [it, inserted] =
+                        best.insert({cells(orientation, x), known});
+                    if (pass == 0) {
+                        it->second = std::min(it->second, known);
+                    } else {
+                        known = it->second;
+                    }
+                }
+            }
+        }
+    }
+};
+
+const FinesseTable &getFinesseTable() {
+    static const FinesseTable table;
+    return table;
+}
+
+} // namespace
+
+/**
+ * Fewest keys needed to hard drop a Tetromino at a position on an empty
+ * board, or -1 if it can't be reached without kicks
+ */
+int FinesseAnalyzer::dropInputs(TetrominoKind_t kind, uint8_t orientation,
+                                int x) {
+    if (x + OFFSET < 0 || x >= GRID_SIZE_X) {
+        return -1;
+    }
+    uint8_t inputs = getFinesseTable().inputs[kind][orientation][x + OFFSET];
+    return inputs == UNREACHABLE ? -1 : inputs;
+}
+
+/**
+ * Fewest keys needed to lock a Tetromino down at a placement on a board, or
+ * -1 if the placement can't be reached
+ */
+int FinesseAnalyzer::optimalInputs(const BitBoard &board, TetrominoKind_t kind,
+                                   const Placement &placement) {
+    int inputs = dropInputs(kind, placement.orientation, placement.x);
+    // Straight drops are the common case and are covered by the table,
+    // unless the way down is blocked
+    if (inputs >= 0 &&
+        board.fits(kind, placement.orientation, placement.x,
+                   STARTING_POSITION_Y) &&
+        board.dropY(kind, placement.orientation, placement.x,
+                    STARTING_POSITION_Y) == placement.y) {
+        return inputs;
+    }
+    return searchInputs(board, kind, placement);
+}
+
+/**
+ * Count the keys along the shortest path the PlacementEnumerator finds to a
+ * placement. A path doesn't tell taps from DAS, so a run of more than two
+ * shifts in one direction is counted as DAS and a correction. Steps down
+ * before a tuck or spin are counted as a single soft drop, steps down at the
+ * end are the hard drop.
+ */
+int FinesseAnalyzer::searchInputs(const BitBoard &board, TetrominoKind_t kind,
+                                  const Placement &placement) {
+    BitBoard target = board;
+    target.place(kind, placement.orientation, placement.x, placement.y);
+
+    m_placements.clear();
+    m_enumerator.enumerate(CollisionMap(board), kind, m_placements);
+    for (const Placement &candidate : m_placements) {
+        BitBoard result = board;
+        result.place(kind, candidate.orientation, candidate.x, candidate.y);
+        if (!(result == target)) {
+            continue;
+        }
+        m_path.clear();
+        m_enumerator.getPath(candidate, m_path);
+        int inputs = 0;
+        bool soft_drop = false;
+        for (size_t i = 0; i < m_path.size();) {
+            size_t run = 1;
+            while (i + run < m_path.size() && m_path[i + run] == m_path[i]) {
+                run++;
+            }
+            switch (m_path[i]) {
+            case Move::Down:
+                soft_drop |= i + run < m_path.size();
+                break;
+            case Move::Left:
+            case Move::Right:
+                inputs += std::min<int>(run, 2);
+                break;
+            default:
+                inputs += run;
+            }
+            i += run;
+        }
+        return inputs + soft_drop;
+    }
+    return -1;
+}
+
+/**
+ * Start analyzing a new game
+ */
+void FinesseAnalyzer::reset(const BitBoard &board) {
+    m_board = board;
+    m_inputs = 0;
+    m_pieces = 0;
+    m_total_inputs = 0;
+    m_faults = 0;
+    m_extra_inputs = 0;
+}
+
+/**
+ * Count a key handled by the game for the current Tetromino
+ */
+void FinesseAnalyzer::onAction(Action action) {
+    switch (action) {
+    case Action::MoveLeft:
+    case Action::MoveRight:
+    case Action::RotateClockw:
+    case Action::RotateCounterclockw:
+    case Action::SoftDrop:
+        m_inputs++;
+        break;
+    case Action::Hold:
+        // The Tetromino coming out of hold starts from scratch
+        m_inputs = 0;
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * Compare the keys pressed for a Tetromino against the optimum once it locks
+ * down
+ *
+ * @param board_after the board after locking down, for the next Tetromino
+ * @return the number of extra keys pressed
+ */
+int FinesseAnalyzer::onLock(TetrominoKind_t kind, const Placement &placement,
+                            const BitBoard &board_after) {
+    int optimal = optimalInputs(m_board, kind, placement);
+    // Placements the analyzer can't reach aren't counted as faults
+    int extra = optimal < 0 ? 0 : std::max(0, m_inputs - optimal);
+    m_pieces++;
+    m_total_inputs += m_inputs;
+    m_extra_inputs += extra;
+    if (extra > 0) {
+        m_faults++;
+    }
+    m_board = board_after;
+    m_inputs = 0;
+    return extra;
+}
+
+int FinesseAnalyzer::getPieces() const {
+    return m_pieces;
+}
+
+int FinesseAnalyzer::getInputs() const {
+    return m_total_inputs;
+}
+
+int FinesseAnalyzer::getFaults() const {
+    return m_faults;
+}
+
+int FinesseAnalyzer::getExtraInputs() const {
+    return m_extra_inputs;
+}
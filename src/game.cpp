@@ -1,4 +1,9 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
 #include <iostream>
+#include <random>
+#include <sstream>
 #include <thread>
 
 #include "SDL_keycode.h"
@@ -6,92 +11,80 @@
 
 using cl = std::chrono::steady_clock;
 
-Game::Game(const std::string &assets_path)
-    : playfield(PLAYFIELD_DRAW_X, PLAYFIELD_DRAW_Y),
-      active(m_bag.popQueue(), playfield), m_hud(assets_path, m_scoring),
-      m_scoring() {
-    // Don't set m_hud's queue in initializer list since the order of
-    // initialization is not guaranteed
-    respawnActive();
+Game::Game(bool pc_hint, const std::string &stats_path,
+           SessionLog *session_log, StateExport *state_export,
+           StateStreamWriter *state_stream, const std::string &replay_dir)
+    : m_event_logger(m_events), m_audio(m_events), m_hud(m_sim.getScoring()),
+      m_stats_path(stats_path), m_session_log(session_log),
+      m_replay_dir(replay_dir), m_state_export(state_export),
+      m_state_stream(state_stream) {
+    m_sim.setEventBus(&m_events);
+    if (!m_replay_dir.empty()) {
+        m_sim.setRecorder(&m_recorder);
+    }
+    if (!m_stats_path.empty() || !m_replay_dir.empty()) {
+        m_file_writer = std::make_unique<FileWriter>();
+    }
+    m_hud.setStats(&m_stats);
+    if (pc_hint) {
+        m_pc_worker = std::make_unique<PerfectClearWorker>();
+    }
 }
 
 void Game::init() {
     restart();
 }
 
-void Game::restart() {
-    // Reset some member variables
-    m_surface_contact = false;
-    m_moving_right = false;
-    m_moving_left = false;
-    m_last_spin = false;
-    TetrominoKind_t m_held = -1;
-    bool m_can_hold = true;
+/**
+ * Start using the game controller, open the audio device and build the glyph
+ * atlas; called once the first frame is shown
+ */
+void Game::finishLoading(SDL_Renderer *renderer) {
+    m_gamepad.init();
+    m_audio.open();
+    m_hud.buildGlyphAtlas(renderer);
+}
 
-    // Schedule the first fall
-    resetFallTimer();
-    m_state = GameState::Running;
-    playfield.reset();
-    m_bag.reset();
-    active.respawn(m_bag.popQueue());
+void Game::configure(const Config &config) {
+    m_sim.setHandling(config.handling);
+    m_gamepad.setSettings(config.gamepad);
+    m_audio.setSettings(config.audio);
+}
+
+void Game::restart() {
+    cl::time_point now = cl::now();
+    m_seed = std::random_device{}();
+    m_sim.restart(now, m_seed);
+    m_stats.reset(now);
+    m_stats_exported = false;
     m_hud.reset();
-    m_hud.setQueue(m_bag.getQueue());
-    m_scoring = FixedGoalScoring(1);
+    m_finesse.reset(m_sim.playfield.getBitBoard());
+    m_n_locks = 0;
+    m_pc_hint.clear();
+    m_pc_hint_hash = 0;
 }
 
 /**
- * Main update function, handles game logic
+ * Main update function, advances the simulation and limits the framerate
  */
 void Game::update() {
-    if (m_state != GameState::Running) {
-        return;
-    }
-
     cl::time_point now = cl::now();
-    if (m_moving_right) {
-        if (m_next_mv_right < now) {
-            moveRight();
-        }
-    }
-    if (m_moving_left) {
-        if (m_next_mv_left < now) {
-            moveLeft();
+    applyInjectedActions(now);
+    // Read the controller as late as possible so that its input is applied
+    // in this frame
+    InputFrame_t input = m_gamepad.poll();
+    for (int i = 0; i < N_ACTIONS; i++) {
+        if (input & actionBit(static_cast<Action>(i))) {
+            applyAction(static_cast<Action>(i), now);
         }
     }
-
-    // Check if the falling Tetromino has made surface contact; if so, schedule
-    // lock down timer
-    if (!active.canStepDown()) {
-        if (!m_surface_contact) {
-            m_surface_contact = true;
-            scheduleLockDown();
-        }
-    } else {
-        if (m_surface_contact) {
-            // No more surface contact; resume falling / soft dropping
-            m_surface_contact = false;
-            // Reset all timers
-            resetFallTimer();
-            resetSoftDropTimer();
-        }
-    }
-
-    if (m_surface_contact) {
-        if (m_lock_down < now) {
-            // Making surface contact and lock down timer has run out
-            // Lock down Tetromino and spawn a new one
-            lockDownAndRespawnActive();
-            // If possible, step down immediatly after respawning (this is
-            // according to the Tetris Guideline)
-            performFall();
-        }
-    } else {
-        if (m_soft_dropping && m_next_soft_drop < now) {
-            performSoftDrop();
-        } else if (m_next_fall < now) {
-            performFall();
-        }
+    m_sim.update(now);
+    checkLocks();
+    if (m_sim.getState() == GameState::Running) {
+        m_stats.update(now);
     }
+    exportState(now);
+    updatePerfectClearHint();
 
     // Limit framerate; note that the variable `now` holds the time since epoch
     // at the start of this frame
@@ -102,77 +95,7 @@ void Game::update() {
 }
 
 GameState Game::getState() {
-    return m_state;
-}
-
-/**
- * Start soft dropping and immediately perform first soft drop
- */
-void Game::startSoftDropping() {
-    m_soft_dropping = true;
-    resetSoftDropTimer();
-    performSoftDrop();
-}
-
-/**
- * Stop soft dropping and resume normal falling
- */
-void Game::stopSoftDropping() {
-    m_soft_dropping = false;
-    resetFallTimer();
-}
-
-bool Game::performSoftDrop() {
-    incSoftDropTimer();
-    m_scoring.onSoftDrop();
-    return active.stepDown();
-}
-
-/**
- * Reset the soft drop timer
- */
-void Game::resetSoftDropTimer() {
-    m_next_soft_drop =
-        cl::now() + std::chrono::milliseconds((int)(m_scoring.getFallSpeedMs() *
-                                                    SOFT_DROP_DELAY_MULT));
-}
-
-/**
- * Schedule the next soft drop
- */
-void Game::incSoftDropTimer() {
-    m_next_soft_drop =
-        m_next_soft_drop +
-        std::chrono::milliseconds(
-            (int)(m_scoring.getFallSpeedMs() * SOFT_DROP_DELAY_MULT));
-}
-
-/**
- * Move the Tetromino down by one cell and set the timer for the next fall move
- */
-bool Game::performFall() {
-    incFallTimer();
-    return active.stepDown();
-}
-
-/**
- * Reset the fall timer.
- */
-void Game::resetFallTimer() {
-    m_next_fall =
-        cl::now() + std::chrono::milliseconds(m_scoring.getFallSpeedMs());
-}
-
-/**
- * Schedule the next fall
- */
-void Game::incFallTimer() {
-    m_next_fall =
-        m_next_fall + std::chrono::milliseconds(m_scoring.getFallSpeedMs());
-}
-
-void Game::scheduleLockDown() {
-    m_lock_down = cl::now() + std::chrono::milliseconds(LOCK_DOWN_DELAY_MS);
+    return m_sim.getState();
 }
 
 /**
@@ -182,362 +105,253 @@ void Game::scheduleLockDown() {
  * @param an event
  */
 void Game::handleEvent(const SDL_Event &e) {
-    switch (e.type) {
-    case SDL_KEYDOWN:
-        // Ignore repeated keys, we implement our own repeated inputs
-        if (!e.key.repeat) {
-            switch (e.key.keysym.sym) {
-            case SDLK_RIGHT:
-                if (m_state == GameState::Paused)
-                    break;
-                if (m_state == GameState::Running) {
-                    initMoveRight();
-                    m_last_spin = false;
-                }
-                break;
-            case SDLK_LEFT:
-                if (m_state == GameState::Paused)
-                    break;
-                if (m_state == GameState::Running) {
-                    initMoveLeft();
-                    m_last_spin = false;
-                }
-                break;
-            case SDLK_DOWN:
-                if (m_state == GameState::Paused)
-                    break;
-                if (m_state == GameState::Running) {
-                    startSoftDropping();
-                    m_last_spin = false;
-                }
-                break;
-            case SDLK_UP:
-                if (m_state == GameState::Paused)
-                    break;
-                if (m_state == GameState::Running) {
-                    active.rotateClockw(m_last_rotation_point);
-                    m_last_spin = true;
-                    scheduleLockDown();
-                }
-                break;
-            case SDLK_LCTRL:
-            case SDLK_RCTRL:
-                if (m_state == GameState::Paused)
-                    break;
-                if (m_state == GameState::Running) {
-                    active.rotateCounterclockw(m_last_rotation_point);
-                    m_last_spin = true;
-                    scheduleLockDown();
-                }
-                break;
-            case SDLK_SPACE:
-                if (m_state == GameState::Paused)
-                    break;
-                if (m_state == GameState::Running) {
-                    m_scoring.onHardDrop(active.hardDrop());
-                    lockDownAndRespawnActive();
-                    m_last_spin = false;
-                }
-                break;
-            case SDLK_c:
-                if (m_state == GameState::Paused)
-                    break;
-                if (m_state == GameState::Running) {
-                    hold();
-                    m_last_spin = false;
-                }
-                break;
-            case SDLK_ESCAPE:
-                if (m_state == GameState::Paused) {
-                    m_next_fall.resume();
-                    m_next_soft_drop.resume();
-                } else {
-                    m_next_fall.pause();
-                    m_next_soft_drop.pause();
-                }
-                if (m_state == GameState::Paused) {
-                    m_state = GameState::Running;
-                } else if (m_state == GameState::Running) {
-                    m_state = GameState::Paused;
-                }
-                break;
-            case SDLK_RETURN:
-                if (m_state == GameState::GameOver) {
-                    restart();
-                }
-                break;
-            }
+    m_gamepad.handleEvent(e);
+    if (m_gamepad.isStartEvent(e)) {
+        // Start pauses, or restarts once the game is over
+        if (m_sim.getState() == GameState::GameOver) {
+            restart();
+        } else {
+            togglePause();
         }
-        break;
-    case SDL_KEYUP:
+        return;
+    }
+    if (e.type == SDL_KEYDOWN && !e.key.repeat) {
         switch (e.key.keysym.sym) {
-        case SDLK_RIGHT:
-            stopMoveRight();
-            break;
-        case SDLK_LEFT:
-            stopMoveLeft();
-            break;
-        case SDLK_DOWN:
-            m_soft_dropping = false;
-            break;
+        case SDLK_ESCAPE:
+            togglePause();
+            return;
+        case SDLK_RETURN:
+            if (m_sim.getState() == GameState::GameOver) {
+                restart();
+            }
+            return;
         }
     }
+    Action action;
+    if (actionFromEvent(e, action)) {
+        applyAction(action, cl::now());
+    }
 }
 
 /**
- * Start moving the active Tetromino to the right repeatedly
+ * Apply the injected actions that are due, each one at its own time. An
+ * action injected for a time the simulation has already passed is applied
+ * right away.
  */
-void Game::initMoveRight() {
-    if (!m_moving_right) {
-        m_moving_right = true;
-        m_moving_left = false;
-        moveRight();
-        // Override the timer for the next right move set by moveRight
-        // Instead, set initial delay
-        m_next_mv_right =
-            cl::now() + std::chrono::milliseconds(KEY_INIT_DELAY_MS);
+void Game::applyInjectedActions(cl::time_point now) {
+    m_injector.takeDue(now, m_due_actions);
+    for (const InjectedAction &injected : m_due_actions) {
+        cl::time_point time = std::max(injected.time, m_sim.getTime());
+        // Catching up may lock the resting Tetromino down, which has to be
+        // seen before the action brings out and locks the next one
+        m_sim.update(time);
+        checkLocks();
+        applyAction(injected.action, time);
     }
 }
 
 /**
- * Stop moving the active Tetromino to the right
+ * Actions injected here, from any thread, are applied as if they came from
+ * the keyboard at the time given with them
  */
-void Game::stopMoveRight() {
-    m_moving_right = false;
-    const Uint8 *keystate = SDL_GetKeyboardState(NULL);
-    if (keystate[SDL_SCANCODE_LEFT] && m_state == GameState::Running) {
-        initMoveLeft();
-    }
+ActionInjector &Game::getInjector() {
+    return m_injector;
 }
 
 /**
- * Move the active Tetromino to the right by one cell
+ * Apply an action from the keyboard, the game controller or a bot
  */
-void Game::moveRight() {
-    if (active.moveRight()) {
-        // If the move was successfull, reset Lock Down timer to give the
-        // player another 0.5 seconds to move the Tetromino before it finally
-        // sets. (This happens for all sidewards movements and rotations) Only
-        // reset lockdown timer if the move was successfull
-        scheduleLockDown();
+void Game::applyAction(Action action, cl::time_point now) {
+    // A hold that isn't allowed doesn't bring out a new Tetromino
+    if (m_sim.getState() == GameState::Running &&
+        (action != Action::Hold || m_sim.canHold())) {
+        m_finesse.onAction(action);
+        m_stats.onAction(action);
     }
-    m_next_mv_right += std::chrono::milliseconds(KEY_REPEAT_DELAY_MS);
+    m_sim.apply(action, now);
+    checkLocks();
 }
 
-/**
- * Start moving the active Tetromino to the left repeatedly
- */
-void Game::initMoveLeft() {
-    if (!m_moving_left) {
-        m_moving_left = true;
-        m_moving_right = false;
-        moveLeft();
-        // Override the timer for the next left move set by moveLeft
-        // Instead, set initial delay
-        m_next_mv_left =
-            cl::now() + std::chrono::milliseconds(KEY_INIT_DELAY_MS);
+void Game::togglePause() {
+    if (m_sim.getState() == GameState::Paused) {
+        m_sim.resume(cl::now());
+        m_stats.resume(cl::now());
+    } else {
+        m_sim.pause(cl::now());
+        m_stats.pause(cl::now());
     }
 }
 
 /**
- * Stop moving the active Tetromino to the left
+ * Pass the Tetromino that was just locked down (if any) to the finesse
+ * analyzer and the statistics. Has to be called after every call into the
+ * Simulation that can lock a Tetromino down, since only the last lock down
+ * is kept.
  */
-void Game::stopMoveLeft() {
-    m_moving_left = false;
-    const Uint8 *keystate = SDL_GetKeyboardState(NULL);
-    if (keystate[SDL_SCANCODE_RIGHT] && m_state == GameState::Running) {
-        initMoveRight();
+void Game::checkLocks() {
+    if (m_sim.getLockCount() != m_n_locks) {
+        assert(m_sim.getLockCount() == m_n_locks + 1);
+        m_n_locks = m_sim.getLockCount();
+        const LockInfo &lock = m_sim.getLastLock();
+        BitBoard board = m_sim.playfield.getBitBoard();
+        int extra = m_finesse.onLock(lock.kind, lock.placement, board);
+        m_stats.onLock(lock, board == BitBoard{}, extra, cl::now());
+    }
+    if (m_sim.getState() == GameState::GameOver && !m_stats_exported) {
+        m_stats_exported = true;
+        exportStats();
+        logSession();
     }
 }
 
 /**
- * Move the active Tetromino to the left by one cell
+ * Queue the statistics of the game that just ended for appending to the stats
+ * file
  */
-void Game::moveLeft() {
-    if (active.moveLeft()) {
-        // Only reset lockdown timer if the move was successfull
-        scheduleLockDown();
+void Game::exportStats() {
+    if (m_stats_path.empty()) {
+        return;
     }
-    m_next_mv_left += std::chrono::milliseconds(KEY_REPEAT_DELAY_MS);
+    std::ostringstream out;
+    m_stats.write(out);
+    std::string text = out.str();
+    m_file_writer->write(m_stats_path,
+                         std::vector<uint8_t>(text.begin(), text.end()), true);
 }
 
 /**
- * Put the current Tetromino in the "Hold" area and replace it with the
- * Tetromino that is currently m_held, spawning it at the top of the Playfield
+ * Queue the result of the game that just ended for the session log
  */
-void Game::hold() {
-    if (m_can_hold) {
-        // Disable hold until next piece is set
-        m_can_hold = false;
-        // 255 corrsponds to no value set
-        if (m_held == 255) {
-            // Set kind of m_held Tetromino to be the old active Tetrominos
-            // kind
-            m_held = active.m_type;
-            // Respawn Tetromino as new random kind
-            respawnActive();
-        } else {
-            // Store intermediate value
-            TetrominoKind_t active_kind = active.m_type;
-            // Set kind of respawned Tetromino to `m_held`
-            respawnActiveWithKind(m_held);
-            // Set kind of m_held Tetromino to be the old active Tetrominos
-            // kind
-            m_held = active_kind;
-        }
-        m_hud.setHold(m_held);
+void Game::logSession() {
+    const ScoringSystem &scoring = m_sim.getScoring();
+    SessionRecord record{};
+    record.end_time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                          std::chrono::system_clock::now().time_since_epoch())
+                          .count();
+    record.seed = m_seed;
+    record.score = scoring.getScore();
+    record.lines = scoring.getLines();
+    record.level = scoring.getLevel();
+    record.pieces = m_stats.getPieces();
+    record.duration_ms = (uint32_t)(m_stats.getSeconds() * 1000);
+    saveReplay(record);
+    if (m_session_log) {
+        m_session_log->append(record);
     }
 }
 
-void Game::draw(SDL_Renderer *renderer) {
-    playfield.draw(renderer);
-    active.drawGhost(renderer);
-    active.draw(renderer);
-    m_hud.draw(renderer, m_state);
-}
-
 /**
- * Check whether the last lock down constitutes a T-Spin or a Mini T-Spin
- *
- * @return 2 for T-Spin, 1 for Mini T-Spin, otherwise 0
+ * Queue the replay of the game that just ended for writing, named after its
+ * end time and seed, and note its name in the record. The file is written in
+ * the background, so it may not exist yet, or at all if writing it fails.
  */
-int Game::checkTSpin() {
-    // Assert that the current Tetromino is a type T one and that the last input
-    // was a rotation
-    if (active.m_type != 5 || !m_last_spin) {
-        return 0;
-    }
-
-    // Check whether the last rotation was a T-Spin. Must be called right before
-    // lock down occurs
-    if (inTSlot() || m_last_rotation_point == 5) {
-        // T-Spin
-        return 2;
-    } else if (inMiniTSlot()) {
-        // Mini T-Spin
-        return 1;
+void Game::saveReplay(SessionRecord &record) {
+    std::vector<uint8_t> replay;
+    if (m_replay_dir.empty() || !m_recorder.finish(m_sim, replay)) {
+        return;
     }
-    return 0;
+    std::snprintf(record.replay, sizeof(record.replay), "%llu-%u.rpl",
+                  (unsigned long long)record.end_time, record.seed);
+    m_file_writer->write(m_replay_dir + "/" + record.replay,
+                         std::move(replay));
 }
 
 /**
- * Check if the corners surrounding a T-Tetromino are obstructed.
+ * Publish the state of the game for external tools and stream its changes
  */
-void Game::getCorners(bool &tl, bool &tr, bool &bl, bool &br) {
-    // TODO: Maybe use bitmask instead of bools
-    // clang-format off
-    tl = playfield.isObstructed(active.m_x,     active.m_y);
-    tr = playfield.isObstructed(active.m_x + 2, active.m_y);
-    bl = playfield.isObstructed(active.m_x,     active.m_y + 2);
-    br = playfield.isObstructed(active.m_x + 2, active.m_y + 2);
-    // clang-format on
+void Game::exportState(cl::time_point now) {
+    if (!m_state_export && !m_state_stream) {
+        return;
+    }
+    const ScoringSystem &scoring = m_sim.getScoring();
+    ExportedState state{};
+    state.time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        now.time_since_epoch())
+                        .count();
+    state.score = scoring.getScore();
+    state.lines = scoring.getLines();
+    state.level = scoring.getLevel();
+    state.pieces = m_sim.getLockCount();
+    state.pending_garbage = m_sim.getPendingGarbage();
+    state.active_x = m_sim.active.m_x;
+    state.active_y = m_sim.active.m_y;
+    state.ghost_y = m_sim.active.getGhostY();
+    state.state = (uint8_t)m_sim.getState();
+    state.active_kind = m_sim.active.m_type;
+    state.active_orientation = m_sim.active.m_orientation;
+    state.held = m_sim.getHeld();
+    state.can_hold = m_sim.canHold();
+    std::array<TetrominoKind_t, QUEUE_LEN> queue = m_sim.getQueue();
+    std::copy(queue.begin(), queue.end(), state.queue);
+    for (int y = 0; y < GRID_SIZE_Y; y++) {
+        for (int x = 0; x < GRID_SIZE_X; x++) {
+            state.cells[y][x] = m_sim.playfield.getAt(x, y);
+        }
+    }
+    if (m_state_export) {
+        m_state_export->publish(state);
+    }
+    if (m_state_stream) {
+        m_state_stream->write(state);
+    }
 }
 
 /**
- * Check if the active Tetromino is currently in a T-Slot
- *
- * @return the above
+ * Look for a perfect clear with the known Tetrominos whenever a new one has
+ * spawned (or was held). The search runs in the background; its solution is
+ * shown once it arrives, if the game is still in the same position.
  */
-bool Game::inTSlot() {
-    bool tl, tr, bl, br;
-    getCorners(tl, tr, bl, br);
-
-    switch (active.m_orientation) {
-    case 0: // Facing north
-        return tl && tr && (bl || br);
-        break;
-    case 1: // Facing east
-        return tr && br && (tl || bl);
-        break;
-    case 2: // Facing south
-        return br && bl && (tr || tl);
-        break;
-    case 3: // Facing west
-        return bl && tl && (br || tr);
-        break;
-    default:
-        std::cout << "Unreachable: Rotation not in [0..3]\n";
-        exit(1);
+void Game::updatePerfectClearHint() {
+    if (!m_pc_worker || m_sim.getState() != GameState::Running) {
+        return;
+    }
+    uint64_t hash = m_sim.getHash();
+    uint64_t solved_hash;
+    std::vector<PerfectClearStep> solution;
+    // Solutions for positions the game has left are of no use
+    if (m_pc_worker->takeResult(solved_hash, solution) &&
+        solved_hash == hash) {
+        m_pc_hint.swap(solution);
     }
+    if (hash == m_pc_hint_hash) {
+        return;
+    }
+    m_pc_hint_hash = hash;
+    m_pc_hint.clear();
+    std::array<TetrominoKind_t, QUEUE_LEN> queue = m_sim.getQueue();
+    std::vector<TetrominoKind_t> preview(queue.begin(), queue.end());
+    m_pc_worker->request(hash, m_sim.playfield.getBitBoard(),
+                         m_sim.active.m_type, m_sim.getHeld(),
+                         m_sim.canHold(), preview, QUEUE_LEN + 2);
 }
 
 /**
- * Check if the active Tetromino is currently in a Mini T-Slot
- *
- * @return the above
+ * Outline where the next Tetromino of the perfect clear goes
  */
-bool Game::inMiniTSlot() {
-    bool tl, tr, bl, br;
-    getCorners(tl, tr, bl, br);
-
-    switch (active.m_orientation) {
-    case 0: // Facing north
-        return (tl || tr) && bl && br;
-        break;
-    case 1: // Facing east
-        return (tr || br) && tl && bl;
-        break;
-    case 2: // Facing south
-        return (br || bl) && tr && tl;
-        break;
-    case 3: // Facing west
-        return (bl || tl) && br && tr;
-        break;
-    default:
-        std::cout << "Unreachable: Rotation not in [0..3]\n";
-        exit(1);
+void Game::drawPerfectClearHint(SDL_Renderer *renderer) {
+    if (m_pc_hint.empty() || m_sim.getState() != GameState::Running) {
+        return;
     }
-}
-
-/*
- * Lock down the falling Tetromino, then respawn. If respawn was successful,
- * clear empty lines on the Playfield.
- */
-void Game::lockDownAndRespawnActive() {
-
-    int t_spin = checkTSpin();
-    active.lockDown();
-    if (respawnActive()) {
-        int cleared = playfield.clearEmptyLines();
-        switch (t_spin) {
-        case 0:
-            m_scoring.onLinesCleared(cleared);
-            break;
-        case 1:
-            std::cout << "Mini T-Spin, clearing " << cleared << " lines!\n";
-            m_scoring.onMiniTSpin(cleared);
-            break;
-        case 2:
-            std::cout << "T-Spin, clearing " << cleared << " lines!\n";
-            m_scoring.onTSpin(cleared);
-            break;
+    const PerfectClearStep &step = m_pc_hint.front();
+    PieceMask_t mask = getPieceMask(step.kind, step.placement.orientation);
+    SDL_SetRenderDrawColor(renderer, PC_HINT_COLOR.r, PC_HINT_COLOR.g,
+                           PC_HINT_COLOR.b, PC_HINT_COLOR.a);
+    forEachMino(mask, [&](int col, int row) {
+        int y = step.placement.y + row;
+        if (y < GRID_START_Y) {
+            return;
         }
-        resetFallTimer();
-    }
-    // Re-enable hold
-    m_can_hold = true;
+        SDL_Rect rect{PLAYFIELD_DRAW_X + (step.placement.x + col) * CELL_SIZE,
+                      PLAYFIELD_DRAW_Y + (y - GRID_START_Y) * CELL_SIZE,
+                      CELL_SIZE, CELL_SIZE};
+        SDL_RenderDrawRect(renderer, &rect);
+    });
 }
 
-/*
- * Respawn the active Tetromino, setting its kind to the next value from
- * the queue
- */
-bool Game::respawnActive() {
-    return Game::respawnActiveWithKind(m_bag.popQueue());
-}
-
-/*
- * Respawn the active Tetromino, settings its kind to the given value
- */
-bool Game::respawnActiveWithKind(TetrominoKind_t kind) {
-    if (!active.respawn(kind)) {
-        // Block Out
-        m_state = GameState::GameOver;
-        return false;
-    }
-    // Move down own cell immediatly after respawning; this is according to
-    // the Tetromino Guideline
-    active.stepDown();
-    m_hud.setQueue(m_bag.getQueue());
-    return true;
+void Game::draw(SDL_Renderer *renderer) {
+    m_sim.draw(renderer);
+    drawPerfectClearHint(renderer);
+    m_hud.setQueue(m_sim.getQueue());
+    m_hud.setHold(m_sim.getHeld());
+    m_hud.draw(renderer, m_sim.getState());
 }
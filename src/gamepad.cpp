@@ -0,0 +1,186 @@
+#include <iostream>
+#include <utility>
+
+#include "gamepad.h"
+
+// Largest value reported by an axis
+static const double AXIS_MAX = 32767;
+
+Gamepad::Gamepad(const GamepadSettings &settings) : m_settings(settings) {}
+
+/**
+ * Initialize game controller support and start using the first controller
+ * that is already connected. Until this is called, no controller is used.
+ *
+ * Enumerating the controllers can take a while, so main calls this once the
+ * first frame is shown instead of having the constructor do it.
+ */
+void Gamepad::init() {
+    if (m_initialized) {
+        return;
+    }
+    if (SDL_InitSubSystem(SDL_INIT_GAMECONTROLLER) != 0) {
+        std::cout << "WARNING: Couldn't initialize game controllers: "
+                  << SDL_GetError() << "\n";
+        return;
+    }
+    m_initialized = true;
+    for (int i = 0; i < SDL_NumJoysticks() && !m_controller; i++) {
+        open(i);
+    }
+}
+
+Gamepad::~Gamepad() {
+    // If SDL was shut down first, it has closed the controller already
+    if (m_initialized && SDL_WasInit(SDL_INIT_GAMECONTROLLER)) {
+        close();
+        SDL_QuitSubSystem(SDL_INIT_GAMECONTROLLER);
+    }
+}
+
+void Gamepad::setSettings(const GamepadSettings &settings) {
+    m_settings = settings;
+}
+
+/**
+ * Start using the controller with the given device index, unless one is
+ * already in use
+ */
+void Gamepad::open(int device_index) {
+    if (m_controller || !SDL_IsGameController(device_index)) {
+        return;
+    }
+    m_controller = SDL_GameControllerOpen(device_index);
+    if (!m_controller) {
+        return;
+    }
+    m_id = SDL_JoystickInstanceID(SDL_GameControllerGetJoystick(m_controller));
+}
+
+/**
+ * Stop using the current controller. Buttons that were held are released by
+ * the next call to poll().
+ */
+void Gamepad::close() {
+    if (m_controller) {
+        SDL_GameControllerClose(m_controller);
+        m_controller = nullptr;
+        m_id = -1;
+    }
+}
+
+/**
+ * Handle controllers being connected or disconnected. Should be called with
+ * all events.
+ */
+void Gamepad::handleEvent(const SDL_Event &e) {
+    if (!m_initialized) {
+        return;
+    }
+    switch (e.type) {
+    case SDL_CONTROLLERDEVICEADDED:
+        open(e.cdevice.which);
+        break;
+    case SDL_CONTROLLERDEVICEREMOVED:
+        if (e.cdevice.which == m_id) {
+            close();
+            // Fall back to another controller that is still connected
+            for (int i = 0; i < SDL_NumJoysticks() && !m_controller; i++) {
+                open(i);
+            }
+        }
+        break;
+    }
+}
+
+/**
+ * Whether the stick is deflected past the threshold in the given direction.
+ * The threshold depends on whether the direction is already held.
+ *
+ * @param direction -1 for left or up, 1 for right or down
+ */
+bool Gamepad::stickPast(SDL_GameControllerAxis axis, int direction,
+                        bool held) const {
+    double value =
+        direction * SDL_GameControllerGetAxis(m_controller, axis) / AXIS_MAX;
+    return value >= (held ? m_settings.stick_release : m_settings.stick_press);
+}
+
+/**
+ * Get the press actions whose buttons are currently held down
+ */
+InputFrame_t Gamepad::readHeld() const {
+    if (!m_controller) {
+        return 0;
+    }
+    auto button = [this](SDL_GameControllerButton b) {
+        return SDL_GameControllerGetButton(m_controller, b) != 0;
+    };
+    auto held = [this](Action action) {
+        return (m_held & actionBit(action)) != 0;
+    };
+    InputFrame_t result = 0;
+    auto set = [&result](Action action, bool pressed) {
+        if (pressed) {
+            result |= actionBit(action);
+        }
+    };
+    set(Action::MoveLeft,
+        button(SDL_CONTROLLER_BUTTON_DPAD_LEFT) ||
+            stickPast(SDL_CONTROLLER_AXIS_LEFTX, -1, held(Action::MoveLeft)));
+    set(Action::MoveRight,
+        button(SDL_CONTROLLER_BUTTON_DPAD_RIGHT) ||
+            stickPast(SDL_CONTROLLER_AXIS_LEFTX, 1, held(Action::MoveRight)));
+    set(Action::SoftDrop,
+        button(SDL_CONTROLLER_BUTTON_DPAD_DOWN) ||
+            stickPast(SDL_CONTROLLER_AXIS_LEFTY, 1, held(Action::SoftDrop)));
+    set(Action::HardDrop, button(SDL_CONTROLLER_BUTTON_DPAD_UP));
+    set(Action::RotateCounterclockw, button(SDL_CONTROLLER_BUTTON_A) ||
+                                         button(SDL_CONTROLLER_BUTTON_Y));
+    set(Action::RotateClockw,
+        button(SDL_CONTROLLER_BUTTON_B) || button(SDL_CONTROLLER_BUTTON_X));
+    set(Action::Hold, button(SDL_CONTROLLER_BUTTON_LEFTSHOULDER) ||
+                          button(SDL_CONTROLLER_BUTTON_RIGHTSHOULDER));
+    return result;
+}
+
+/**
+ * Read the controller and return the actions that occurred since the last
+ * call: presses for buttons that went down, releases for movement and soft
+ * drop buttons that went up. Should be called right before the simulation
+ * advances.
+ */
+InputFrame_t Gamepad::poll() {
+    if (m_controller) {
+        SDL_GameControllerUpdate();
+    }
+    InputFrame_t held = readHeld();
+    InputFrame_t input = held & ~m_held;
+    InputFrame_t released = m_held & ~held;
+    m_held = held;
+    const std::pair<Action, Action> releases[] = {
+        {Action::MoveLeft, Action::MoveLeftRelease},
+        {Action::MoveRight, Action::MoveRightRelease},
+        {Action::SoftDrop, Action::SoftDropRelease},
+    };
+    for (const auto &[press, release] : releases) {
+        if (released & actionBit(press)) {
+            input |= actionBit(release);
+        }
+    }
+    return input;
+}
+
+bool Gamepad::isConnected() const {
+    return m_controller != nullptr;
+}
+
+/**
+ * Whether the event is the start button of the controller in use being
+ * pressed; used for pausing and restarting
+ */
+bool Gamepad::isStartEvent(const SDL_Event &e) const {
+    return m_controller && e.type == SDL_CONTROLLERBUTTONDOWN &&
+           e.cbutton.which == m_id &&
+           e.cbutton.button == SDL_CONTROLLER_BUTTON_START;
+}
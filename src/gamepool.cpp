@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <thread>
+
+#include "sys/mman.h"
+#include "sys/wait.h"
+#include "unistd.h"
+
+#include "bot.h"
+#include "gamepool.h"
+#include "simcore.h"
+
+namespace {
+
+static_assert(std::atomic<int>::is_always_lock_free &&
+                  std::atomic<bool>::is_always_lock_free,
+              "atomics in shared memory must not use locks");
+
+// Layout of the shared memory: the header followed by one slot per game
+struct SharedHeader {
+    // Next game to be taken by a worker
+    std::atomic<int> next;
+    std::atomic<int> finished;
+    int n_games;
+};
+
+struct SharedGame {
+    GameRequest request;
+    std::atomic<bool> done;
+    GameResult result;
+};
+
+/*
+ * Anonymous shared mapping holding the game table; inherited by the workers
+ * when they are forked
+ */
+class SharedTable {
+  private:
+    void *m_memory = MAP_FAILED;
+    size_t m_size = 0;
+
+    static size_t gamesOffset() {
+        return (sizeof(SharedHeader) + alignof(SharedGame) - 1) /
+               alignof(SharedGame) * alignof(SharedGame);
+    }
+
+  public:
+    SharedHeader *header = nullptr;
+    SharedGame *games = nullptr;
+
+    SharedTable(const std::vector<GameRequest> &requests) {
+        m_size = gamesOffset() + requests.size() * sizeof(SharedGame);
+        m_memory = mmap(nullptr, m_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (m_memory == MAP_FAILED) {
+            return;
+        }
+        header = new (m_memory) SharedHeader{{0}, {0}, (int)requests.size()};
+        games = reinterpret_cast<SharedGame *>(static_cast<char *>(m_memory) +
+                                               gamesOffset());
+        for (size_t i = 0; i < requests.size(); i++) {
+            new (&games[i]) SharedGame{requests[i], {false}, {}};
+        }
+    }
+
+    ~SharedTable() {
+        if (m_memory != MAP_FAILED) {
+            munmap(m_memory, m_size);
+        }
+    }
+
+    SharedTable(const SharedTable &) = delete;
+    SharedTable &operator=(const SharedTable &) = delete;
+
+    bool isValid() const {
+        return m_memory != MAP_FAILED;
+    }
+};
+
+/**
+ * Body of a worker process: play games until there are none left
+ */
+void playGames(SharedTable &table, const std::vector<BotConfig> &bots,
+               int max_pieces, int table_size_log2) {
+    // Entries are keyed by the weights too, so the bots can share the table
+    std::unique_ptr<TranspositionTable> transpositions;
+    if (table_size_log2 > 0) {
+        transpositions = std::make_unique<TranspositionTable>(table_size_log2);
+    }
+    // Bots are created on first use and kept for the following games
+    std::vector<std::unique_ptr<Bot<BoardEvaluator>>> instances(bots.size());
+    int i;
+    while ((i = table.header->next.fetch_add(1)) < table.header->n_games) {
+        SharedGame &game = table.games[i];
+        const BotConfig &config = bots[game.request.bot];
+        auto &bot = instances[game.request.bot];
+        if (!bot) {
+            bot = std::make_unique<Bot<BoardEvaluator>>(
+                BoardEvaluator(config.weights), config.depth,
+                transpositions.get());
+        }
+        GuidelineCore core(game.request.seed);
+        bot->play(core, max_pieces);
+        // A bot that finds no placement has topped out as well
+        game.result = {core.getPieces(), core.getScore().lines,
+                       core.getScore().score, core.getPieces() < max_pieces};
+        game.done.store(true, std::memory_order_release);
+        table.header->finished.fetch_add(1);
+    }
+}
+
+} // namespace
+
+Estimate estimate(const std::vector<double> &sample) {
+    Estimate result;
+    if (sample.empty()) {
+        return result;
+    }
+    for (double x : sample) {
+        result.mean += x;
+    }
+    result.mean /= sample.size();
+    if (sample.size() > 1) {
+        double variance = 0;
+        for (double x : sample) {
+            variance += (x - result.mean) * (x - result.mean);
+        }
+        variance /= sample.size() - 1;
+        result.error = 1.96 * std::sqrt(variance / sample.size());
+    }
+    return result;
+}
+
+/**
+ * @param n_workers number of worker processes; 0 uses one per CPU core
+ * @param max_pieces games are stopped after this many Tetrominos
+ * @param table_size_log2 size of the transposition table of each worker, see
+ *                        TranspositionTable; 0 searches without one
+ */
+GamePool::GamePool(int n_workers, int max_pieces, int table_size_log2)
+    : m_n_workers(n_workers > 0
+                      ? n_workers
+                      : std::max(1u, std::thread::hardware_concurrency())),
+      m_max_pieces(max_pieces), m_table_size_log2(table_size_log2) {}
+
+int GamePool::getWorkers() const {
+    return m_n_workers;
+}
+
+/**
+ * Play all games and wait for them to finish
+ *
+ * @param results receives the result of each game, in the order of `games`
+ *
+ * @return false if a worker couldn't be started or died
+ */
+bool GamePool::run(const std::vector<BotConfig> &bots,
+                   const std::vector<GameRequest> &games,
+                   std::vector<GameResult> &results,
+                   const Progress &progress) const {
+    results.clear();
+    if (games.empty()) {
+        return true;
+    }
+    SharedTable table(games);
+    if (!table.isValid()) {
+        std::cerr << "ERROR: Couldn't map shared memory for " << games.size()
+                  << " games\n";
+        return false;
+    }
+
+    std::cout.flush();
+    std::cerr.flush();
+    std::vector<pid_t> workers;
+    int n_workers = std::min<int>(m_n_workers, games.size());
+    bool success = true;
+    for (int i = 0; i < n_workers; i++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            playGames(table, bots, m_max_pieces, m_table_size_log2);
+            _exit(0);
+        } else if (pid < 0) {
+            std::cerr << "ERROR: Couldn't start worker process\n";
+            success = false;
+            break;
+        }
+        workers.push_back(pid);
+    }
+
+    // Wait for all workers, reporting progress while they play
+    int reported = -1;
+    while (!workers.empty()) {
+        for (auto it = workers.begin(); it != workers.end();) {
+            int status;
+            pid_t pid = waitpid(*it, &status, WNOHANG);
+            if (pid == 0) {
+                it++;
+                continue;
+            }
+            if (pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                success = false;
+            }
+            it = workers.erase(it);
+        }
+        int finished = table.header->finished.load();
+        if (progress && finished != reported) {
+            progress(finished, table.header->n_games);
+            reported = finished;
+        }
+        if (!workers.empty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+
+    for (size_t i = 0; i < games.size(); i++) {
+        if (!table.games[i].done.load(std::memory_order_acquire)) {
+            success = false;
+            results.push_back({});
+        } else {
+            results.push_back(table.games[i].result);
+        }
+    }
+    return success;
+}
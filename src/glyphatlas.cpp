@@ -0,0 +1,115 @@
+#include <algorithm>
+
+#include "glyphatlas.h"
+
+GlyphAtlas::~GlyphAtlas() {
+    if (m_texture) {
+        SDL_DestroyTexture(m_texture);
+    }
+}
+
+/**
+ * Index of a character in the atlas; characters outside of it are drawn as
+ * '?'
+ */
+int GlyphAtlas::index(char c) const {
+    if (c < GLYPH_ATLAS_FIRST || c > GLYPH_ATLAS_LAST) {
+        c = '?';
+    }
+    return c - GLYPH_ATLAS_FIRST;
+}
+
+/**
+ * Render all glyphs into the atlas using the `Shaded` text rendering mode
+ *
+ * @return whether all glyphs could be rendered
+ */
+bool GlyphAtlas::build(SDL_Renderer *renderer, TTF_Font *font,
+                       const SDL_Color &text_color,
+                       const SDL_Color &background) {
+    std::array<SDL_Surface *, GLYPH_ATLAS_SIZE> surfaces{};
+    int width = 0;
+    m_height = 0;
+    bool success = true;
+    for (int i = 0; i < GLYPH_ATLAS_SIZE && success; i++) {
+        uint16_t c = GLYPH_ATLAS_FIRST + i;
+        int min_x, max_x, min_y, max_y;
+        surfaces[i] = TTF_RenderGlyph_Shaded(font, c, text_color, background);
+        success = surfaces[i] && TTF_GlyphMetrics(font, c, &min_x, &max_x,
+                                                  &min_y, &max_y,
+                                                  &m_advances[i]) == 0;
+        if (success) {
+            m_glyphs[i] = {width, 0, surfaces[i]->w, surfaces[i]->h};
+            width += surfaces[i]->w;
+            m_height = std::max(m_height, surfaces[i]->h);
+        }
+    }
+
+    SDL_Surface *atlas = nullptr;
+    if (success) {
+        atlas = SDL_CreateRGBSurfaceWithFormat(0, width, m_height, 32,
+                                               SDL_PIXELFORMAT_RGBA8888);
+        success = atlas != nullptr;
+    }
+    for (int i = 0; i < GLYPH_ATLAS_SIZE; i++) {
+        if (success) {
+            SDL_BlitSurface(surfaces[i], nullptr, atlas, &m_glyphs[i]);
+        }
+        SDL_FreeSurface(surfaces[i]);
+    }
+    if (success) {
+        m_texture = SDL_CreateTextureFromSurface(renderer, atlas);
+        success = m_texture != nullptr;
+    }
+    SDL_FreeSurface(atlas);
+    m_background = background;
+    return success;
+}
+
+bool GlyphAtlas::isBuilt() const {
+    return m_texture != nullptr;
+}
+
+/**
+ * Width of a string in pixels
+ */
+int GlyphAtlas::measure(const char *text) const {
+    int x = 0, width = 0;
+    for (const char *c = text; *c; c++) {
+        width = std::max(width, x + m_glyphs[index(*c)].w);
+        x += m_advances[index(*c)];
+    }
+    return width;
+}
+
+/**
+ * Put together a texture containing `text`, like TTF_RenderText_Shaded
+ * followed by SDL_CreateTextureFromSurface would
+ *
+ * @param width, height receive the size of the texture
+ */
+SDL_Texture *GlyphAtlas::renderText(SDL_Renderer *renderer, const char *text,
+                                    int &width, int &height) const {
+    width = std::max(1, measure(text));
+    height = m_height;
+    SDL_Texture *texture =
+        SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+                          SDL_TEXTUREACCESS_TARGET, width, height);
+    if (!texture) {
+        return nullptr;
+    }
+    SDL_Texture *previous_target = SDL_GetRenderTarget(renderer);
+    SDL_SetRenderTarget(renderer, texture);
+    SDL_SetRenderDrawColor(renderer, m_background.r, m_background.g,
+                           m_background.b, m_background.a);
+    SDL_RenderClear(renderer);
+    int x = 0;
+    for (const char *c = text; *c; c++) {
+        const SDL_Rect &glyph = m_glyphs[index(*c)];
+        SDL_Rect dest{x, 0, glyph.w, glyph.h};
+        SDL_RenderCopy(renderer, m_texture, &glyph, &dest);
+        x += m_advances[index(*c)];
+    }
+    SDL_SetRenderTarget(renderer, previous_target);
+    return texture;
+}
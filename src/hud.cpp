@@ -1,25 +1,26 @@
-#include <filesystem>
+#include <cstdio>
 #include <iostream>
 #include <string>
 
+#include "assets.h"
 #include "constants.h"
 #include "hud.h"
 
-HUD::HUD(const std::string &assets_path, const ScoringSystem &p_scoring)
-    : m_scoring(p_scoring) {
+HUD::HUD(const ScoringSystem &p_scoring) : m_scoring(p_scoring) {
     TTF_Init();
-    std::string font_path = assets_path + FONT_PATH_RELATIVE;
-    m_font = TTF_OpenFont(font_path.c_str(), FONT_SIZE);
+    // The font is compiled into the executable
+    m_font = TTF_OpenFontRW(SDL_RWFromConstMem(FONT_DATA, FONT_DATA_SIZE), 1,
+                            FONT_SIZE);
     if (!m_font) {
-        std::cout << "ERROR: Failed to load font from " << font_path << "\n";
+        std::cout << "ERROR: Failed to load font: " << TTF_GetError() << "\n";
         exit(1);
     }
     reset();
 }
 
-HUD::HUD(const std::string &assets_path, const ScoringSystem &scoring,
+HUD::HUD(const ScoringSystem &scoring,
          const std::array<TetrominoKind_t, QUEUE_LEN> &queue)
-    : HUD(assets_path, scoring) {
+    : HUD(scoring) {
     setQueue(queue);
 }
 
@@ -29,6 +30,9 @@ HUD::~HUD() {
     SDL_DestroyTexture(m_level_texture);
     SDL_DestroyTexture(m_goal_texture);
     SDL_DestroyTexture(m_lines_texture);
+    for (SDL_Texture *texture : m_stats_textures) {
+        SDL_DestroyTexture(texture);
+    }
     m_font = NULL;
 }
 
@@ -38,6 +42,7 @@ void HUD::reset() {
     m_last_goal = -1;
     m_last_lines = -1;
     m_last_score = -1;
+    m_last_stats = {};
     setHold(-1);
 }
 
@@ -51,6 +56,24 @@ void HUD::setHold(TetrominoKind_t held) {
     m_hold_visual.setKind(held);
 }
 
+void HUD::setStats(const LiveStats *stats) {
+    m_stats = stats;
+}
+
+/**
+ * Render the glyphs of the font into an atlas, which shaded text is drawn
+ * from afterwards (if built with GLYPH_ATLAS). Rendering all glyphs takes
+ * longer than a frame's text, so main calls this after the first frame.
+ */
+void HUD::buildGlyphAtlas(SDL_Renderer *renderer) {
+#ifdef GLYPH_ATLAS
+    if (!m_atlas.isBuilt() &&
+        !m_atlas.build(renderer, m_font, TEXT_COLOR, BACKGROUND)) {
+        std::cout << "WARNING: Couldn't build glyph atlas\n";
+    }
+#endif
+}
+
 void HUD::draw(SDL_Renderer *renderer, GameState state) {
     // Draw queue
     for (int i = 0; i < QUEUE_LEN; i++) {
@@ -173,11 +196,43 @@ void HUD::renderLines(SDL_Renderer *renderer) {
                &m_lines_texture, &m_lines_rect, TEXT_COLOR);
 }
 
+/**
+ * Re-render the Surfaces containing the live statistics if needed. Rates are
+ * shown over the last few seconds of play, so that they follow the player's
+ * current pace.
+ */
+void HUD::renderStats(SDL_Renderer *renderer) {
+    if (!m_stats) {
+        return;
+    }
+    StatsRates rates = m_stats->getWindowRates();
+    int pieces = m_stats->getPieces();
+    std::array<char[32], N_STATS_LINES> text;
+    snprintf(text[0], sizeof(text[0]), "PPS: %.2f", rates.pps);
+    snprintf(text[1], sizeof(text[1]), "APM: %.1f", rates.apm);
+    snprintf(text[2], sizeof(text[2]), "KPP: %.2f", rates.kpp);
+    snprintf(text[3], sizeof(text[3]), "Finesse: %d%%",
+             pieces > 0
+                 ? 100 * (pieces - m_stats->getFinesseFaults()) / pieces
+                 : 100);
+    for (int i = 0; i < N_STATS_LINES; i++) {
+        if (m_last_stats[i] == text[i]) {
+            continue;
+        }
+        m_last_stats[i] = text[i];
+        SDL_DestroyTexture(m_stats_textures[i]);
+        renderText(renderer, STATS_TEXT_X, STATS_TEXT_Y + i * LINE_OFFSET,
+                   text[i], m_font, &m_stats_textures[i], &m_stats_rects[i],
+                   TEXT_COLOR);
+    }
+}
+
 void HUD::renderAllInfo(SDL_Renderer *renderer) {
     renderLevel(renderer);
     renderGoal(renderer);
     renderScore(renderer);
     renderLines(renderer);
+    renderStats(renderer);
 }
 
 /**
@@ -219,6 +274,15 @@ void HUD::renderText(SDL_Renderer *renderer, int x, int y, const char *text,
 void HUD::renderText(SDL_Renderer *renderer, int x, int y, const char *text,
                      TTF_Font *font, SDL_Texture **texture, SDL_Rect *rect,
                      const SDL_Color &text_color, const TextRenderMode mode) {
+#ifdef GLYPH_ATLAS
+    // All shaded text uses the colors the atlas was built with
+    if (mode == TextRenderMode::SHADED && m_atlas.isBuilt()) {
+        *texture = m_atlas.renderText(renderer, text, rect->w, rect->h);
+        rect->x = x;
+        rect->y = y;
+        return;
+    }
+#endif
     SDL_Surface *surface;
     switch (mode) {
     case TextRenderMode::SHADED:
@@ -249,4 +313,10 @@ void HUD::drawAllInfo(SDL_Renderer *renderer) {
     SDL_RenderCopy(renderer, m_goal_texture, 0, &m_goal_rect);
     SDL_RenderCopy(renderer, m_score_texture, 0, &m_score_rect);
     SDL_RenderCopy(renderer, m_lines_texture, 0, &m_lines_rect);
+    if (m_stats) {
+        for (int i = 0; i < N_STATS_LINES; i++) {
+            SDL_RenderCopy(renderer, m_stats_textures[i], 0,
+                           &m_stats_rects[i]);
+        }
+    }
 }
@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include "poll.h"
+#include "sys/socket.h"
+#include "sys/un.h"
+#include "unistd.h"
+
+#include "injection.h"
+
+// How long the socket thread waits for a message before checking whether it
+// should stop
+static const int ACTION_SOCKET_POLL_MS = 100;
+// Largest datagram accepted; enough for 255 actions
+static const size_t ACTION_SOCKET_MAX_MESSAGE = 4096;
+
+/**
+ * Queue an action to be applied at `time`. May be called from any thread.
+ *
+ * @return false if too many actions are waiting and this one was dropped
+ */
+bool ActionInjector::inject(Action action, cl::time_point time) {
+    return m_queue.push({time, action});
+}
+
+/**
+ * Move the actions due by `now` to `due`, in the order of their times.
+ * Actions with the same time keep the order they were injected in. Only to be
+ * called by the game thread.
+ */
+void ActionInjector::takeDue(cl::time_point now,
+                             std::vector<InjectedAction> &due) {
+    due.clear();
+    InjectedAction injected;
+    while (m_queue.pop(injected)) {
+        m_scheduled.push_back(injected);
+    }
+    if (m_scheduled.empty()) {
+        return;
+    }
+    std::stable_sort(m_scheduled.begin(), m_scheduled.end(),
+                     [](const InjectedAction &a, const InjectedAction &b) {
+                         return a.time < b.time;
+                     });
+    auto end = std::find_if(
+        m_scheduled.begin(), m_scheduled.end(),
+        [now](const InjectedAction &a) { return a.time > now; });
+    due.assign(m_scheduled.begin(), end);
+    m_scheduled.erase(m_scheduled.begin(), end);
+}
+
+/**
+ * Create the socket at `path`, replacing a stale one, and start reading
+ * messages
+ *
+ * @throws std::runtime_error if the socket can't be created
+ */
+ActionSocket::ActionSocket(const std::string &path, ActionInjector &injector)
+    : m_path(path), m_injector(injector) {
+    sockaddr_un addr{};
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Invalid socket path: " + path);
+    }
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, path.c_str());
+    m_fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (m_fd < 0) {
+        throw std::runtime_error("Couldn't create socket");
+    }
+    // Remove stale socket left over by a previous run
+    unlink(path.c_str());
+    if (bind(m_fd, (sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(m_fd);
+        throw std::runtime_error("Couldn't bind to " + path);
+    }
+    m_thread = std::thread(&ActionSocket::run, this);
+}
+
+ActionSocket::~ActionSocket() {
+    m_stop = true;
+    m_thread.join();
+    close(m_fd);
+    unlink(m_path.c_str());
+}
+
+void ActionSocket::run() {
+    char buffer[ACTION_SOCKET_MAX_MESSAGE];
+    pollfd fd{m_fd, POLLIN, 0};
+    while (!m_stop) {
+        if (poll(&fd, 1, ACTION_SOCKET_POLL_MS) <= 0) {
+            continue;
+        }
+        ssize_t len = recv(m_fd, buffer, sizeof(buffer), 0);
+        if (len > 0) {
+            handleMessage(buffer, len);
+        }
+    }
+}
+
+void ActionSocket::handleMessage(const char *data, size_t len) {
+    ActionMessageHeader header;
+    if (len < sizeof(header)) {
+        std::cerr << "WARNING: Ignoring truncated action message" << std::endl;
+        return;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != ACTION_SOCKET_MAGIC ||
+        len != sizeof(header) + header.n_actions * sizeof(ActionMessage)) {
+        std::cerr << "WARNING: Ignoring malformed action message" << std::endl;
+        return;
+    }
+    for (uint32_t i = 0; i < header.n_actions; i++) {
+        ActionMessage message;
+        std::memcpy(&message, data + sizeof(header) + i * sizeof(message),
+                    sizeof(message));
+        if (message.action >= N_ACTIONS) {
+            std::cerr << "WARNING: Ignoring unknown action "
+                      << (int)message.action << std::endl;
+            continue;
+        }
+        cl::time_point time{std::chrono::duration_cast<cl::duration>(
+            std::chrono::nanoseconds(message.time_ns))};
+        if (!m_injector.inject(static_cast<Action>(message.action), time)) {
+            std::cerr << "WARNING: Too many injected actions, dropping one"
+                      << std::endl;
+        }
+    }
+}
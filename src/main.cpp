@@ -1,40 +1,390 @@
 #include <chrono>
+#include <cstring>
+#include <ctime>
 #include <filesystem>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <random>
 
 #include "SDL.h"
 
+#include "config.h"
 #include "constants.h"
-#include "file.h"
 #include "game.h"
+#include "injection.h"
+#include "net.h"
+#include "replay.h"
+#include "sessionlog.h"
+#include "stateexport.h"
+#include "statestream.h"
+#include "vsgame.h"
+
+struct Options {
+    bool versus = false;
+    bool host = false;
+    std::string bind_address;
+    std::string peer_address;
+    uint32_t seed = std::random_device{}();
+    bool seed_given = false;
+    int input_delay = VERSUS_DEFAULT_INPUT_DELAY;
+    bool pc_hint = false;
+    std::string stats_path;
+    std::string session_log_path;
+    int top = 0;
+    std::string config_path;
+    std::string state_export_name;
+    std::string action_socket_path;
+    std::string stream_destination;
+    std::string replay_dir;
+    bool dump_desync = false;
+    std::vector<std::string> verify_paths;
+    int jobs = 0;
+};
+
+void printUsage(const char *program_name) {
+    std::cout
+        << "Usage: " << program_name << " [options]\n"
+        << "\n"
+        << "  --config PATH       load settings from PATH\n"
+        << "                      (default: ~/.config/tetris/tetris.cfg)\n"
+        << "  --pc-hint           show where to place the next Tetromino when\n"
+        << "                      a perfect clear is possible\n"
+        << "  --stats PATH        append the statistics of each game to PATH\n"
+        << "                      as a line of JSON\n"
+        << "  --session-log PATH  record the result of each game in PATH\n"
+        << "                      (default: ~/.local/share/tetris/)\n"
+        << "  --top N             print the N best games from the session log\n"
+        << "                      (only those with the given --seed) and exit\n"
+        << "  --export-state NAME publish the state of the game in the shared\n"
+        << "                      memory segment NAME, e.g. "
+        << STATE_EXPORT_DEFAULT_NAME << "\n"
+        << "  --action-socket PATH\n"
+        << "                      accept actions from other processes on the\n"
+        << "                      Unix datagram socket PATH\n"
+        << "  --stream DEST       stream the changes of the game's state to\n"
+        << "                      the file DEST, or to a viewer's socket if\n"
+        << "                      DEST is 'unix:PATH'\n"
+        << "  --replays DIR       save the replay of each game in DIR\n"
+        << "                      (default: replays next to the session log)\n"
+        << "\n"
+        << "Replay verification:\n"
+        << "  --verify FILE...    play replays back as fast as possible,\n"
+        << "                      check that they end with the recorded\n"
+        << "                      score and lines and exit, without\n"
+        << "                      opening a window\n"
+        << "  --jobs N            threads for --verify (default: one per\n"
+        << "                      core)\n"
+        << "\n"
+        << "Versus mode:\n"
+        << "  --versus            play against another instance\n"
+        << "  --bind ADDRESS      local address, 'unix:PATH' or 'IP:PORT'\n"
+        << "  --peer ADDRESS      address of the other instance\n"
+        << "  --host              start the match and choose the seed\n"
+        << "  --seed N            seed for the Tetromino sequence (host)\n"
+        << "  --input-delay N     delay local inputs by N ticks (default "
+        << VERSUS_DEFAULT_INPUT_DELAY << ")\n"
+        << "  --dump-desync       print the state of both players when the\n"
+        << "                      instances' games diverge (or, with\n"
+        << "                      --verify, of replays that diverge)\n";
+}
+
+bool parseOptions(int argc, char *argv[], Options &options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--versus") {
+            options.versus = true;
+        } else if (arg == "--host") {
+            options.host = true;
+        } else if (arg == "--bind" && has_value) {
+            options.bind_address = argv[++i];
+        } else if (arg == "--peer" && has_value) {
+            options.peer_address = argv[++i];
+        } else if (arg == "--seed" && has_value) {
+            options.seed = std::stoul(argv[++i]);
+            options.seed_given = true;
+        } else if (arg == "--input-delay" && has_value) {
+            options.input_delay = std::stoi(argv[++i]);
+        } else if (arg == "--config" && has_value) {
+            options.config_path = argv[++i];
+        } else if (arg == "--pc-hint") {
+            options.pc_hint = true;
+        } else if (arg == "--stats" && has_value) {
+            options.stats_path = argv[++i];
+        } else if (arg == "--session-log" && has_value) {
+            options.session_log_path = argv[++i];
+        } else if (arg == "--top" && has_value) {
+            options.top = std::stoi(argv[++i]);
+        } else if (arg == "--export-state" && has_value) {
+            options.state_export_name = argv[++i];
+        } else if (arg == "--action-socket" && has_value) {
+            options.action_socket_path = argv[++i];
+        } else if (arg == "--stream" && has_value) {
+            options.stream_destination = argv[++i];
+        } else if (arg == "--replays" && has_value) {
+            options.replay_dir = argv[++i];
+        } else if (arg == "--dump-desync") {
+            options.dump_desync = true;
+        } else if (arg == "--verify" && has_value) {
+            while (i + 1 < argc && argv[i + 1][0] != '-') {
+                options.verify_paths.push_back(argv[++i]);
+            }
+        } else if (arg == "--jobs" && has_value) {
+            options.jobs = std::stoi(argv[++i]);
+        } else {
+            return false;
+        }
+    }
+    if (options.versus &&
+        (options.bind_address.empty() || options.peer_address.empty() ||
+         !options.state_export_name.empty() ||
+         !options.action_socket_path.empty() ||
+         !options.stream_destination.empty())) {
+        return false;
+    }
+    if (options.jobs < 0) {
+        return false;
+    }
+    if (options.input_delay < 0 ||
+        options.input_delay >= VERSUS_INPUT_HISTORY - VERSUS_MAX_ROLLBACK -
+                                   VERSUS_MAX_PACKET_INPUTS) {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Default location of the session log; its directory is created if needed
+ */
+std::string defaultSessionLogPath() {
+    const char *home = std::getenv("HOME");
+    if (home == NULL) {
+        return "sessions.log";
+    }
+    std::filesystem::path dir =
+        std::filesystem::path(home) / ".local/share/tetris";
+    std::error_code error;
+    std::filesystem::create_directories(dir, error);
+    return dir / "sessions.log";
+}
+
+/**
+ * Load the settings from the given config file or, if there is none, from the
+ * default location if it exists
+ */
+bool loadConfigFile(const std::string &path, Config &config) {
+    std::string config_path = path;
+    if (path.empty()) {
+        const char *home = std::getenv("HOME");
+        if (home == NULL) {
+            return true;
+        }
+        config_path = std::string(home) + "/.config/tetris/tetris.cfg";
+    }
+    try {
+        if (!loadConfig(config_path, config) && !path.empty()) {
+            std::cerr << "ERROR: Couldn't open " << config_path << std::endl;
+            return false;
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Print the best games recorded in the session log
+ */
+int printTop(SessionLog &log, const Options &options) {
+    std::vector<SessionRecord> records;
+    if (options.seed_given) {
+        log.topForSeed(options.seed, options.top, records);
+    } else {
+        log.top(options.top, records);
+    }
+    for (const SessionRecord &record : records) {
+        std::time_t end_time = record.end_time / 1000;
+        char date[32];
+        std::strftime(date, sizeof(date), "%Y-%m-%d %H:%M",
+                      std::localtime(&end_time));
+        std::cout << date << "  score " << record.score << "  lines "
+                  << record.lines << "  level " << record.level << "  "
+                  << record.duration_ms / 1000 << "s  seed " << record.seed
+                  << "\n";
+    }
+    return 0;
+}
+
+/**
+ * Play replays back and check that they still end with the recorded score
+ * and lines, e.g. after the rules changed. Only replays that don't are
+ * listed, followed by a summary.
+ *
+ * @return 0 if all of them do and none diverged
+ */
+int verifyReplayFiles(const Options &options) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<ReplayCheck> checks;
+    verifyReplays(options.verify_paths, options.jobs, options.dump_desync,
+                  checks);
+    double seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+
+    int n_same = 0, n_different = 0, n_failed = 0, n_diverged = 0;
+    int64_t game_ms = 0;
+    for (const ReplayCheck &check : checks) {
+        if (!check.error.empty()) {
+            std::cerr << "ERROR: " << check.error << std::endl;
+            n_failed++;
+            continue;
+        }
+        const ReplayResult &result = check.result;
+        game_ms += result.duration_ms;
+        bool same = result.score == result.replayed_score &&
+                    result.lines == result.replayed_lines;
+        n_same += same;
+        n_different += !same;
+        n_diverged += result.desync_tick >= 0;
+        if (same && result.desync_tick < 0) {
+            continue;
+        }
+        std::cout << check.path << ": score " << result.score << " -> "
+                  << result.replayed_score << ", lines " << result.lines
+                  << " -> " << result.replayed_lines;
+        if (result.desync_tick >= 0) {
+            std::cout << ", diverged in tick " << result.desync_tick
+                      << " (last matching tick " << result.last_good_tick
+                      << ")";
+        }
+        std::cout << "\n" << check.dump;
+    }
+    std::cout << checks.size() << " replays: " << n_same
+              << " with the recorded score and lines, " << n_different
+              << " with different ones, " << n_failed << " unreadable; "
+              << n_diverged << " diverged\n"
+              << game_ms / 60000 << " minutes of play in " << std::fixed
+              << std::setprecision(3) << seconds << " s\n";
+    return n_different || n_failed || n_diverged ? 1 : 0;
+}
 
 int main(int argc, char *argv[]) {
+    Options options;
+    try {
+        if (!parseOptions(argc, argv, options)) {
+            printUsage(argv[0]);
+            return 1;
+        }
+    } catch (const std::exception &) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    // Verifying needs neither a window nor a font nor the settings
+    if (!options.verify_paths.empty()) {
+        return verifyReplayFiles(options);
+    }
+
+    Config config;
+    if (!loadConfigFile(options.config_path, config)) {
+        return 1;
+    }
+    if (options.session_log_path.empty()) {
+        options.session_log_path = defaultSessionLogPath();
+    }
+    if (options.replay_dir.empty()) {
+        options.replay_dir =
+            std::filesystem::path(options.session_log_path).parent_path() /
+            "replays";
+    }
+    std::unique_ptr<SessionLog> session_log;
+    try {
+        session_log = std::make_unique<SessionLog>(options.session_log_path);
+    } catch (const std::exception &e) {
+        std::cerr << "WARNING: " << e.what() << std::endl;
+    }
+    if (options.top > 0) {
+        return session_log ? printTop(*session_log, options) : 1;
+    }
+
     // Initialize SDL and create window
-    if (SDL_Init(SDL_INIT_EVERYTHING) != 0) {
+    // Only video (which includes events) is needed to show the first frame;
+    // other subsystems are initialized by whatever needs them
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
         printf("error initializing SDL: %s\n", SDL_GetError());
     }
-    SDL_Window *window =
-        SDL_CreateWindow("Tetris", SDL_WINDOWPOS_CENTERED,
-                         SDL_WINDOWPOS_CENTERED, WINDOW_X, WINDOW_Y, 0);
+    SDL_Window *window = SDL_CreateWindow(
+        "Tetris", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+        options.versus ? VERSUS_WINDOW_X : WINDOW_X, WINDOW_Y, 0);
     SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, 0);
 
 #ifdef RELEASE
     std::cout << "Release mode\n";
-    const char *home = std::getenv("HOME");
-    if (home == NULL) {
-        std::cerr << "ERROR: HOME variable not set." << std::endl;
-    }
-    std::string assets_path = std::string(home) + "/.fonts";
 #else
     std::cout << "Debug mode\n";
-    std::string program_name = absolute_path_to_exec(std::string{argv[0]});
-    std::string assets_path =
-        std::filesystem::weakly_canonical(program_name + "/../../assets/");
 #endif
-    Game game(assets_path);
+    std::unique_ptr<StateExport> state_export;
+    if (!options.state_export_name.empty()) {
+        try {
+            state_export =
+                std::make_unique<StateExport>(options.state_export_name);
+        } catch (const std::exception &e) {
+            std::cerr << "ERROR: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    std::unique_ptr<StateStreamWriter> state_stream;
+    if (!options.stream_destination.empty()) {
+        try {
+            state_stream =
+                std::make_unique<StateStreamWriter>(options.stream_destination);
+        } catch (const std::exception &e) {
+            std::cerr << "ERROR: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    std::unique_ptr<Game> game;
+    std::unique_ptr<Connection> conn;
+    std::unique_ptr<VersusGame> versus;
+    if (options.versus) {
+        try {
+            conn = std::make_unique<Connection>(options.bind_address,
+                                                options.peer_address);
+        } catch (const std::exception &e) {
+            std::cerr << "ERROR: " << e.what() << std::endl;
+            return 1;
+        }
+        versus = std::make_unique<VersusGame>(*conn, options.host, options.seed,
+                                              options.input_delay);
+        // Both players have to simulate with the same handling, so only the
+        // controller settings apply
+        versus->setGamepadSettings(config.gamepad);
+        versus->setDumpDesync(options.dump_desync);
+    } else {
+        std::error_code error;
+        std::filesystem::create_directories(options.replay_dir, error);
+        game = std::make_unique<Game>(options.pc_hint, options.stats_path,
+                                      session_log.get(), state_export.get(),
+                                      state_stream.get(), options.replay_dir);
+        game->configure(config);
+        game->init();
+    }
+    // Declared after the game so that it stops injecting before the game is
+    // destroyed
+    std::unique_ptr<ActionSocket> action_socket;
+    if (!options.action_socket_path.empty()) {
+        try {
+            action_socket = std::make_unique<ActionSocket>(
+                options.action_socket_path, game->getInjector());
+        } catch (const std::exception &e) {
+            std::cerr << "ERROR: " << e.what() << std::endl;
+            return 1;
+        }
+    }
 
     bool is_running = true;
-    game.init();
+    bool loaded = false;
     while (is_running) {
         SDL_Event e;
         while (SDL_PollEvent(&e) != 0) {
@@ -43,21 +393,49 @@ int main(int argc, char *argv[]) {
                 is_running = false;
                 break;
             default:
-                game.handleEvent(e);
+                if (versus) {
+                    versus->handleEvent(e);
+                } else {
+                    game->handleEvent(e);
+                }
             }
         }
 
-        game.update();
+        if (versus) {
+            versus->update();
+        } else {
+            game->update();
+        }
 
         SDL_SetRenderDrawColor(renderer, BACKGROUND.r, BACKGROUND.g,
                                BACKGROUND.b, BACKGROUND.a);
         SDL_RenderClear(renderer);
-        game.draw(renderer);
+        if (versus) {
+            versus->draw(renderer);
+        } else {
+            game->draw(renderer);
+        }
         SDL_RenderPresent(renderer);
+
+        // Opening devices and building the glyph atlas take a while, so the
+        // window shows up first
+        if (!loaded) {
+            loaded = true;
+            if (versus) {
+                versus->finishLoading(renderer);
+            } else {
+                game->finishLoading(renderer);
+            }
+        }
     }
 
-    SDL_DestroyWindow(window);
+    // The game's controller, audio device and textures belong to SDL, so
+    // they have to go before it shuts down
+    action_socket.reset();
+    game.reset();
+    versus.reset();
     SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
     SDL_Quit();
 
     return 0;
@@ -0,0 +1,46 @@
+#include "minobatch.h"
+
+/**
+ * Add a Mino with its top left corner at the given pixel position. Cells are
+ * drawn one pixel smaller than `size`, leaving the background between them
+ * as a grid.
+ */
+void MinoBatch::addMino(int x, int y, int size, uint8_t mino_type) {
+    if (mino_type < m_minos.size() && mino_type != EMPTY_MINO) {
+        m_minos[mino_type].push_back({x + 1, y + 1, size - 1, size - 1});
+    }
+}
+
+void MinoBatch::addOutline(const SDL_Rect &rect) {
+    m_outlines.push_back(rect);
+}
+
+/**
+ * Draw everything added since the last call, then empty the batch
+ */
+void MinoBatch::draw(SDL_Renderer *renderer) {
+    for (size_t type = 0; type < m_minos.size(); type++) {
+        if (m_minos[type].empty()) {
+            continue;
+        }
+        const SDL_Color &color =
+            type == GARBAGE_MINO ? GARBAGE_COLOR : TETROMINO_COLORS[type];
+        SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, 255);
+        SDL_RenderFillRects(renderer, m_minos[type].data(),
+                            (int)m_minos[type].size());
+    }
+    if (!m_outlines.empty()) {
+        SDL_SetRenderDrawColor(renderer, GRID_COLOR.r, GRID_COLOR.g,
+                               GRID_COLOR.b, 255);
+        SDL_RenderDrawRects(renderer, m_outlines.data(),
+                            (int)m_outlines.size());
+    }
+    clear();
+}
+
+void MinoBatch::clear() {
+    for (std::vector<SDL_Rect> &minos : m_minos) {
+        minos.clear();
+    }
+    m_outlines.clear();
+}
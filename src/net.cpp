@@ -0,0 +1,107 @@
+#include <cstring>
+#include <stdexcept>
+
+#include "arpa/inet.h"
+#include "fcntl.h"
+#include "netinet/in.h"
+#include "sys/un.h"
+#include "unistd.h"
+
+#include "net.h"
+
+/**
+ * Parse an address of the form "unix:<path>" or "<ipv4>:<port>"
+ *
+ * @return whether the address could be parsed
+ */
+bool parseAddress(const std::string &address, sockaddr_storage &result,
+                  socklen_t &len) {
+    std::memset(&result, 0, sizeof(result));
+    if (address.rfind("unix:", 0) == 0) {
+        std::string path = address.substr(5);
+        sockaddr_un *addr = (sockaddr_un *)&result;
+        if (path.empty() || path.size() >= sizeof(addr->sun_path)) {
+            return false;
+        }
+        addr->sun_family = AF_UNIX;
+        std::strcpy(addr->sun_path, path.c_str());
+        len = sizeof(sockaddr_un);
+        return true;
+    }
+    size_t colon = address.rfind(':');
+    if (colon == std::string::npos) {
+        return false;
+    }
+    std::string host = address.substr(0, colon);
+    int port = std::atoi(address.substr(colon + 1).c_str());
+    sockaddr_in *addr = (sockaddr_in *)&result;
+    addr->sin_family = AF_INET;
+    addr->sin_port = htons(port);
+    if (port <= 0 || port > 65535 ||
+        inet_pton(AF_INET, host.c_str(), &addr->sin_addr) != 1) {
+        return false;
+    }
+    len = sizeof(sockaddr_in);
+    return true;
+}
+
+Connection::Connection(const std::string &bind_address,
+                       const std::string &peer_address) {
+    sockaddr_storage local;
+    socklen_t local_len;
+    if (!parseAddress(bind_address, local, local_len)) {
+        throw std::invalid_argument("Invalid address: " + bind_address);
+    }
+    if (!parseAddress(peer_address, m_peer, m_peer_len)) {
+        throw std::invalid_argument("Invalid address: " + peer_address);
+    }
+    if (local.ss_family != m_peer.ss_family) {
+        throw std::invalid_argument("Address families don't match");
+    }
+    m_fd = socket(local.ss_family, SOCK_DGRAM, 0);
+    if (m_fd < 0) {
+        throw std::runtime_error("Couldn't create socket");
+    }
+    if (local.ss_family == AF_UNIX) {
+        m_unix_path = ((sockaddr_un *)&local)->sun_path;
+        // Remove stale socket left over by a previous run
+        unlink(m_unix_path.c_str());
+    }
+    if (bind(m_fd, (sockaddr *)&local, local_len) != 0) {
+        close(m_fd);
+        throw std::runtime_error("Couldn't bind to " + bind_address);
+    }
+    fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL) | O_NONBLOCK);
+}
+
+Connection::~Connection() {
+    close(m_fd);
+    if (!m_unix_path.empty()) {
+        unlink(m_unix_path.c_str());
+    }
+}
+
+/**
+ * Send a datagram to the peer. Never blocks; if the datagram can't be sent
+ * right away it is dropped.
+ *
+ * @return whether the datagram was sent
+ */
+bool Connection::send(const void *data, size_t len) {
+    return sendto(m_fd, data, len, 0, (sockaddr *)&m_peer, m_peer_len) ==
+           (ssize_t)len;
+}
+
+/**
+ * Receive a single datagram if one is available. Never blocks.
+ *
+ * @return the size of the datagram, or -1 if there was none
+ */
+int Connection::receive(void *data, size_t max_len) {
+    ssize_t len = recv(m_fd, data, max_len, 0);
+    return len < 0 ? -1 : (int)len;
+}
+
+int Connection::getFd() const {
+    return m_fd;
+}
@@ -0,0 +1,457 @@
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdlib>
+#include <thread>
+
+#include "pcsolver.h"
+#include "zobrist.h"
+
+namespace {
+
+// Columns 0, 2, 4, ... of a row
+const BitRow_t EVEN_COLUMNS = 0x5555 & FULL_ROW;
+const BitRow_t ODD_COLUMNS = 0xaaaa & FULL_ROW;
+
+/**
+ * How far a Tetromino of the given kind can shift the difference between
+ * empty cells in even and odd columns. O, S and Z always cover two of each,
+ * T, L and J can cover three and one, a vertical I covers four of one.
+ */
+int parityCapacity(TetrominoKind_t kind) {
+    switch (kind) {
+    case 0: // I
+        return 4;
+    case 1: // J
+    case 2: // L
+    case 5: // T
+        return 2;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * Row of the topmost Mino of a Tetromino placed at `y`
+ */
+int topRow(TetrominoKind_t kind, uint8_t orientation, int y) {
+    const PieceRows_t &rows = getPieceRows(kind, orientation);
+    int top = 0;
+    while (top < 3 && !rows[top]) {
+        top++;
+    }
+    return y + top;
+}
+
+} // namespace
+
+/*
+ * Per-thread search state, reused for all placements of the first Tetromino
+ * the thread works on
+ */
+struct PerfectClearSolver::Worker {
+    PlacementEnumerator enumerator;
+    std::array<std::vector<Placement>, PC_MAX_PIECES> placements;
+    std::vector<PerfectClearStep> path;
+    // Index of the first placement this worker is searching
+    int task;
+    // Set when another worker already found an earlier solution
+    bool aborted;
+};
+
+/*
+ * Everything that stays the same during a single solve
+ */
+struct PerfectClearSolver::Problem {
+    const std::vector<TetrominoKind_t> *preview;
+    int max_pieces;
+    // Mixed into all hashes so that dead positions of different solves don't
+    // get mixed up
+    uint64_t salt;
+    TranspositionTable *table;
+    // Earliest first placement that leads to a solution
+    std::atomic<int> best_task{INT_MAX};
+};
+
+/**
+ * @param n_threads number of search threads, 0 for one per CPU
+ * @param table_size_log2 number of entries of the table of dead positions
+ */
+PerfectClearSolver::PerfectClearSolver(int n_threads, int table_size_log2)
+    : m_n_threads(n_threads > 0
+                      ? n_threads
+                      : std::max(1u, std::thread::hardware_concurrency())),
+      m_table(table_size_log2) {}
+
+/**
+ * Find a sequence of at most `max_pieces` placements that clears the whole
+ * board. Lower perfect clears are tried first.
+ *
+ * @param held the held Tetromino or 255 if there is none
+ * @param can_hold whether holding is allowed for the active Tetromino
+ * @param preview the Tetrominos following the active one, in order
+ * @param solution receives the placements if a perfect clear was found
+ * @return whether a perfect clear was found
+ */
+bool PerfectClearSolver::solve(const BitBoard &board, TetrominoKind_t active,
+                               TetrominoKind_t held, bool can_hold,
+                               const std::vector<TetrominoKind_t> &preview,
+                               int max_pieces,
+                               std::vector<PerfectClearStep> &solution) {
+    solution.clear();
+    max_pieces = std::min(max_pieces, PC_MAX_PIECES);
+
+    int filled = 0;
+    int stack_height = 0;
+    for (int row = 0; row < GRID_SIZE_Y; row++) {
+        if (board.rows[row]) {
+            filled += __builtin_popcount(board.rows[row]);
+            stack_height = std::max(stack_height, GRID_SIZE_Y - row);
+        }
+    }
+
+    uint64_t salt = 0;
+    auto mix = [&salt](uint64_t value) {
+        uint64_t state = salt ^ value;
+        salt = splitMix64(state);
+    };
+    mix(active);
+    mix(held);
+    mix(can_hold);
+    for (TetrominoKind_t kind : preview) {
+        mix(kind);
+    }
+
+    for (int height = std::max(stack_height, 1); height <= PC_MAX_HEIGHT;
+         height++) {
+        int empty = height * GRID_SIZE_X - filled;
+        if (empty % 4 != 0) {
+            continue;
+        }
+        if (empty / 4 > max_pieces) {
+            break;
+        }
+        Problem problem;
+        problem.preview = &preview;
+        problem.max_pieces = max_pieces;
+        problem.salt = salt;
+        problem.table = &m_table;
+
+        // Placements of the first Tetromino are the tasks shared among the
+        // threads
+        struct Task {
+            PerfectClearStep step;
+            TetrominoKind_t active, held;
+            int next;
+        };
+        std::vector<Task> tasks;
+        Worker root;
+        CollisionMap collisions(board);
+        auto addTasks = [&](TetrominoKind_t kind, bool hold,
+                            TetrominoKind_t new_active,
+                            TetrominoKind_t new_held, int next) {
+            std::vector<Placement> &placements = root.placements[0];
+            placements.clear();
+            root.enumerator.enumerate(collisions, kind, placements);
+            for (const Placement &placement : placements) {
+                tasks.push_back(
+                    {{kind, placement, hold}, new_active, new_held, next});
+            }
+        };
+        auto previewAt = [&](int i) -> TetrominoKind_t {
+            return i < (int)preview.size() ? preview[i] : 255;
+        };
+        if (!canStillClear(problem, board, active, held, 0, height, 0)) {
+            continue;
+        }
+        addTasks(active, false, previewAt(0), held, 1);
+        if (can_hold) {
+            if (held == 255 && !preview.empty()) {
+                addTasks(preview[0], true, previewAt(1), active, 2);
+            } else if (held != 255 && held != active) {
+                addTasks(held, true, previewAt(0), active, 1);
+            }
+        }
+
+        std::vector<std::vector<PerfectClearStep>> solutions(tasks.size());
+        std::atomic<int> next_task{0};
+        auto work = [&]() {
+            Worker worker;
+            int i;
+            while ((i = next_task++) < (int)tasks.size() &&
+                   i < problem.best_task.load(std::memory_order_relaxed)) {
+                const Task &task = tasks[i];
+                const Placement &placement = task.step.placement;
+                if (topRow(task.step.kind, placement.orientation,
+                           placement.y) < GRID_SIZE_Y - height) {
+                    continue;
+                }
+                worker.task = i;
+                worker.aborted = false;
+                worker.path.assign(1, task.step);
+                BitBoard child = board;
+                child.place(task.step.kind, placement.orientation, placement.x,
+                            placement.y);
+                int cleared = child.clearLines();
+                if (search(worker, problem, child, task.active, task.held,
+                           task.next, height - cleared, 1)) {
+                    solutions[i] = worker.path;
+                    int best = problem.best_task.load();
+                    while (i < best &&
+                           !problem.best_task.compare_exchange_weak(best, i)) {
+                    }
+                }
+            }
+        };
+        int n_threads = std::min(m_n_threads, (int)tasks.size());
+        std::vector<std::thread> threads;
+        for (int t = 1; t < n_threads; t++) {
+            threads.emplace_back(work);
+        }
+        work();
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+
+        int best = problem.best_task.load();
+        if (best != INT_MAX) {
+            solution = std::move(solutions[best]);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Depth first search for a perfect clear that fills the bottom `height` rows
+ *
+ * @param active the Tetromino to place next, 255 if unknown
+ * @param held the held Tetromino, 255 if none or unknown
+ * @param next index of the next Tetromino in the preview
+ * @param depth number of Tetrominos placed so far
+ */
+bool PerfectClearSolver::search(Worker &worker, const Problem &problem,
+                                const BitBoard &board, TetrominoKind_t active,
+                                TetrominoKind_t held, int next, int height,
+                                int depth) {
+    if (height == 0) {
+        return true;
+    }
+    if (problem.best_task.load(std::memory_order_relaxed) < worker.task) {
+        worker.aborted = true;
+        return false;
+    }
+    if (!canStillClear(problem, board, active, held, next, height, depth)) {
+        return false;
+    }
+
+    uint64_t state =
+        (uint64_t)next | (uint64_t)height << 16 | (uint64_t)active << 32 |
+        (uint64_t)held << 40;
+    uint64_t hash = board.getHash() ^ problem.salt ^ splitMix64(state);
+    int remaining = problem.max_pieces - depth;
+    float value;
+    uint8_t dead_depth;
+    if (problem.table->probe(hash, value, dead_depth) &&
+        dead_depth >= remaining) {
+        return false;
+    }
+
+    const std::vector<TetrominoKind_t> &preview = *problem.preview;
+    auto previewAt = [&](int i) -> TetrominoKind_t {
+        return i < (int)preview.size() ? preview[i] : 255;
+    };
+    // Either place the active Tetromino or hold it and place the held one
+    // (or the next one, if none is held)
+    struct Option {
+        TetrominoKind_t kind, active, held;
+        int next;
+        bool hold;
+    };
+    std::array<Option, 2> options;
+    int n_options = 0;
+    if (active != 255) {
+        options[n_options++] = {active, previewAt(next), held, next + 1, false};
+    }
+    if (held == 255 && active != 255 && previewAt(next) != 255) {
+        options[n_options++] = {previewAt(next), previewAt(next + 1), active,
+                                next + 2, true};
+    } else if (held != 255 && held != active) {
+        options[n_options++] = {held, previewAt(next), active, next + 1, true};
+    }
+
+    std::vector<Placement> &placements = worker.placements[depth];
+    // Both options search the same board
+    CollisionMap collisions(board);
+    for (int i = 0; i < n_options; i++) {
+        const Option &option = options[i];
+        placements.clear();
+        worker.enumerator.enumerate(collisions, option.kind, placements);
+        for (const Placement &placement : placements) {
+            if (topRow(option.kind, placement.orientation, placement.y) <
+                GRID_SIZE_Y - height) {
+                continue;
+            }
+            BitBoard child = board;
+            child.place(option.kind, placement.orientation, placement.x,
+                        placement.y);
+            int cleared = child.clearLines();
+            worker.path.push_back({option.kind, placement, option.hold});
+            if (search(worker, problem, child, option.active, option.held,
+                       option.next, height - cleared, depth + 1)) {
+                return true;
+            }
+            worker.path.pop_back();
+            if (worker.aborted) {
+                return false;
+            }
+        }
+    }
+
+    problem.table->store(hash, 0, remaining);
+    return false;
+}
+
+/**
+ * Check whether the empty cells of the bottom `height` rows could still be
+ * filled with the Tetrominos left
+ */
+bool PerfectClearSolver::canStillClear(const Problem &problem,
+                                       const BitBoard &board,
+                                       TetrominoKind_t active,
+                                       TetrominoKind_t held, int next,
+                                       int height, int depth) {
+    int empty_even = 0, empty_odd = 0;
+    for (int row = GRID_SIZE_Y - height; row < GRID_SIZE_Y; row++) {
+        BitRow_t empty = ~board.rows[row] & FULL_ROW;
+        empty_even += __builtin_popcount(empty & EVEN_COLUMNS);
+        empty_odd += __builtin_popcount(empty & ODD_COLUMNS);
+    }
+    int needed = (empty_even + empty_odd) / 4;
+    if (needed > problem.max_pieces - depth) {
+        return false;
+    }
+
+    // A Tetromino can only reach from column c to c + 1 through a row where
+    // both are empty; line clears never create such a row. Where there is
+    // none, the empty cells on each side must be filled separately.
+    BitRow_t crossings = 0;
+    for (int row = GRID_SIZE_Y - height; row < GRID_SIZE_Y; row++) {
+        BitRow_t empty = ~board.rows[row] & FULL_ROW;
+        crossings |= empty & (empty >> 1);
+    }
+    for (int col = 0; col < GRID_SIZE_X - 1; col++) {
+        if (crossings & (1 << col)) {
+            continue;
+        }
+        BitRow_t left = (2 << col) - 1;
+        int empty_left = 0;
+        for (int row = GRID_SIZE_Y - height; row < GRID_SIZE_Y; row++) {
+            empty_left += __builtin_popcount(~board.rows[row] & left);
+        }
+        if (empty_left % 4 != 0) {
+            return false;
+        }
+    }
+
+    // With hold, the Tetrominos placed are any `needed` of the held one and
+    // the next `needed` ones, so these are the only ones that can help
+    const std::vector<TetrominoKind_t> &preview = *problem.preview;
+    int pool = 0;
+    int capacity = 0;
+    auto add = [&](TetrominoKind_t kind) {
+        if (kind != 255 && pool <= needed) {
+            pool++;
+            capacity += parityCapacity(kind);
+        }
+    };
+    add(held);
+    add(active);
+    for (int i = next; i < (int)preview.size() && pool <= needed; i++) {
+        add(preview[i]);
+    }
+    if (pool < needed) {
+        return false;
+    }
+    return std::abs(empty_even - empty_odd) <= capacity;
+}
+
+PerfectClearWorker::PerfectClearWorker()
+    : m_thread(&PerfectClearWorker::run, this) {}
+
+PerfectClearWorker::~PerfectClearWorker() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+}
+
+/**
+ * Ask for a perfect clear of a position (see PerfectClearSolver::solve());
+ * returns right away
+ *
+ * @param key handed back by takeResult() with the solution, e. g. a hash of
+ *        the position to tell whether the solution is still current
+ */
+void PerfectClearWorker::request(uint64_t key, const BitBoard &board,
+                                 TetrominoKind_t active, TetrominoKind_t held,
+                                 bool can_hold,
+                                 const std::vector<TetrominoKind_t> &preview,
+                                 int max_pieces) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_request = {key, board, active, held, can_hold, preview, max_pieces};
+        m_generation++;
+        m_has_result = false;
+    }
+    m_cv.notify_all();
+}
+
+/**
+ * Get the solution of the latest request, once it is solved
+ *
+ * @param key set to the key of the request
+ * @param solution set to the solution, empty if there is none
+ * @return false if there is no new solution
+ */
+bool PerfectClearWorker::takeResult(uint64_t &key,
+                                    std::vector<PerfectClearStep> &solution) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_has_result) {
+        return false;
+    }
+    key = m_result_key;
+    solution.swap(m_result);
+    m_has_result = false;
+    return true;
+}
+
+/**
+ * Worker thread: solve the latest request until the worker is destroyed
+ */
+void PerfectClearWorker::run() {
+    std::vector<PerfectClearStep> solution;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_cv.wait(lock, [this] { return m_stop || m_solved != m_generation; });
+        if (m_stop) {
+            return;
+        }
+        Request request = m_request;
+        uint64_t generation = m_generation;
+        m_solved = generation;
+        lock.unlock();
+        m_solver.solve(request.board, request.active, request.held,
+                       request.can_hold, request.preview, request.max_pieces,
+                       solution);
+        lock.lock();
+        // A newer request makes this solution useless
+        if (generation == m_generation) {
+            m_has_result = true;
+            m_result_key = request.key;
+            m_result.swap(solution);
+        }
+    }
+}
@@ -0,0 +1,226 @@
+#include <algorithm>
+
+#include "placement.h"
+
+namespace {
+
+/*
+ * For every Tetromino and orientation, the orientation with the lowest index
+ * that occupies the same cells, and the offset between the two. E. g. the
+ * horizontal I in orientation 2 is the one in orientation 0 shifted down by
+ * one row.
+ */
+struct CanonicalPose {
+    uint8_t orientation;
+    int8_t dx, dy;
+};
+
+struct CanonicalTable {
+    std::array<std::array<CanonicalPose, 4>, N_TETROMINOS> poses;
+
+    CanonicalTable() {
+        for (int kind = 0; kind < N_TETROMINOS; kind++) {
+            for (int orientation = 0; orientation < 4; orientation++) {
+                poses[kind][orientation] = {(uint8_t)orientation, 0, 0};
+                for (int other = 0; other < orientation; other++) {
+                    int dx, dy;
+                    if (sameShape(kind, orientation, other, dx, dy)) {
+                        poses[kind][orientation] = {(uint8_t)other, (int8_t)dx,
+                                                    (int8_t)dy};
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // Get the top left corner of the occupied cells of a grid
+    static void bounds(const PieceRows_t &rows, int &top, int &left) {
+        top = 0;
+        while (!rows[top]) {
+            top++;
+        }
+        BitRow_t all = rows[0] | rows[1] | rows[2] | rows[3];
+        left = __builtin_ctz(all);
+    }
+
+    static bool sameShape(int kind, int a, int b, int &dx, int &dy) {
+        const PieceRows_t &rows_a = getPieceRows(kind, a);
+        const PieceRows_t &rows_b = getPieceRows(kind, b);
+        int top_a, left_a, top_b, left_b;
+        bounds(rows_a, top_a, left_a);
+        bounds(rows_b, top_b, left_b);
+        for (int row = 0; row < 4; row++) {
+            BitRow_t row_a = row + top_a < 4 ? rows_a[row + top_a] >> left_a : 0;
+            BitRow_t row_b = row + top_b < 4 ? rows_b[row + top_b] >> left_b : 0;
+            if (row_a != row_b) {
+                return false;
+            }
+        }
+        // Offset to add to a position in orientation `a` to get the position
+        // in orientation `b` occupying the same cells
+        dx = left_a - left_b;
+        dy = top_a - top_b;
+        return true;
+    }
+};
+
+const CanonicalTable &getCanonicalTable() {
+    static const CanonicalTable table;
+    return table;
+}
+
+} // namespace
+
+template <class Board>
+BasicPlacementEnumerator<Board>::BasicPlacementEnumerator()
+    : m_visited(N_STATES), m_locked(N_STATES), m_parent(N_STATES),
+      m_parent_move(N_STATES) {
+    m_queue.reserve(N_STATES);
+}
+
+template <class Board>
+int BasicPlacementEnumerator<Board>::index(int x, int y, uint8_t orientation) {
+    return (orientation * SIZE_Y + y + OFFSET) * SIZE_X + x + OFFSET;
+}
+
+/**
+ * Mark a node as visited and queue it
+ *
+ * @return false if it had already been visited
+ */
+template <class Board>
+bool BasicPlacementEnumerator<Board>::visit(const Node &node, int parent,
+                                            Move move) {
+    if (node.x < -OFFSET || node.x >= Size::WIDTH || node.y < -OFFSET ||
+        node.y >= Size::HEIGHT) {
+        return false;
+    }
+    int i = index(node.x, node.y, node.orientation);
+    if (m_visited[i]) {
+        return false;
+    }
+    m_visited[i] = 1;
+    m_parent[i] = parent;
+    m_parent_move[i] = move;
+    m_queue.push_back(node);
+    return true;
+}
+
+/**
+ * Try to rotate using the same wall kicks as Active
+ *
+ * @return whether the rotation was possible
+ */
+template <class Board>
+bool BasicPlacementEnumerator<Board>::tryRotate(const Board &board,
+                                                TetrominoKind_t kind,
+                                                const Node &from,
+                                                int8_t direction,
+                                                Node &result) {
+    uint8_t orientation = (from.orientation + (direction > 0 ? 1 : 3)) % 4;
+    if (kind == 3) {
+        // O Tetromino; doesn't perform Wall Kicks
+        result = {from.x, from.y, orientation, true};
+        return true;
+    }
+    const WallkickData_t *wallkick_data;
+    if (direction > 0) {
+        wallkick_data = kind == 0 ? &WALLKICK_I_C[from.orientation]
+                                  : &WALLKICK_OTHER_C[from.orientation];
+    } else {
+        wallkick_data = kind == 0 ? &WALLKICK_I_CC[from.orientation]
+                                  : &WALLKICK_OTHER_CC[from.orientation];
+    }
+    for (const Wallkick_t &kick : *wallkick_data) {
+        int x = from.x + kick[0];
+        int y = from.y + kick[1];
+        if (board.fits(kind, orientation, x, y)) {
+            result = {(int8_t)x, (int8_t)y, orientation, true};
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Find all placements of a Tetromino on the given board
+ *
+ * @param result the placements are appended here
+ *
+ * @return the number of placements found
+ */
+template <class Board>
+int BasicPlacementEnumerator<Board>::enumerate(const Board &board,
+                                               TetrominoKind_t kind,
+                                               std::vector<Placement> &result) {
+    std::fill(m_visited.begin(), m_visited.end(), 0);
+    std::fill(m_locked.begin(), m_locked.end(), 0);
+    m_queue.clear();
+    if (!board.fits(kind, 0, Size::SPAWN_X, Size::SPAWN_Y)) {
+        return 0;
+    }
+    const std::array<CanonicalPose, 4> &canonical =
+        getCanonicalTable().poses[kind];
+
+    int n_found = 0;
+    visit({Size::SPAWN_X, Size::SPAWN_Y, 0, false}, -1, Move::Down);
+    for (size_t head = 0; head < m_queue.size(); head++) {
+        Node node = m_queue[head];
+        int i = index(node.x, node.y, node.orientation);
+
+        if (!board.fits(kind, node.orientation, node.x, node.y + 1)) {
+            // Can't step down; report the placement unless another orientation
+            // occupying the same cells has already been reported
+            const CanonicalPose &pose = canonical[node.orientation];
+            int locked = index(node.x + pose.dx, node.y + pose.dy,
+                               pose.orientation);
+            if (!m_locked[locked]) {
+                m_locked[locked] = 1;
+                result.push_back(
+                    {node.x, node.y, node.orientation, node.spin});
+                n_found++;
+            }
+        } else {
+            visit({node.x, (int8_t)(node.y + 1), node.orientation, false}, i,
+                  Move::Down);
+        }
+        if (board.fits(kind, node.orientation, node.x - 1, node.y)) {
+            visit({(int8_t)(node.x - 1), node.y, node.orientation, false}, i,
+                  Move::Left);
+        }
+        if (board.fits(kind, node.orientation, node.x + 1, node.y)) {
+            visit({(int8_t)(node.x + 1), node.y, node.orientation, false}, i,
+                  Move::Right);
+        }
+        Node rotated;
+        if (tryRotate(board, kind, node, 1, rotated)) {
+            visit(rotated, i, Move::RotateClockw);
+        }
+        if (tryRotate(board, kind, node, -1, rotated)) {
+            visit(rotated, i, Move::RotateCounterclockw);
+        }
+    }
+    return n_found;
+}
+
+/**
+ * Get the shortest sequence of moves from the spawn position to a placement
+ * found by the last call to enumerate()
+ */
+template <class Board>
+void BasicPlacementEnumerator<Board>::getPath(const Placement &placement,
+                                              std::vector<Move> &path) const {
+    path.clear();
+    int i = index(placement.x, placement.y, placement.orientation);
+    while (m_parent[i] >= 0) {
+        path.push_back(m_parent_move[i]);
+        i = m_parent[i];
+    }
+    std::reverse(path.begin(), path.end());
+}
+
+template class BasicPlacementEnumerator<BitBoard>;
+template class BasicPlacementEnumerator<WideBitBoard>;
+template class BasicPlacementEnumerator<CollisionMap>;
+template class BasicPlacementEnumerator<WideCollisionMap>;
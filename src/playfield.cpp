@@ -7,79 +7,124 @@
 
 #include "active.h"
 #include "playfield.h"
+#include "zobrist.h"
 
-Playfield::Playfield() : Playfield(0, 0) {}
-Playfield::Playfield(int draw_x, int draw_y)
+template <int Width, int Height>
+BasicPlayfield<Width, Height>::BasicPlayfield() : BasicPlayfield(0, 0) {}
+
+template <int Width, int Height>
+BasicPlayfield<Width, Height>::BasicPlayfield(int draw_x, int draw_y)
     : m_draw_x(draw_x), m_draw_y(draw_y) {
     reset();
 }
 
-void Playfield::reset() {
+template <int Width, int Height>
+void BasicPlayfield<Width, Height>::reset() {
     // Initialize all cells to 7, which represents an empty space
     // values 0~6 correspond to different Minos
-    for (int row = 0; row < GRID_SIZE_Y; row++) {
-        for (int col = 0; col < GRID_SIZE_X; col++) {
-            m_grid[row][col] = 7;
+    for (int row = 0; row < Height; row++) {
+        for (int col = 0; col < Width; col++) {
+            m_grid[row][col] = EMPTY_MINO;
         }
     }
+    // Empty cells don't contribute to the hash
+    m_hash = 0;
+    m_collisions_valid = false;
 }
 
-std::array<int, 2> Playfield::cellToPixelPosition(int cell_x, int cell_y) {
-    return std::array<int, 2>{m_draw_x + cell_x * CELL_SIZE,
-                              m_draw_y + (cell_y - GRID_START_Y) * CELL_SIZE};
+template <int Width, int Height>
+std::array<int, 2>
+BasicPlayfield<Width, Height>::cellToPixelPosition(int cell_x, int cell_y) {
+    return std::array<int, 2>{
+        m_draw_x + cell_x * m_cell_size,
+        m_draw_y + (cell_y - Size::START_Y) * m_cell_size};
 }
 
-void Playfield::draw(SDL_Renderer *renderer) {
+template <int Width, int Height>
+void BasicPlayfield<Width, Height>::draw(SDL_Renderer *renderer) {
     // TODO: Accept different drawing positions
     drawOutline(renderer);
     drawPlayfield(renderer);
 }
 
-void Playfield::setDrawPosition(int x, int y) {
+/**
+ * Add the outline and the locked Minos to a batch shared with other boards
+ */
+template <int Width, int Height>
+void BasicPlayfield<Width, Height>::draw(MinoBatch &batch) const {
+    batch.addOutline({m_draw_x, m_draw_y, Width * m_cell_size + 1,
+                      Size::VISIBLE_HEIGHT * m_cell_size + 1});
+    for (int row = Size::START_Y; row < Height; row++) {
+        for (int col = 0; col < Width; col++) {
+            batch.addMino(m_draw_x + col * m_cell_size,
+                          m_draw_y + (row - Size::START_Y) * m_cell_size,
+                          m_cell_size, m_grid[row][col]);
+        }
+    }
+}
+
+/**
+ * @param cell_size size of a cell in pixels; smaller than CELL_SIZE to fit
+ *        several boards in a window
+ */
+template <int Width, int Height>
+void BasicPlayfield<Width, Height>::setDrawPosition(int x, int y,
+                                                    int cell_size) {
     m_draw_x = x;
     m_draw_y = y;
+    m_cell_size = cell_size;
 }
 
-void Playfield::drawPlayfield(SDL_Renderer *renderer) {
+template <int Width, int Height>
+void BasicPlayfield<Width, Height>::drawPlayfield(SDL_Renderer *renderer) {
     std::array<int, 2> pos;
-    for (int row = GRID_START_Y; row < GRID_SIZE_Y; row++) {
-        for (int col = 0; col < GRID_SIZE_X; col++) {
+    for (int row = Size::START_Y; row < Height; row++) {
+        for (int col = 0; col < Width; col++) {
             if (m_grid[row][col] < 7) {
                 pos = cellToPixelPosition(col, row);
                 drawMino(renderer, pos[0], pos[1],
-                         TETROMINO_COLORS[m_grid[row][col]]);
+                         TETROMINO_COLORS[m_grid[row][col]], m_cell_size);
+            } else if (m_grid[row][col] == GARBAGE_MINO) {
+                pos = cellToPixelPosition(col, row);
+                drawMino(renderer, pos[0], pos[1], GARBAGE_COLOR,
+                         m_cell_size);
             }
         }
     }
 }
 
-void Playfield::drawOutline(SDL_Renderer *renderer) {
+template <int Width, int Height>
+void BasicPlayfield<Width, Height>::drawOutline(SDL_Renderer *renderer) {
     SDL_SetRenderDrawColor(renderer, GRID_COLOR.r, GRID_COLOR.g, GRID_COLOR.b,
                            GRID_COLOR.a);
+    int width = Width * m_cell_size;
+    int height = Size::VISIBLE_HEIGHT * m_cell_size;
     // clang-format off
     // Draw vertical lines
     SDL_RenderDrawLine(renderer,
-        m_draw_x,                   m_draw_y,
-        m_draw_x,                   m_draw_y + PLAYFIELD_HEIGHT);
+        m_draw_x,         m_draw_y,
+        m_draw_x,         m_draw_y + height);
     SDL_RenderDrawLine(renderer,
-        m_draw_x + PLAYFIELD_WIDTH, m_draw_y,
-        m_draw_x + PLAYFIELD_WIDTH, m_draw_y + PLAYFIELD_HEIGHT);
+        m_draw_x + width, m_draw_y,
+        m_draw_x + width, m_draw_y + height);
     // Draw horizontal lines
     SDL_RenderDrawLine(renderer,
-        m_draw_x,                   m_draw_y,
-        m_draw_x + PLAYFIELD_WIDTH, m_draw_y);
+        m_draw_x,         m_draw_y,
+        m_draw_x + width, m_draw_y);
     SDL_RenderDrawLine(renderer,
-        m_draw_x,                   m_draw_y + PLAYFIELD_HEIGHT,
-        m_draw_x + PLAYFIELD_WIDTH, m_draw_y + PLAYFIELD_HEIGHT);
+        m_draw_x,         m_draw_y + height,
+        m_draw_x + width, m_draw_y + height);
     // clang-format on
 }
 
-void Playfield::drawMino(SDL_Renderer *renderer, int x, int y,
-                         const SDL_Color &color) {
+template <int Width, int Height>
+void BasicPlayfield<Width, Height>::drawMino(SDL_Renderer *renderer, int x,
+                                             int y, const SDL_Color &color,
+                                             int size) {
     // Draw a Mino at the given pixel position
 
     // Create destination rectangle
-    SDL_Rect rect{x, y, CELL_SIZE + 1, CELL_SIZE + 1};
+    SDL_Rect rect{x, y, size + 1, size + 1};
     // Draw a rectangle filled with the given color
     SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.b);
     SDL_RenderFillRect(renderer, &rect);
@@ -91,7 +136,9 @@ void Playfield::drawMino(SDL_Renderer *renderer, int x, int y,
     SDL_RenderDrawPoint(renderer, rect.x + rect.w - 1, rect.y + rect.h - 1);
 }
 
-void Playfield::drawGhostMino(SDL_Renderer *renderer, int x, int y) {
+template <int Width, int Height>
+void BasicPlayfield<Width, Height>::drawGhostMino(SDL_Renderer *renderer,
+                                                  int x, int y) {
     // Draw a Mino representing a Ghost Piece at the given pixel position
 
     // Create destination rectangle
@@ -102,19 +149,22 @@ void Playfield::drawGhostMino(SDL_Renderer *renderer, int x, int y) {
     SDL_RenderDrawRect(renderer, &rect);
 }
 
-uint8_t Playfield::getAt(int x, int y) {
+template <int Width, int Height>
+uint8_t BasicPlayfield<Width, Height>::getAt(int x, int y) {
     return m_grid[y][x];
 }
 
-bool Playfield::isObstructed(int x, int y) {
-    if (x < 0 || x >= GRID_SIZE_X || y < 0 || y >= GRID_SIZE_Y) {
+template <int Width, int Height>
+bool BasicPlayfield<Width, Height>::isObstructed(int x, int y) {
+    if (x < 0 || x >= Width || y < 0 || y >= Height) {
         return true;
     }
     TetrominoKind_t val = getAt(x, y);
-    return 0 <= val && val < 7;
+    return val != EMPTY_MINO;
 }
 
-bool Playfield::setAt(int x, int y, uint8_t mino_type) {
+template <int Width, int Height>
+bool BasicPlayfield<Width, Height>::setAt(int x, int y, uint8_t mino_type) {
     // Only set the cell if mino_type is valid
     if (mino_type < 0 || mino_type > 6) {
         return false;
@@ -124,16 +174,88 @@ bool Playfield::setAt(int x, int y, uint8_t mino_type) {
     }
 }
 
-void Playfield::setAtHard(int x, int y, uint8_t mino_type) {
+template <int Width, int Height>
+void BasicPlayfield<Width, Height>::setAtHard(int x, int y,
+                                              uint8_t mino_type) {
+    // Update the hash if the cell changes between empty and occupied
+    if ((m_grid[y][x] == EMPTY_MINO) != (mino_type == EMPTY_MINO)) {
+        m_hash ^= ZOBRIST_CELLS<Width, Height>[y][x];
+        m_collisions_valid = false;
+    }
     m_grid[y][x] = mino_type;
 }
 
-void Playfield::clearAt(int x, int y) {
-    m_grid[y][x] = 7;
+template <int Width, int Height>
+void BasicPlayfield<Width, Height>::clearAt(int x, int y) {
+    setAtHard(x, y, EMPTY_MINO);
+}
+
+/**
+ * Get a copy of the Playfield that only stores which cells are occupied
+ */
+template <int Width, int Height>
+BasicBitBoard<Width, Height>
+BasicPlayfield<Width, Height>::getBitBoard() const {
+    BasicBitBoard<Width, Height> board;
+    for (int row = 0; row < Height; row++) {
+        for (int col = 0; col < Width; col++) {
+            if (m_grid[row][col] != EMPTY_MINO) {
+                board.rows[row] |= (typename Size::Row_t)1 << col;
+            }
+        }
+    }
+    return board;
+}
+
+/**
+ * Get the poses of Tetrominos that fit on the Playfield. Built from the
+ * occupied cells the first time it is needed after any of them changed, so
+ * all inputs between two lock downs share the same map.
+ */
+template <int Width, int Height>
+const BasicCollisionMap<Width, Height> &
+BasicPlayfield<Width, Height>::getCollisionMap() const {
+    if (!m_collisions_valid) {
+        m_collisions.reset(getBitBoard());
+        m_collisions_valid = true;
+    }
+    return m_collisions;
+}
+
+/**
+ * Check whether a Tetromino with its top left corner at (x, y) overlaps
+ * neither any Mino nor the borders of the Playfield
+ */
+template <int Width, int Height>
+bool BasicPlayfield<Width, Height>::fits(TetrominoKind_t kind,
+                                         uint8_t orientation, int x,
+                                         int y) const {
+    return getCollisionMap().fits(kind, orientation, x, y);
+}
+
+/**
+ * Get the vertical position a Tetromino would land at if hard dropped from
+ * (x, y), which must fit
+ */
+template <int Width, int Height>
+int BasicPlayfield<Width, Height>::dropY(TetrominoKind_t kind,
+                                         uint8_t orientation, int x,
+                                         int y) const {
+    return getCollisionMap().dropY(kind, orientation, x, y);
+}
+
+/**
+ * Get the Zobrist hash of the occupied cells. Two Playfields with the same
+ * cells occupied have the same hash, regardless of the kinds of Minos.
+ */
+template <int Width, int Height>
+uint64_t BasicPlayfield<Width, Height>::getHash() const {
+    return m_hash;
 }
 
-bool Playfield::isRowFilled(int row) {
-    for (int col = 0; col < GRID_SIZE_X; col++) {
+template <int Width, int Height>
+bool BasicPlayfield<Width, Height>::isRowFilled(int row) {
+    for (int col = 0; col < Width; col++) {
         if (!isObstructed(col, row)) {
             return false;
         }
@@ -141,8 +263,9 @@ bool Playfield::isRowFilled(int row) {
     return true;
 }
 
-void Playfield::copyRow(int from, int to) {
-    for (int col = 0; col < GRID_SIZE_X; col++) {
+template <int Width, int Height>
+void BasicPlayfield<Width, Height>::copyRow(int from, int to) {
+    for (int col = 0; col < Width; col++) {
         setAtHard(col, to, getAt(col, from));
     }
 }
@@ -152,15 +275,16 @@ void Playfield::copyRow(int from, int to) {
  *
  * @return the number of removed lines
  */
-int Playfield::clearEmptyLines() {
+template <int Width, int Height>
+int BasicPlayfield<Width, Height>::clearEmptyLines() {
     // Only store cleared lines for the visible portion of the grid (which
-    // causes all those 'GRID_START_Y + ...' offsets)
-    std::array<bool, GRID_SIZE_VISIBLE_Y> cleared_lines{};
+    // causes all those 'Size::START_Y + ...' offsets)
+    std::array<bool, Size::VISIBLE_HEIGHT> cleared_lines{};
     int n_cleared = 0;
-    for (int row = 0; row < GRID_SIZE_VISIBLE_Y; row++) {
-        if (isRowFilled(GRID_START_Y + row)) {
-            for (int col = 0; col < GRID_SIZE_X; col++) {
-                clearAt(col, GRID_START_Y + row);
+    for (int row = 0; row < Size::VISIBLE_HEIGHT; row++) {
+        if (isRowFilled(Size::START_Y + row)) {
+            for (int col = 0; col < Width; col++) {
+                clearAt(col, Size::START_Y + row);
             }
             cleared_lines[row] = 1;
             n_cleared++;
@@ -169,13 +293,14 @@ int Playfield::clearEmptyLines() {
 
     // Iterate over the columns from bottom to top. Everytime we encounter a
     // line that's just been cleared, copy down everything from above
-    for (int row = GRID_SIZE_VISIBLE_Y - 1; row >= 0; row--) {
+    for (int row = Size::VISIBLE_HEIGHT - 1; row >= 0; row--) {
         if (cleared_lines[row]) {
             for (int row_i = row; row_i >= 0; row_i--) {
                 // Copy row above into current row
-                copyRow(GRID_START_Y + row_i - 1, GRID_START_Y + row_i);
-                // Same for cleared lines
-                cleared_lines[row_i] = cleared_lines[row_i - 1];
+                copyRow(Size::START_Y + row_i - 1, Size::START_Y + row_i);
+                // Same for cleared lines; the row coming down from the
+                // buffer zone was never cleared
+                cleared_lines[row_i] = row_i > 0 && cleared_lines[row_i - 1];
             }
             // Check this row again in the next iteration
             row++;
@@ -183,3 +308,37 @@ int Playfield::clearEmptyLines() {
     }
     return n_cleared;
 }
+
+/**
+ * Push the contents of the Playfield up and insert garbage lines at the
+ * bottom. Every garbage line is filled except for the cell in column `hole_x`.
+ *
+ * @return false if any Mino was pushed out of the top of the grid
+ */
+template <int Width, int Height>
+bool BasicPlayfield<Width, Height>::addGarbage(int n_lines, int hole_x) {
+    bool overflow = false;
+    for (int row = 0; row < n_lines; row++) {
+        for (int col = 0; col < Width; col++) {
+            if (isObstructed(col, row)) {
+                overflow = true;
+            }
+        }
+    }
+    for (int row = 0; row < Height - n_lines; row++) {
+        copyRow(row + n_lines, row);
+    }
+    for (int row = Height - n_lines; row < Height; row++) {
+        for (int col = 0; col < Width; col++) {
+            if (col == hole_x) {
+                clearAt(col, row);
+            } else {
+                setAtHard(col, row, GARBAGE_MINO);
+            }
+        }
+    }
+    return !overflow;
+}
+
+template class BasicPlayfield<GRID_SIZE_X, GRID_SIZE_Y>;
+template class BasicPlayfield<WIDE_GRID_SIZE_X, GRID_SIZE_Y>;
@@ -0,0 +1,310 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "replay.h"
+#include "sim.h"
+
+namespace {
+
+void putVarint(std::vector<uint8_t> &out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((uint8_t)value);
+}
+
+void putFixed(std::vector<uint8_t> &out, uint64_t value, int size) {
+    for (int i = 0; i < size; i++) {
+        out.push_back((uint8_t)(value >> (8 * i)));
+    }
+}
+
+void putDouble(std::vector<uint8_t> &out, double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    putFixed(out, bits, 8);
+}
+
+/*
+ * Reads the fields of a replay, failing instead of reading past its end
+ */
+struct ReplayReader {
+    const uint8_t *pos;
+    const uint8_t *end;
+
+    bool varint(uint64_t &value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && pos != end; shift += 7) {
+            uint8_t b = *pos++;
+            value |= (uint64_t)(b & 0x7f) << shift;
+            if (!(b & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool signedVarint(int64_t &value) {
+        uint64_t raw;
+        if (!varint(raw)) {
+            return false;
+        }
+        value = (int64_t)(raw >> 1) ^ -(int64_t)(raw & 1);
+        return true;
+    }
+
+    bool fixed(uint64_t &value, int size) {
+        if (end - pos < size) {
+            return false;
+        }
+        value = 0;
+        for (int i = 0; i < size; i++) {
+            value |= (uint64_t)*pos++ << (8 * i);
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+/**
+ * Start recording a new game, dropping whatever was recorded before
+ */
+void ReplayRecorder::onRestart(cl::time_point now, uint32_t seed,
+                               const Handling &handling) {
+    m_data.clear();
+    putFixed(m_data, REPLAY_MAGIC, 4);
+    putFixed(m_data, seed, 4);
+    putDouble(m_data, handling.das_ms);
+    putDouble(m_data, handling.arr_ms);
+    putDouble(m_data, handling.soft_drop_factor);
+    m_last = now;
+    m_updates = 0;
+}
+
+void ReplayRecorder::putRecord(uint8_t tag, cl::time_point now) {
+    m_data.push_back(tag);
+    int64_t delta = (now - m_last).count();
+    putVarint(m_data, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+    m_last = now;
+}
+
+void ReplayRecorder::onAction(Action action, cl::time_point now) {
+    if (!m_data.empty()) {
+        putRecord((uint8_t)action, now);
+    }
+}
+
+void ReplayRecorder::onUpdate(Simulation &sim, cl::time_point now) {
+    if (m_data.empty()) {
+        return;
+    }
+    if (++m_updates % REPLAY_CHECKSUM_INTERVAL == 0) {
+        putRecord(REPLAY_CHECKED_UPDATE, now);
+        putFixed(m_data, sim.getChecksum(), 4);
+    } else {
+        putRecord(REPLAY_UPDATE, now);
+    }
+}
+
+void ReplayRecorder::onPause(cl::time_point now) {
+    if (!m_data.empty()) {
+        putRecord(REPLAY_PAUSE, now);
+    }
+}
+
+void ReplayRecorder::onResume(cl::time_point now) {
+    if (!m_data.empty()) {
+        putRecord(REPLAY_RESUME, now);
+    }
+}
+
+/**
+ * End the recording with the final state of the game and hand it over.
+ * Nothing is recorded from then on until the next restart.
+ *
+ * @param replay set to the finished replay
+ * @return false if nothing was recorded
+ */
+bool ReplayRecorder::finish(Simulation &sim, std::vector<uint8_t> &replay) {
+    if (m_data.empty()) {
+        return false;
+    }
+    const ScoringSystem &scoring = sim.getScoring();
+    m_data.push_back(REPLAY_END);
+    putVarint(m_data, (uint32_t)scoring.getScore());
+    putVarint(m_data, (uint32_t)scoring.getLines());
+    putVarint(m_data, (uint32_t)scoring.getLevel());
+    putVarint(m_data, (uint32_t)sim.getLockCount());
+    putFixed(m_data, sim.getChecksum(), 4);
+    replay.clear();
+    replay.swap(m_data);
+    return true;
+}
+
+/**
+ * Load a replay file
+ *
+ * @throws std::runtime_error if it can't be read or isn't a replay
+ */
+Replay::Replay(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Couldn't open " + path);
+    }
+    m_data.assign(std::istreambuf_iterator<char>(in),
+                  std::istreambuf_iterator<char>());
+    ReplayReader reader{m_data.data(), m_data.data() + m_data.size()};
+    uint64_t magic, seed, das, arr, soft_drop;
+    if (!reader.fixed(magic, 4) || magic != REPLAY_MAGIC ||
+        !reader.fixed(seed, 4) || !reader.fixed(das, 8) ||
+        !reader.fixed(arr, 8) || !reader.fixed(soft_drop, 8)) {
+        throw std::runtime_error(path + " isn't a replay");
+    }
+    m_seed = seed;
+    std::memcpy(&m_handling.das_ms, &das, 8);
+    std::memcpy(&m_handling.arr_ms, &arr, 8);
+    std::memcpy(&m_handling.soft_drop_factor, &soft_drop, 8);
+}
+
+uint32_t Replay::getSeed() const {
+    return m_seed;
+}
+
+/**
+ * Play the game back on a new Simulation, comparing its checksum with the
+ * recorded ones along the way. Playing goes on after a checksum differs, so
+ * that games recorded under other rules are scored under the current ones.
+ *
+ * @param dump where to print the state of the Simulation at the first
+ *             differing checksum, if anywhere
+ * @return false if the replay is malformed or ends early
+ */
+bool Replay::play(ReplayResult &result, std::ostream *dump) const {
+    result = ReplayResult{};
+    result.desync_tick = -1;
+    result.last_good_tick = -1;
+
+    Simulation sim(m_seed);
+    sim.setHandling(m_handling);
+    cl::time_point now{};
+    sim.restart(now, m_seed);
+
+    ReplayReader reader{m_data.data() + REPLAY_HEADER_SIZE,
+                        m_data.data() + m_data.size()};
+    while (reader.pos != reader.end) {
+        uint8_t tag = *reader.pos++;
+        if (tag == REPLAY_END) {
+            uint64_t score, lines, level, pieces, checksum;
+            if (!reader.varint(score) || !reader.varint(lines) ||
+                !reader.varint(level) || !reader.varint(pieces) ||
+                !reader.fixed(checksum, 4)) {
+                return false;
+            }
+            result.score = (int32_t)score;
+            result.lines = (int32_t)lines;
+            result.level = (int32_t)level;
+            result.pieces = (int32_t)pieces;
+            const ScoringSystem &scoring = sim.getScoring();
+            result.replayed_score = scoring.getScore();
+            result.replayed_lines = scoring.getLines();
+            result.replayed_level = scoring.getLevel();
+            result.replayed_pieces = sim.getLockCount();
+            result.duration_ms =
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    now.time_since_epoch())
+                    .count();
+            if (sim.getChecksum() != checksum && result.desync_tick < 0) {
+                result.desync_tick = result.ticks;
+            }
+            return true;
+        }
+
+        int64_t delta;
+        if (!reader.signedVarint(delta)) {
+            return false;
+        }
+        now += cl::duration(delta);
+        if (tag < N_ACTIONS) {
+            sim.apply((Action)tag, now);
+        } else if (tag == REPLAY_UPDATE || tag == REPLAY_CHECKED_UPDATE) {
+            uint64_t checksum;
+            if (tag == REPLAY_CHECKED_UPDATE) {
+                if (!reader.fixed(checksum, 4)) {
+                    return false;
+                }
+                // Only the first difference counts
+                bool synced = result.desync_tick < 0;
+                if (synced && sim.getChecksum() == checksum) {
+                    result.last_good_tick = result.ticks;
+                } else if (synced) {
+                    result.desync_tick = result.ticks;
+                    if (dump) {
+                        *dump << "Tick " << result.ticks
+                              << ": recorded checksum " << checksum
+                              << ", played back:\n";
+                        sim.dump(*dump);
+                    }
+                }
+            }
+            sim.update(now);
+            result.ticks++;
+        } else if (tag == REPLAY_PAUSE) {
+            sim.pause(now);
+        } else if (tag == REPLAY_RESUME) {
+            sim.resume(now);
+        } else {
+            return false;
+        }
+    }
+    return false;
+}
+
+/**
+ * Play replays back on `n_threads` threads (one per core if 0), as fast as
+ * they go. Each thread takes the next replay once it is done with one, so
+ * long games don't hold the others up.
+ *
+ * @param dump whether to keep the state of games that diverge
+ * @param checks set to the outcome for each replay, in the order of `paths`
+ */
+void verifyReplays(const std::vector<std::string> &paths, int n_threads,
+                   bool dump, std::vector<ReplayCheck> &checks) {
+    checks.assign(paths.size(), ReplayCheck{});
+    if (n_threads == 0) {
+        n_threads = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    n_threads = std::min(n_threads, (int)paths.size());
+    std::atomic<size_t> next{0};
+    auto work = [&]() {
+        for (size_t i; (i = next++) < paths.size();) {
+            ReplayCheck &check = checks[i];
+            check.path = paths[i];
+            try {
+                Replay replay(paths[i]);
+                std::ostringstream out;
+                if (!replay.play(check.result, dump ? &out : nullptr)) {
+                    check.error = paths[i] + " is cut off or malformed";
+                }
+                check.dump = out.str();
+            } catch (const std::exception &e) {
+                check.error = e.what();
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int i = 0; i < n_threads; i++) {
+        threads.emplace_back(work);
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+}
@@ -0,0 +1,401 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include "fcntl.h"
+#include "sys/mman.h"
+#include "sys/stat.h"
+#include "unistd.h"
+
+#include "sessionlog.h"
+
+constexpr std::array<uint32_t, 256> makeCrcTable() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (crc & 1 ? 0xedb88320 : 0);
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+inline constexpr std::array<uint32_t, 256> CRC_TABLE = makeCrcTable();
+
+/**
+ * CRC-32 (as used by zlib) of a block of memory
+ */
+static uint32_t crc32(const void *data, size_t size) {
+    const uint8_t *bytes = (const uint8_t *)data;
+    uint32_t crc = 0xffffffff;
+    for (size_t i = 0; i < size; i++) {
+        crc = CRC_TABLE[(crc ^ bytes[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static bool isValid(const SessionLogEntry &entry) {
+    return entry.magic == SESSION_LOG_MAGIC &&
+           entry.crc == crc32(&entry.record, sizeof(entry.record));
+}
+
+static bool higherScore(const SessionIndexEntry &a,
+                        const SessionIndexEntry &b) {
+    return a.score > b.score;
+}
+
+static bool lowerSeed(const SessionIndexEntry &a, const SessionIndexEntry &b) {
+    return a.seed < b.seed || (a.seed == b.seed && a.score > b.score);
+}
+
+/**
+ * Open the log at `path`, creating it if it doesn't exist yet
+ *
+ * @throws std::runtime_error if the log or its index can't be opened
+ */
+SessionLog::SessionLog(const std::string &path) : m_path(path) {
+    m_log_fd = open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (m_log_fd < 0) {
+        throw std::runtime_error("Couldn't open session log " + path);
+    }
+    m_index_fd = open((path + ".idx").c_str(), O_RDWR | O_CREAT, 0644);
+    if (m_index_fd < 0) {
+        close(m_log_fd);
+        throw std::runtime_error("Couldn't open session index " + path +
+                                 ".idx");
+    }
+    openIndex();
+    // Entries already in the index have been checked when they were added
+    uint32_t indexed = m_index ? m_index->count : 0;
+    m_count = recover(indexed);
+    if (!m_index || indexed > m_count) {
+        rebuildIndex();
+    } else {
+        for (uint32_t i = indexed; i < m_count; i++) {
+            SessionLogEntry entry;
+            if (!read(i, entry)) {
+                rebuildIndex();
+                break;
+            }
+            insertIndex({entry.record.score, entry.record.seed, i});
+        }
+    }
+    m_writer = std::thread(&SessionLog::run, this);
+}
+
+SessionLog::~SessionLog() {
+    {
+        std::lock_guard<std::mutex> lock(m_pending_mutex);
+        m_stop = true;
+    }
+    m_pending_cv.notify_all();
+    m_writer.join();
+    unmapIndex();
+    close(m_index_fd);
+    close(m_log_fd);
+}
+
+/**
+ * Check the entries of the log starting at `first` and cut off everything
+ * from the first invalid one on
+ *
+ * @return number of valid entries
+ */
+uint32_t SessionLog::recover(uint32_t first) {
+    struct stat st;
+    fstat(m_log_fd, &st);
+    uint32_t n_entries = st.st_size / sizeof(SessionLogEntry);
+    if (first > n_entries) {
+        first = 0;
+    }
+    uint32_t count = first;
+    SessionLogEntry entry;
+    while (count < n_entries && read(count, entry)) {
+        count++;
+    }
+    cutOff(count, st.st_size);
+    return count;
+}
+
+/**
+ * Cut the log off after its first `count` entries, if it is `size` bytes long
+ * and has more than that
+ *
+ * @throws std::runtime_error if the log can't be cut off
+ */
+void SessionLog::cutOff(uint32_t count, off_t size) {
+    off_t valid_size = (off_t)count * sizeof(SessionLogEntry);
+    if (valid_size != size) {
+        std::cerr << "WARNING: Discarding " << size - valid_size
+                  << " bytes at the end of " << m_path << "\n";
+        if (ftruncate(m_log_fd, valid_size) != 0) {
+            throw std::runtime_error("Couldn't repair session log " +
+                                     m_path);
+        }
+    }
+}
+
+SessionIndexEntry *SessionLog::byScore() const {
+    return (SessionIndexEntry *)(m_index + 1);
+}
+
+SessionIndexEntry *SessionLog::bySeed() const {
+    return byScore() + m_index->capacity;
+}
+
+/**
+ * Map the existing index file, if it is usable
+ */
+void SessionLog::openIndex() {
+    struct stat st;
+    fstat(m_index_fd, &st);
+    if ((size_t)st.st_size < sizeof(SessionIndexHeader)) {
+        return;
+    }
+    SessionIndexHeader header;
+    if (pread(m_index_fd, &header, sizeof(header), 0) != sizeof(header)) {
+        return;
+    }
+    size_t size = sizeof(SessionIndexHeader) +
+                  2 * (size_t)header.capacity * sizeof(SessionIndexEntry);
+    if (header.magic != SESSION_INDEX_MAGIC || header.dirty ||
+        header.count > header.capacity || (size_t)st.st_size != size) {
+        return;
+    }
+    mapIndex(header.capacity);
+}
+
+/**
+ * Map the index file with room for `capacity` entries, resizing it if needed
+ */
+void SessionLog::mapIndex(uint32_t capacity) {
+    unmapIndex();
+    size_t size = sizeof(SessionIndexHeader) +
+                  2 * (size_t)capacity * sizeof(SessionIndexEntry);
+    if (ftruncate(m_index_fd, size) != 0) {
+        throw std::runtime_error("Couldn't resize session index " + m_path +
+                                 ".idx");
+    }
+    void *data =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_index_fd, 0);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("Couldn't map session index " + m_path +
+                                 ".idx");
+    }
+    m_index = (SessionIndexHeader *)data;
+    m_index_size = size;
+    m_index->magic = SESSION_INDEX_MAGIC;
+    m_index->capacity = capacity;
+}
+
+void SessionLog::unmapIndex() {
+    if (m_index) {
+        munmap(m_index, m_index_size);
+        m_index = nullptr;
+    }
+}
+
+/**
+ * Build the index from scratch out of all entries of the log. Should an entry
+ * no longer read back intact, the log is cut off before it.
+ */
+void SessionLog::rebuildIndex() {
+    std::vector<SessionIndexEntry> entries(m_count);
+    SessionLogEntry entry;
+    for (uint32_t i = 0; i < m_count; i++) {
+        if (!read(i, entry)) {
+            cutOff(i, (off_t)m_count * sizeof(SessionLogEntry));
+            m_count = i;
+            entries.resize(i);
+            break;
+        }
+        entries[i] = {entry.record.score, entry.record.seed, i};
+    }
+    uint32_t capacity = SESSION_INDEX_MIN_CAPACITY;
+    while (capacity < m_count) {
+        capacity *= 2;
+    }
+    mapIndex(capacity);
+    m_index->dirty = 1;
+    std::stable_sort(entries.begin(), entries.end(), higherScore);
+    std::copy(entries.begin(), entries.end(), byScore());
+    std::stable_sort(entries.begin(), entries.end(), lowerSeed);
+    std::copy(entries.begin(), entries.end(), bySeed());
+    m_index->count = m_count;
+    m_index->dirty = 0;
+}
+
+/**
+ * Insert an entry into both sorted arrays of the index. Entries with equal
+ * keys stay in the order they were added.
+ */
+void SessionLog::insertIndex(const SessionIndexEntry &entry) {
+    uint32_t count = m_index->count;
+    if (count == m_index->capacity) {
+        std::vector<SessionIndexEntry> by_score(byScore(), byScore() + count);
+        std::vector<SessionIndexEntry> by_seed(bySeed(), bySeed() + count);
+        mapIndex(2 * count);
+        std::copy(by_score.begin(), by_score.end(), byScore());
+        std::copy(by_seed.begin(), by_seed.end(), bySeed());
+    }
+    m_index->dirty = 1;
+    SessionIndexEntry *first = byScore();
+    SessionIndexEntry *pos =
+        std::upper_bound(first, first + count, entry, higherScore);
+    std::memmove(pos + 1, pos, (first + count - pos) * sizeof(*pos));
+    *pos = entry;
+    first = bySeed();
+    pos = std::upper_bound(first, first + count, entry, lowerSeed);
+    std::memmove(pos + 1, pos, (first + count - pos) * sizeof(*pos));
+    *pos = entry;
+    m_index->count = count + 1;
+    m_index->dirty = 0;
+}
+
+/**
+ * Queue a record for writing; returns right away
+ */
+void SessionLog::append(const SessionRecord &record) {
+    {
+        std::lock_guard<std::mutex> lock(m_pending_mutex);
+        m_pending.push_back(record);
+    }
+    m_pending_cv.notify_all();
+}
+
+/**
+ * Wait until all records passed to `append()` have been written
+ */
+void SessionLog::flush() {
+    std::unique_lock<std::mutex> lock(m_pending_mutex);
+    m_pending_cv.wait(lock, [this] { return m_pending.empty() && !m_writing; });
+}
+
+/**
+ * Append records to the log, make sure they have reached the disk and add
+ * them to the index
+ */
+void SessionLog::write(const std::vector<SessionRecord> &records) {
+    std::vector<SessionLogEntry> entries(records.size());
+    for (size_t i = 0; i < records.size(); i++) {
+        entries[i].magic = SESSION_LOG_MAGIC;
+        entries[i].record = records[i];
+        entries[i].crc = crc32(&entries[i].record, sizeof(records[i]));
+    }
+    size_t size = entries.size() * sizeof(SessionLogEntry);
+
+    std::lock_guard<std::mutex> lock(m_file_mutex);
+    if (m_broken) {
+        return;
+    }
+    if (::write(m_log_fd, entries.data(), size) != (ssize_t)size ||
+        fdatasync(m_log_fd) != 0) {
+        std::cerr << "ERROR: Couldn't write to session log " << m_path
+                  << "\n";
+        // Don't leave partial entries behind for the next records. If they
+        // stay, records appended after them would be cut off with them the
+        // next time the log is opened, so stop writing.
+        if (ftruncate(m_log_fd, (off_t)m_count * sizeof(SessionLogEntry)) !=
+            0) {
+            std::cerr << "ERROR: Couldn't repair session log " << m_path
+                      << ", no more games will be logged\n";
+            m_broken = true;
+        }
+        return;
+    }
+    for (const SessionRecord &record : records) {
+        insertIndex({record.score, record.seed, m_count});
+        m_count++;
+    }
+}
+
+/**
+ * Writer thread: write queued records until the log is destroyed
+ */
+void SessionLog::run() {
+    std::vector<SessionRecord> records;
+    std::unique_lock<std::mutex> lock(m_pending_mutex);
+    while (true) {
+        m_pending_cv.wait(lock,
+                          [this] { return m_stop || !m_pending.empty(); });
+        if (m_pending.empty()) {
+            return;
+        }
+        records.swap(m_pending);
+        m_writing = true;
+        lock.unlock();
+        write(records);
+        records.clear();
+        lock.lock();
+        m_writing = false;
+        m_pending_cv.notify_all();
+    }
+}
+
+size_t SessionLog::size() const {
+    std::lock_guard<std::mutex> lock(m_file_mutex);
+    return m_count;
+}
+
+/**
+ * Read an entry by its position in the log
+ *
+ * @return whether the entry exists and is intact
+ */
+bool SessionLog::read(uint32_t record, SessionLogEntry &entry) const {
+    return pread(m_log_fd, &entry, sizeof(entry),
+                 (off_t)record * sizeof(entry)) == sizeof(entry) &&
+           isValid(entry);
+}
+
+/**
+ * Read a record by its position in the log
+ *
+ * @return whether the record exists and is intact
+ */
+bool SessionLog::read(uint32_t record, SessionRecord &result) const {
+    SessionLogEntry entry;
+    if (!read(record, entry)) {
+        return false;
+    }
+    result = entry.record;
+    return true;
+}
+
+/**
+ * Get the `n` records with the highest scores, best first
+ */
+void SessionLog::top(size_t n, std::vector<SessionRecord> &result) const {
+    std::lock_guard<std::mutex> lock(m_file_mutex);
+    result.clear();
+    SessionRecord record;
+    for (size_t i = 0; i < std::min(n, (size_t)m_count); i++) {
+        if (read(byScore()[i].record, record)) {
+            result.push_back(record);
+        }
+    }
+}
+
+/**
+ * Get the `n` records with the highest scores among those played with `seed`,
+ * best first
+ */
+void SessionLog::topForSeed(uint32_t seed, size_t n,
+                            std::vector<SessionRecord> &result) const {
+    std::lock_guard<std::mutex> lock(m_file_mutex);
+    result.clear();
+    SessionIndexEntry key{INT32_MAX, seed, 0};
+    SessionIndexEntry *first = bySeed();
+    SessionIndexEntry *it =
+        std::lower_bound(first, first + m_count, key, lowerSeed);
+    SessionRecord record;
+    for (; it != first + m_count && it->seed == seed && result.size() < n;
+         it++) {
+        if (read(it->record, record)) {
+            result.push_back(record);
+        }
+    }
+}
@@ -0,0 +1,814 @@
+#include <cmath>
+#include <ostream>
+
+#include "events.h"
+#include "replay.h"
+#include "sim.h"
+#include "tspin.h"
+#include "zobrist.h"
+
+Simulation::Simulation() : Simulation(std::random_device{}()) {}
+
+Simulation::Simulation(uint32_t seed)
+    : m_bag(seed), playfield(PLAYFIELD_DRAW_X, PLAYFIELD_DRAW_Y),
+      active(m_bag.popQueue(), playfield) {
+    m_garbage_rng.seed(seed);
+}
+
+void Simulation::restart(cl::time_point now) {
+    restart(now, std::random_device{}());
+}
+
+void Simulation::restart(cl::time_point now, uint32_t seed) {
+    if (m_recorder) {
+        m_recorder->onRestart(now, seed, m_handling);
+    }
+    m_now = now;
+    // Reset some member variables
+    m_surface_contact = false;
+    m_soft_dropping = false;
+    m_moving_right = false;
+    m_moving_left = false;
+    m_right_held = false;
+    m_left_held = false;
+    m_last_spin = false;
+    m_last_rotation_point = 0;
+    m_held = -1;
+    m_can_hold = true;
+    m_pending_garbage = 0;
+    m_outgoing_garbage = 0;
+    m_garbage_rng.seed(seed);
+    m_n_locks = 0;
+    m_last_lock = {};
+
+    m_scoring = FixedGoalScoring(1);
+    // Schedule the first fall
+    resetFallTimer();
+    m_state = GameState::Running;
+    playfield.reset();
+    m_bag.reset(seed);
+    active.respawn(m_bag.popQueue());
+}
+
+/**
+ * Main update function, handles game logic
+ *
+ * @param now the current time
+ */
+void Simulation::update(cl::time_point now) {
+    if (m_recorder) {
+        m_recorder->onUpdate(*this, now);
+    }
+    m_now = now;
+    if (m_state != GameState::Running) {
+        return;
+    }
+
+    if (m_moving_right) {
+        repeatMove(m_next_mv_right, &Active::moveRight, now);
+    }
+    if (m_moving_left) {
+        repeatMove(m_next_mv_left, &Active::moveLeft, now);
+    }
+
+    // Check if the falling Tetromino has made surface contact; if so, schedule
+    // lock down timer
+    if (!active.canStepDown()) {
+        if (!m_surface_contact) {
+            m_surface_contact = true;
+            scheduleLockDown();
+        }
+    } else {
+        if (m_surface_contact) {
+            // No more surface contact; resume falling / soft dropping
+            m_surface_contact = false;
+            // Reset all timers
+            resetFallTimer();
+            resetSoftDropTimer();
+        }
+    }
+
+    if (m_surface_contact) {
+        if (m_lock_down < now) {
+            // Making surface contact and lock down timer has run out
+            // Lock down Tetromino and spawn a new one
+            lockDownAndRespawnActive();
+            // If possible, step down immediatly after respawning (this is
+            // according to the Tetris Guideline)
+            performFall();
+        }
+    } else {
+        if (m_soft_dropping && m_next_soft_drop < now) {
+            performSoftDrops(now);
+        } else if (m_next_fall < now) {
+            performFall();
+        }
+    }
+}
+
+/**
+ * Apply a single player input
+ *
+ * @param action the input
+ * @param now the time at which the input occurred
+ */
+void Simulation::apply(Action action, cl::time_point now) {
+    if (m_recorder) {
+        m_recorder->onAction(action, now);
+    }
+    m_now = now;
+    // Releasing keys is tracked in every state, so that no movement is stuck
+    // after unpausing
+    switch (action) {
+    case Action::MoveRightRelease:
+        m_right_held = false;
+        stopMoveRight();
+        return;
+    case Action::MoveLeftRelease:
+        m_left_held = false;
+        stopMoveLeft();
+        return;
+    case Action::SoftDropRelease:
+        m_soft_dropping = false;
+        return;
+    case Action::MoveRight:
+        m_right_held = true;
+        break;
+    case Action::MoveLeft:
+        m_left_held = true;
+        break;
+    default:
+        break;
+    }
+
+    if (m_state != GameState::Running) {
+        return;
+    }
+    switch (action) {
+    case Action::MoveRight:
+        initMoveRight();
+        m_last_spin = false;
+        break;
+    case Action::MoveLeft:
+        initMoveLeft();
+        m_last_spin = false;
+        break;
+    case Action::SoftDrop:
+        startSoftDropping();
+        m_last_spin = false;
+        break;
+    case Action::RotateClockw:
+        if (active.rotateClockw(m_last_rotation_point)) {
+            publish(GameEventType::Rotated, LockInfo{});
+        }
+        m_last_spin = true;
+        scheduleLockDown();
+        break;
+    case Action::RotateCounterclockw:
+        if (active.rotateCounterclockw(m_last_rotation_point)) {
+            publish(GameEventType::Rotated, LockInfo{});
+        }
+        m_last_spin = true;
+        scheduleLockDown();
+        break;
+    case Action::HardDrop:
+        m_scoring.onHardDrop(active.hardDrop());
+        lockDownAndRespawnActive();
+        m_last_spin = false;
+        break;
+    case Action::Hold:
+        hold();
+        m_last_spin = false;
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * Apply all inputs of one tick in ascending order of their action values
+ */
+void Simulation::apply(InputFrame_t input, cl::time_point now) {
+    for (int i = 0; i < N_ACTIONS && input; i++) {
+        if (input & actionBit((Action)i)) {
+            apply((Action)i, now);
+            input &= ~actionBit((Action)i);
+        }
+    }
+}
+
+void Simulation::pause(cl::time_point now) {
+    if (m_recorder) {
+        m_recorder->onPause(now);
+    }
+    m_now = now;
+    if (m_state == GameState::Running) {
+        m_next_fall.pause(now);
+        m_next_soft_drop.pause(now);
+        m_state = GameState::Paused;
+    }
+}
+
+void Simulation::resume(cl::time_point now) {
+    if (m_recorder) {
+        m_recorder->onResume(now);
+    }
+    m_now = now;
+    if (m_state == GameState::Paused) {
+        m_next_fall.resume(now);
+        m_next_soft_drop.resume(now);
+        m_state = GameState::Running;
+    }
+}
+
+/**
+ * Change how the Tetromino responds to held keys; takes effect with the next
+ * key press
+ */
+void Simulation::setHandling(const Handling &handling) {
+    m_handling = handling;
+}
+
+const Handling &Simulation::getHandling() const {
+    return m_handling;
+}
+
+/**
+ * Publish the events of the game to `events`, or to nowhere if it's nullptr.
+ * A Simulation that is rolled back publishes the events of the replayed steps
+ * again, so it shouldn't have an EventBus.
+ */
+void Simulation::setEventBus(EventBus *events) {
+    m_events = events;
+}
+
+/**
+ * Record every call that changes the game to `recorder`, or to nowhere if
+ * it's nullptr. Like an EventBus, a recorder doesn't go with Simulations that
+ * are rolled back.
+ */
+void Simulation::setRecorder(ReplayRecorder *recorder) {
+    m_recorder = recorder;
+}
+
+void Simulation::publish(GameEventType type, const LockInfo &lock) {
+    if (m_events) {
+        m_events->publish({type, m_now, lock, m_scoring.getLevel()});
+    }
+}
+
+GameState Simulation::getState() const {
+    return m_state;
+}
+
+/**
+ * Time of the last update or action
+ */
+cl::time_point Simulation::getTime() const {
+    return m_now;
+}
+
+const ScoringSystem &Simulation::getScoring() const {
+    return m_scoring;
+}
+
+std::array<TetrominoKind_t, QUEUE_LEN> Simulation::getQueue() {
+    return m_bag.getQueue();
+}
+
+TetrominoKind_t Simulation::getHeld() const {
+    return m_held;
+}
+
+bool Simulation::canHold() const {
+    return m_can_hold;
+}
+
+int Simulation::getLockCount() const {
+    return m_n_locks;
+}
+
+/**
+ * Get the Tetromino that was locked down last; only valid if getLockCount()
+ * is not zero
+ */
+const LockInfo &Simulation::getLastLock() const {
+    return m_last_lock;
+}
+
+/**
+ * Get the Zobrist hash of everything that matters for choosing the next
+ * placement: the Playfield, the kinds of the active, held and queued
+ * Tetrominos and the position within the current bag. The pose of the active
+ * Tetromino isn't included, since searches only care about where it locks.
+ */
+uint64_t Simulation::getHash() {
+    uint64_t hash = playfield.getHash() ^ ZOBRIST.active[active.m_type] ^
+                    ZOBRIST.bag_position[m_bag.getBagPosition()];
+    hash ^= ZOBRIST.hold[m_held == 255 ? N_TETROMINOS : m_held];
+    if (m_can_hold) {
+        hash ^= ZOBRIST.can_hold;
+    }
+    std::array<TetrominoKind_t, QUEUE_LEN> queue = m_bag.getQueue();
+    for (int i = 0; i < QUEUE_LEN; i++) {
+        hash ^= ZOBRIST.queue[i][queue[i]];
+    }
+    return hash;
+}
+
+/**
+ * Get a checksum of everything that decides how the game goes on: the
+ * Playfield, the pose of the active Tetromino, the bag, the held Tetromino,
+ * score and garbage. Two Simulations that were fed the same inputs have the
+ * same checksum after every tick, so comparing them finds the first tick in
+ * which they diverged. Takes a few nanoseconds, the Playfield's part is
+ * updated incrementally.
+ */
+uint32_t Simulation::getChecksum() {
+    uint64_t pose = (uint64_t)(uint8_t)active.m_x |
+                    (uint64_t)(uint8_t)active.m_y << 8 |
+                    (uint64_t)active.m_orientation << 16 |
+                    (uint64_t)m_state << 24 |
+                    (uint64_t)(uint32_t)m_scoring.getScore() << 32;
+    uint64_t counts = (uint64_t)(uint16_t)m_scoring.getLines() |
+                      (uint64_t)(uint16_t)m_pending_garbage << 16 |
+                      (uint64_t)(uint32_t)m_n_locks << 32;
+    uint64_t state = getHash() ^ pose;
+    uint64_t checksum = splitMix64(state) ^ counts;
+    checksum = splitMix64(checksum);
+    return (uint32_t)(checksum ^ checksum >> 32);
+}
+
+/**
+ * Print the state of the game in a form that can be compared line by line,
+ * for tracking down why two Simulations diverged
+ */
+void Simulation::dump(std::ostream &out) {
+    static const char *const KIND_NAMES = "IJLOSTZ";
+    auto kindName = [](TetrominoKind_t kind) {
+        return kind < N_TETROMINOS ? KIND_NAMES[kind] : '-';
+    };
+    out << "time " << m_now.time_since_epoch().count() << "  state "
+        << (int)m_state << "  checksum " << getChecksum() << "\n";
+    out << "score " << m_scoring.getScore() << "  lines "
+        << m_scoring.getLines() << "  level " << m_scoring.getLevel()
+        << "  locks " << m_n_locks << "  garbage " << m_pending_garbage
+        << " pending, " << m_outgoing_garbage << " outgoing\n";
+    out << "active " << kindName(active.m_type) << " at " << active.m_x << ","
+        << active.m_y << " orientation " << (int)active.m_orientation
+        << "  hold " << kindName(m_held) << (m_can_hold ? "" : " (used)")
+        << "  next ";
+    for (TetrominoKind_t kind : m_bag.getQueue()) {
+        out << kindName(kind);
+    }
+    out << "  bag position " << m_bag.getBagPosition() << "\n";
+    out << "timers: fall " << m_next_fall.get().time_since_epoch().count()
+        << "  lock " << m_lock_down.get().time_since_epoch().count()
+        << "  contact " << m_surface_contact << "  soft drop "
+        << m_soft_dropping << "  moving " << m_moving_left << m_moving_right
+        << "  held " << m_left_held << m_right_held << "\n";
+    for (int y = 0; y < GRID_SIZE_Y; y++) {
+        out << (y == GRID_START_Y ? '+' : '|');
+        for (int x = 0; x < GRID_SIZE_X; x++) {
+            TetrominoKind_t cell = playfield.getAt(x, y);
+            out << (cell == EMPTY_MINO     ? '.'
+                    : cell == GARBAGE_MINO ? '#'
+                                           : kindName(cell));
+        }
+        out << "|\n";
+    }
+}
+
+/**
+ * Start soft dropping and immediately perform first soft drop
+ */
+void Simulation::startSoftDropping() {
+    m_soft_dropping = true;
+    resetSoftDropTimer();
+    performSoftDrop();
+}
+
+/**
+ * Stop soft dropping and resume normal falling
+ */
+void Simulation::stopSoftDropping() {
+    m_soft_dropping = false;
+    resetFallTimer();
+}
+
+bool Simulation::performSoftDrop() {
+    incSoftDropTimer();
+    m_scoring.onSoftDrop();
+    return active.stepDown();
+}
+
+/**
+ * Perform all soft drop steps that are due by `now`; with a short enough
+ * delay, that can be more than one per frame
+ */
+void Simulation::performSoftDrops(cl::time_point now) {
+    do {
+        performSoftDrop();
+    } while (m_next_soft_drop < now && active.canStepDown());
+}
+
+/**
+ * Delay between two soft drop steps
+ */
+cl::duration Simulation::getSoftDropDelay() const {
+    if (std::isinf(m_handling.soft_drop_factor)) {
+        return cl::duration::zero();
+    }
+    return fromMs(m_scoring.getFallSpeedMs() / m_handling.soft_drop_factor);
+}
+
+/**
+ * Reset the soft drop timer
+ */
+void Simulation::resetSoftDropTimer() {
+    m_next_soft_drop = m_now + getSoftDropDelay();
+}
+
+/**
+ * Schedule the next soft drop
+ */
+void Simulation::incSoftDropTimer() {
+    m_next_soft_drop += getSoftDropDelay();
+}
+
+/**
+ * Move the Tetromino down by one cell and set the timer for the next fall move
+ */
+bool Simulation::performFall() {
+    incFallTimer();
+    return active.stepDown();
+}
+
+/**
+ * Reset the fall timer.
+ */
+void Simulation::resetFallTimer() {
+    m_next_fall = m_now + std::chrono::milliseconds(m_scoring.getFallSpeedMs());
+}
+
+/**
+ * Schedule the next fall
+ */
+void Simulation::incFallTimer() {
+    m_next_fall =
+        m_next_fall + std::chrono::milliseconds(m_scoring.getFallSpeedMs());
+}
+
+void Simulation::scheduleLockDown() {
+    m_lock_down = m_now + std::chrono::milliseconds(LOCK_DOWN_DELAY_MS);
+}
+
+/**
+ * Start moving the active Tetromino to the right repeatedly
+ */
+void Simulation::initMoveRight() {
+    if (!m_moving_right) {
+        m_moving_right = true;
+        m_moving_left = false;
+        moveRight();
+        // Repeated moves start after the DAS delay
+        m_next_mv_right = m_now + fromMs(m_handling.das_ms);
+    }
+}
+
+/**
+ * Stop moving the active Tetromino to the right
+ */
+void Simulation::stopMoveRight() {
+    m_moving_right = false;
+    if (m_left_held && m_state == GameState::Running) {
+        initMoveLeft();
+    }
+}
+
+/**
+ * Move the active Tetromino to the right by one cell
+ */
+void Simulation::moveRight() {
+    if (active.moveRight()) {
+        // If the move was successfull, reset Lock Down timer to give the
+        // player another 0.5 seconds to move the Tetromino before it finally
+        // sets. (This happens for all sidewards movements and rotations) Only
+        // reset lockdown timer if the move was successfull
+        scheduleLockDown();
+        publish(GameEventType::Moved, LockInfo{});
+    }
+}
+
+/**
+ * Perform all repeated moves that are due by `now`. An ARR of zero moves the
+ * Tetromino as far as possible at once.
+ *
+ * @param timer time of the next repeated move
+ * @param move moves the active Tetromino by one cell
+ */
+void Simulation::repeatMove(Timer &timer, bool (Active::*move)(),
+                            cl::time_point now) {
+    if (!(timer < now)) {
+        return;
+    }
+    cl::duration arr = fromMs(m_handling.arr_ms);
+    int64_t n_moves = INT64_MAX;
+    if (arr > cl::duration::zero()) {
+        n_moves = (now - timer.get()) / arr + 1;
+        timer += n_moves * arr;
+    } else {
+        timer = now;
+    }
+    bool moved = false;
+    for (int64_t i = 0; i < n_moves && (active.*move)(); i++) {
+        moved = true;
+    }
+    if (moved) {
+        // Reset the Lock Down timer, as for single moves
+        scheduleLockDown();
+        publish(GameEventType::Moved, LockInfo{});
+    }
+}
+
+/**
+ * Start moving the active Tetromino to the left repeatedly
+ */
+void Simulation::initMoveLeft() {
+    if (!m_moving_left) {
+        m_moving_left = true;
+        m_moving_right = false;
+        moveLeft();
+        // Repeated moves start after the DAS delay
+        m_next_mv_left = m_now + fromMs(m_handling.das_ms);
+    }
+}
+
+/**
+ * Stop moving the active Tetromino to the left
+ */
+void Simulation::stopMoveLeft() {
+    m_moving_left = false;
+    if (m_right_held && m_state == GameState::Running) {
+        initMoveRight();
+    }
+}
+
+/**
+ * Move the active Tetromino to the left by one cell
+ */
+void Simulation::moveLeft() {
+    if (active.moveLeft()) {
+        // Only reset lockdown timer if the move was successfull
+        scheduleLockDown();
+        publish(GameEventType::Moved, LockInfo{});
+    }
+}
+
+/**
+ * Put the current Tetromino in the "Hold" area and replace it with the
+ * Tetromino that is currently m_held, spawning it at the top of the Playfield
+ */
+void Simulation::hold() {
+    if (m_can_hold) {
+        // Disable hold until next piece is set
+        m_can_hold = false;
+        // 255 corrsponds to no value set
+        if (m_held == 255) {
+            // Set kind of m_held Tetromino to be the old active Tetrominos
+            // kind
+            m_held = active.m_type;
+            // Respawn Tetromino as new random kind
+            respawnActive();
+        } else {
+            // Store intermediate value
+            TetrominoKind_t active_kind = active.m_type;
+            // Set kind of respawned Tetromino to `m_held`
+            respawnActiveWithKind(m_held);
+            // Set kind of m_held Tetromino to be the old active Tetrominos
+            // kind
+            m_held = active_kind;
+        }
+        LockInfo held{};
+        held.kind = m_held;
+        publish(GameEventType::Hold, held);
+    }
+}
+
+/**
+ * Check whether the last lock down constitutes a T-Spin or a Mini T-Spin
+ *
+ * @return 2 for T-Spin, 1 for Mini T-Spin, otherwise 0
+ */
+int Simulation::checkTSpin() {
+    // Assert that the current Tetromino is a type T one and that the last input
+    // was a rotation
+    if (active.m_type != T_KIND || !m_last_spin) {
+        return NoTSpin;
+    }
+
+    // Check whether the last rotation was a T-Spin. Must be called right before
+    // lock down occurs
+    if (m_last_rotation_point == 5) {
+        return FullTSpin;
+    }
+    uint8_t corners = getCornerMask(playfield.getBitBoard(), active.m_x,
+                                    active.m_y);
+    return T_SPIN_TABLE[active.m_orientation][corners];
+}
+
+/*
+ * Lock down the falling Tetromino and clear full lines on the Playfield (or
+ * insert pending garbage if there were none), then respawn. Lines are only
+ * scored if respawning was successful.
+ */
+void Simulation::lockDownAndRespawnActive() {
+
+    int t_spin = checkTSpin();
+    m_last_lock.kind = active.m_type;
+    m_last_lock.placement = {(int8_t)active.m_x, (int8_t)active.m_y,
+                             active.m_orientation, m_last_spin};
+    active.lockDown();
+    // Garbage has to be inserted before respawning, otherwise it could be
+    // pushed into the new Tetromino
+    int cleared = playfield.clearEmptyLines();
+    m_last_lock.cleared = cleared;
+    m_last_lock.t_spin = (TSpinType)t_spin;
+    m_last_lock.attack = 0;
+    m_n_locks++;
+    if (cleared == 0) {
+        insertPendingGarbage();
+    }
+    if (respawnActive()) {
+        int level = m_scoring.getLevel();
+        switch (t_spin) {
+        case 0:
+            m_scoring.onLinesCleared(cleared);
+            m_last_lock.attack = GARBAGE_LINES[cleared];
+            break;
+        case 1:
+            m_scoring.onMiniTSpin(cleared);
+            m_last_lock.attack = GARBAGE_LINES[cleared];
+            break;
+        case 2:
+            m_scoring.onTSpin(cleared);
+            m_last_lock.attack = T_SPIN_GARBAGE_LINES[cleared];
+            break;
+        }
+        sendGarbage(m_last_lock.attack);
+        resetFallTimer();
+        publish(GameEventType::PieceLocked, m_last_lock);
+        if (cleared > 0) {
+            publish(GameEventType::LinesCleared, m_last_lock);
+        }
+        if (t_spin != NoTSpin) {
+            publish(GameEventType::TSpin, m_last_lock);
+        }
+        if (m_scoring.getLevel() > level) {
+            publish(GameEventType::LevelUp, m_last_lock);
+        }
+    }
+    // Re-enable hold
+    m_can_hold = true;
+}
+
+/*
+ * Respawn the active Tetromino, setting its kind to the next value from
+ * the queue
+ */
+bool Simulation::respawnActive() {
+    return respawnActiveWithKind(m_bag.popQueue());
+}
+
+/*
+ * Respawn the active Tetromino, settings its kind to the given value
+ */
+bool Simulation::respawnActiveWithKind(TetrominoKind_t kind) {
+    if (!active.respawn(kind)) {
+        // Block Out
+        m_state = GameState::GameOver;
+        publish(GameEventType::TopOut, m_last_lock);
+        return false;
+    }
+    // Move down own cell immediatly after respawning; this is according to
+    // the Tetromino Guideline
+    active.stepDown();
+    return true;
+}
+
+/**
+ * Send garbage lines to the opponent. Lines that are still pending on our own
+ * side are cancelled first.
+ */
+void Simulation::sendGarbage(int n_lines) {
+    int cancelled = std::min(n_lines, m_pending_garbage);
+    m_pending_garbage -= cancelled;
+    m_outgoing_garbage += n_lines - cancelled;
+}
+
+/**
+ * Insert pending garbage lines at the bottom of the Playfield. All lines
+ * inserted at once share the same hole.
+ */
+void Simulation::insertPendingGarbage() {
+    int n_lines = std::min(m_pending_garbage, GARBAGE_CAP);
+    if (n_lines == 0) {
+        return;
+    }
+    m_pending_garbage -= n_lines;
+    int hole_x = m_garbage_rng() % GRID_SIZE_X;
+    if (!playfield.addGarbage(n_lines, hole_x)) {
+        // Top Out
+        m_state = GameState::GameOver;
+        publish(GameEventType::TopOut, m_last_lock);
+    }
+}
+
+void Simulation::receiveGarbage(int n_lines) {
+    m_pending_garbage += n_lines;
+}
+
+/**
+ * Collect the garbage lines sent since the last call
+ *
+ * @return the number of lines
+ */
+int Simulation::takeOutgoingGarbage() {
+    int n_lines = m_outgoing_garbage;
+    m_outgoing_garbage = 0;
+    return n_lines;
+}
+
+int Simulation::getPendingGarbage() const {
+    return m_pending_garbage;
+}
+
+void Simulation::save(SimSnapshot &snapshot) const {
+    snapshot.state = m_state;
+    snapshot.now = m_now;
+    snapshot.playfield = playfield;
+    snapshot.active_x = active.m_x;
+    snapshot.active_y = active.m_y;
+    snapshot.active_orientation = active.m_orientation;
+    snapshot.active_type = active.m_type;
+    snapshot.bag = m_bag;
+    snapshot.scoring = m_scoring;
+    snapshot.next_fall = m_next_fall.get();
+    snapshot.next_soft_drop = m_next_soft_drop.get();
+    snapshot.lock_down = m_lock_down.get();
+    snapshot.next_mv_right = m_next_mv_right.get();
+    snapshot.next_mv_left = m_next_mv_left.get();
+    snapshot.soft_dropping = m_soft_dropping;
+    snapshot.surface_contact = m_surface_contact;
+    snapshot.moving_right = m_moving_right;
+    snapshot.moving_left = m_moving_left;
+    snapshot.right_held = m_right_held;
+    snapshot.left_held = m_left_held;
+    snapshot.last_rotation_point = m_last_rotation_point;
+    snapshot.last_spin = m_last_spin;
+    snapshot.held = m_held;
+    snapshot.can_hold = m_can_hold;
+    snapshot.pending_garbage = m_pending_garbage;
+    snapshot.outgoing_garbage = m_outgoing_garbage;
+    snapshot.garbage_rng = m_garbage_rng;
+    snapshot.n_locks = m_n_locks;
+    snapshot.last_lock = m_last_lock;
+}
+
+void Simulation::load(const SimSnapshot &snapshot) {
+    m_state = snapshot.state;
+    m_now = snapshot.now;
+    playfield = snapshot.playfield;
+    active.m_x = snapshot.active_x;
+    active.m_y = snapshot.active_y;
+    active.m_orientation = snapshot.active_orientation;
+    active.m_type = snapshot.active_type;
+    m_bag = snapshot.bag;
+    m_scoring = snapshot.scoring;
+    m_next_fall = snapshot.next_fall;
+    m_next_soft_drop = snapshot.next_soft_drop;
+    m_lock_down = snapshot.lock_down;
+    m_next_mv_right = snapshot.next_mv_right;
+    m_next_mv_left = snapshot.next_mv_left;
+    m_soft_dropping = snapshot.soft_dropping;
+    m_surface_contact = snapshot.surface_contact;
+    m_moving_right = snapshot.moving_right;
+    m_moving_left = snapshot.moving_left;
+    m_right_held = snapshot.right_held;
+    m_left_held = snapshot.left_held;
+    m_last_rotation_point = snapshot.last_rotation_point;
+    m_last_spin = snapshot.last_spin;
+    m_held = snapshot.held;
+    m_can_hold = snapshot.can_hold;
+    m_pending_garbage = snapshot.pending_garbage;
+    m_outgoing_garbage = snapshot.outgoing_garbage;
+    m_garbage_rng = snapshot.garbage_rng;
+    m_n_locks = snapshot.n_locks;
+    m_last_lock = snapshot.last_lock;
+}
+
+void Simulation::draw(SDL_Renderer *renderer) {
+    playfield.draw(renderer);
+    active.drawGhost(renderer);
+    active.draw(renderer);
+}
@@ -0,0 +1,111 @@
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#include "fcntl.h"
+#include "sys/mman.h"
+#include "unistd.h"
+
+#include "stateexport.h"
+
+// Attempts of a reader to get a consistent copy before giving up
+static const int STATE_READ_ATTEMPTS = 1000;
+
+/**
+ * Create the segment `name` (a name starting with '/', see shm_open), or take
+ * over an existing one
+ *
+ * @throws std::runtime_error if the segment can't be created
+ */
+StateExport::StateExport(const std::string &name) : m_name(name) {
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Couldn't create shared memory " + name);
+    }
+    if (ftruncate(fd, sizeof(StateSegment)) != 0) {
+        close(fd);
+        shm_unlink(name.c_str());
+        throw std::runtime_error("Couldn't resize shared memory " + name);
+    }
+    void *memory = mmap(nullptr, sizeof(StateSegment), PROT_READ | PROT_WRITE,
+                        MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        throw std::runtime_error("Couldn't map shared memory " + name);
+    }
+    // Readers ignore the segment until the magic number is in place
+    m_segment = static_cast<StateSegment *>(memory);
+    m_segment->magic = 0;
+    m_segment->size = sizeof(StateSegment);
+    new (&m_segment->sequence) std::atomic<uint32_t>(0);
+    std::memset(&m_segment->state, 0, sizeof(ExportedState));
+    std::atomic_thread_fence(std::memory_order_release);
+    m_segment->magic = STATE_EXPORT_MAGIC;
+}
+
+StateExport::~StateExport() {
+    munmap(m_segment, sizeof(StateSegment));
+    shm_unlink(m_name.c_str());
+}
+
+/**
+ * Replace the published state; `tick` is filled in here
+ */
+void StateExport::publish(const ExportedState &state) {
+    uint32_t sequence = m_segment->sequence.load(std::memory_order_relaxed);
+    m_segment->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&m_segment->state, &state, sizeof(ExportedState));
+    m_segment->state.tick = ++m_tick;
+    m_segment->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+/**
+ * Open the segment of a running game
+ *
+ * @throws std::runtime_error if there is no such segment or it has another
+ *         layout
+ */
+StateExportReader::StateExportReader(const std::string &name) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Couldn't open shared memory " + name);
+    }
+    void *memory =
+        mmap(nullptr, sizeof(StateSegment), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        throw std::runtime_error("Couldn't map shared memory " + name);
+    }
+    m_segment = static_cast<const StateSegment *>(memory);
+    if (m_segment->magic != STATE_EXPORT_MAGIC ||
+        m_segment->size != sizeof(StateSegment)) {
+        munmap(memory, sizeof(StateSegment));
+        throw std::runtime_error(name + " has an unknown layout");
+    }
+}
+
+StateExportReader::~StateExportReader() {
+    munmap(const_cast<StateSegment *>(m_segment), sizeof(StateSegment));
+}
+
+/**
+ * Copy the current state, retrying while the game is writing it
+ *
+ * @return false if no consistent copy could be made
+ */
+bool StateExportReader::read(ExportedState &state) const {
+    for (int attempt = 0; attempt < STATE_READ_ATTEMPTS; attempt++) {
+        uint32_t before = m_segment->sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+        std::memcpy(&state, &m_segment->state, sizeof(ExportedState));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_segment->sequence.load(std::memory_order_relaxed) == before) {
+            return true;
+        }
+    }
+    return false;
+}
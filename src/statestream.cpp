@@ -0,0 +1,621 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#include "sys/socket.h"
+#include "unistd.h"
+
+#include "bitboard.h"
+#include "statestream.h"
+
+namespace {
+
+void putVarint(std::vector<uint8_t> &out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((uint8_t)value);
+}
+
+void putSignedVarint(std::vector<uint8_t> &out, int64_t value) {
+    putVarint(out, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+bool isEmptyRow(const uint8_t *row) {
+    return std::all_of(row, row + GRID_SIZE_X,
+                       [](uint8_t cell) { return cell == EMPTY_MINO; });
+}
+
+bool samePieces(const ExportedState &a, const ExportedState &b) {
+    return a.active_kind == b.active_kind && a.can_hold == b.can_hold &&
+           a.held == b.held &&
+           std::equal(a.queue, a.queue + QUEUE_LEN, b.queue);
+}
+
+bool samePose(const ExportedState &a, const ExportedState &b) {
+    return a.active_x == b.active_x && a.active_y == b.active_y &&
+           a.active_orientation == b.active_orientation;
+}
+
+// Fields of STREAM_STATS, in the order of their bits
+int32_t ExportedState::*const STREAM_STATS_FIELDS[] = {
+    &ExportedState::score, &ExportedState::lines, &ExportedState::level,
+    &ExportedState::pieces, &ExportedState::pending_garbage};
+
+uint8_t changedStats(const ExportedState &a, const ExportedState &b) {
+    uint8_t changed = 0;
+    for (int i = 0; i < 5; i++) {
+        if (a.*STREAM_STATS_FIELDS[i] != b.*STREAM_STATS_FIELDS[i]) {
+            changed |= 1 << i;
+        }
+    }
+    return changed;
+}
+
+uint8_t packPose(int x, int orientation) {
+    return (uint8_t)((x + 4) | orientation << 6);
+}
+
+BitBoard toBitBoard(const ExportedState &state) {
+    BitBoard board;
+    for (int y = 0; y < GRID_SIZE_Y; y++) {
+        for (int x = 0; x < GRID_SIZE_X; x++) {
+            if (state.cells[y][x] != EMPTY_MINO) {
+                board.rows[y] |= (BitRow_t)1 << x;
+            }
+        }
+    }
+    return board;
+}
+
+/**
+ * Where the active Tetromino of a state would land; writer and viewers must
+ * agree on this, since it isn't sent
+ */
+int ghostY(const ExportedState &state) {
+    if (state.active_kind >= N_TETROMINOS || state.active_x < -3 ||
+        state.active_x >= GRID_SIZE_X) {
+        return state.active_y;
+    }
+    BitBoard board = toBitBoard(state);
+    if (!board.fits(state.active_kind, state.active_orientation,
+                    state.active_x, state.active_y)) {
+        return state.active_y;
+    }
+    return board.dropY(state.active_kind, state.active_orientation,
+                       state.active_x, state.active_y);
+}
+
+/**
+ * Lock the active Tetromino down at the given pose and bring out the next
+ * one, as described for STREAM_LOCK
+ *
+ * @return false if it doesn't fit there
+ */
+bool applyLock(ExportedState &state, uint8_t x_orientation, uint8_t y) {
+    int x = (x_orientation & 0x3f) - 4;
+    int orientation = x_orientation >> 6;
+    if (state.active_kind >= N_TETROMINOS || x < -3 || x >= GRID_SIZE_X ||
+        !toBitBoard(state).fits(state.active_kind, orientation, x, y)) {
+        return false;
+    }
+    forEachMino(getPieceMask(state.active_kind, orientation),
+                [&](int col, int row) {
+                    state.cells[y + row][x + col] = state.active_kind;
+                });
+    // Like the Playfield, only clear visible rows
+    int to = GRID_SIZE_Y - 1;
+    for (int from = GRID_SIZE_Y - 1; from >= 0; from--) {
+        bool full = std::none_of(
+            state.cells[from], state.cells[from] + GRID_SIZE_X,
+            [](uint8_t cell) { return cell == EMPTY_MINO; });
+        if (from < GRID_START_Y || !full) {
+            std::memmove(state.cells[to--], state.cells[from], GRID_SIZE_X);
+        }
+    }
+    for (; to >= 0; to--) {
+        std::memset(state.cells[to], EMPTY_MINO, GRID_SIZE_X);
+    }
+
+    state.active_kind = state.queue[0];
+    std::copy(state.queue + 1, state.queue + QUEUE_LEN, state.queue);
+    state.active_x = STARTING_POSITION_X;
+    state.active_y = STARTING_POSITION_Y;
+    state.active_orientation = 0;
+    state.can_hold = 1;
+    state.pieces++;
+    return true;
+}
+
+/*
+ * Reads the fields of a frame, failing instead of reading past its end
+ */
+struct FrameReader {
+    const uint8_t *pos;
+    const uint8_t *end;
+
+    bool byte(uint8_t &value) {
+        if (pos == end) {
+            return false;
+        }
+        value = *pos++;
+        return true;
+    }
+
+    bool varint(uint64_t &value) {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t b;
+            if (!byte(b)) {
+                return false;
+            }
+            value |= (uint64_t)(b & 0x7f) << shift;
+            if (!(b & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool signedVarint(int64_t &value) {
+        uint64_t raw;
+        if (!varint(raw)) {
+            return false;
+        }
+        value = (int64_t)(raw >> 1) ^ -(int64_t)(raw & 1);
+        return true;
+    }
+};
+
+} // namespace
+
+/**
+ * Write to a file, or to the Unix datagram socket of a viewer if the
+ * destination is "unix:<path>"
+ *
+ * @throws std::runtime_error if the destination can't be opened
+ */
+StateStreamWriter::StateStreamWriter(const std::string &destination) {
+    if (destination.rfind("unix:", 0) == 0) {
+        std::string path = destination.substr(5);
+        if (path.empty() || path.size() >= sizeof(m_peer.sun_path)) {
+            throw std::runtime_error("Invalid socket path: " + path);
+        }
+        m_peer.sun_family = AF_UNIX;
+        std::strcpy(m_peer.sun_path, path.c_str());
+        m_socket = socket(AF_UNIX, SOCK_DGRAM, 0);
+        if (m_socket < 0) {
+            throw std::runtime_error("Couldn't create socket");
+        }
+    } else {
+        m_file = std::fopen(destination.c_str(), "wb");
+        if (!m_file) {
+            throw std::runtime_error("Couldn't open " + destination);
+        }
+        uint8_t magic[4];
+        for (int i = 0; i < 4; i++) {
+            magic[i] = (uint8_t)(STATE_STREAM_MAGIC >> (8 * i));
+        }
+        std::fwrite(magic, 1, sizeof(magic), m_file);
+        m_bytes += sizeof(magic);
+        m_writer = std::thread(&StateStreamWriter::run, this);
+    }
+    m_frame.reserve(STATE_STREAM_MAX_FRAME);
+}
+
+StateStreamWriter::~StateStreamWriter() {
+    if (m_file) {
+        {
+            std::lock_guard<std::mutex> lock(m_pending_mutex);
+            m_stop = true;
+        }
+        m_pending_cv.notify_all();
+        m_writer.join();
+        std::fclose(m_file);
+    }
+    if (m_socket >= 0) {
+        close(m_socket);
+    }
+}
+
+/**
+ * Find the pose at which the active Tetromino the viewers know of locked down
+ * to give the board of `state`, trying where it was last seen first
+ *
+ * @return false if the board didn't change by a Tetromino locking down
+ */
+bool StateStreamWriter::findLock(const ExportedState &state,
+                                 uint8_t pose[2]) const {
+    if (state.pieces != m_last.pieces + 1 ||
+        m_last.active_kind >= N_TETROMINOS) {
+        return false;
+    }
+    auto matches = [&](int x, int orientation, int y) {
+        ExportedState locked = m_last;
+        pose[0] = packPose(x, orientation);
+        pose[1] = (uint8_t)y;
+        return applyLock(locked, pose[0], pose[1]) &&
+               std::memcmp(locked.cells, state.cells, sizeof(state.cells)) ==
+                   0;
+    };
+    if (matches(m_previous.active_x, m_previous.active_orientation,
+                m_previous.ghost_y)) {
+        return true;
+    }
+    BitBoard board = toBitBoard(m_last);
+    for (int orientation = 0; orientation < 4; orientation++) {
+        for (int x = -3; x < GRID_SIZE_X; x++) {
+            if (board.fits(m_last.active_kind, orientation, x,
+                           STARTING_POSITION_Y) &&
+                matches(x, orientation,
+                        board.dropY(m_last.active_kind, orientation, x,
+                                    STARTING_POSITION_Y))) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * Write a frame with whatever changed since the last one, if anything did.
+ * Should be called once per tick; `tick` and `ghost_y` of the state are
+ * ignored.
+ */
+void StateStreamWriter::write(const ExportedState &state) {
+    int64_t now_ms = state.time_ns / 1000000;
+    bool keyframe =
+        !m_started || now_ms - m_last_keyframe_ms >= STATE_STREAM_KEYFRAME_MS;
+
+    // Build the frame while updating the viewers' state the way they will
+    if (keyframe) {
+        m_last = ExportedState{};
+        std::memset(m_last.cells, EMPTY_MINO, sizeof(m_last.cells));
+    }
+    // Leave room in front for the length, which is known at the end
+    m_frame.assign(2, 0);
+    m_frame.push_back(m_sequence + 1);
+    m_frame.push_back(0);
+    putVarint(m_frame, keyframe ? now_ms
+                                : std::max<int64_t>(now_ms - m_last_ms, 0));
+    uint8_t flags = 0;
+
+    uint8_t pose[2];
+    if (!keyframe &&
+        std::memcmp(state.cells, m_last.cells, sizeof(state.cells)) != 0 &&
+        findLock(state, pose)) {
+        flags |= STREAM_LOCK;
+        m_frame.insert(m_frame.end(), pose, pose + 2);
+        applyLock(m_last, pose[0], pose[1]);
+    }
+
+    uint64_t rows = 0;
+    for (int y = 0; y < GRID_SIZE_Y; y++) {
+        if (std::memcmp(state.cells[y], m_last.cells[y], GRID_SIZE_X) != 0) {
+            rows |= (uint64_t)1 << (GRID_SIZE_Y - 1 - y);
+        }
+    }
+    if (keyframe || rows) {
+        flags |= STREAM_ROWS;
+        putVarint(m_frame, rows);
+        for (int y = 0; y < GRID_SIZE_Y; y++) {
+            if (!(rows & ((uint64_t)1 << (GRID_SIZE_Y - 1 - y)))) {
+                continue;
+            }
+            const uint8_t *row = state.cells[y];
+            uint8_t tag = STREAM_ROW_LITERAL;
+            if (isEmptyRow(row)) {
+                tag = STREAM_ROW_EMPTY;
+            } else if (!keyframe) {
+                for (int up = 1; up <= 4 && y - up >= 0; up++) {
+                    if (std::memcmp(row, m_last.cells[y - up], GRID_SIZE_X) ==
+                        0) {
+                        tag = up;
+                        break;
+                    }
+                }
+            }
+            m_frame.push_back(tag);
+            if (tag == STREAM_ROW_LITERAL) {
+                for (int x = 0; x < GRID_SIZE_X; x += 2) {
+                    m_frame.push_back(row[x] | row[x + 1] << 4);
+                }
+            }
+        }
+        std::memcpy(m_last.cells, state.cells, sizeof(state.cells));
+    }
+
+    if (keyframe || !samePieces(state, m_last)) {
+        // After a lock, usually only the end of the queue is new
+        ExportedState next = m_last;
+        next.queue[QUEUE_LEN - 1] = state.queue[QUEUE_LEN - 1];
+        if ((flags & STREAM_LOCK) && samePieces(state, next)) {
+            flags |= STREAM_NEXT;
+            m_frame.push_back(state.queue[QUEUE_LEN - 1]);
+        } else {
+            flags |= STREAM_PIECES;
+            m_frame.push_back(state.active_kind | state.can_hold << 7);
+            m_frame.push_back(state.held);
+            m_frame.insert(m_frame.end(), state.queue,
+                           state.queue + QUEUE_LEN);
+        }
+        m_last.active_kind = state.active_kind;
+        m_last.can_hold = state.can_hold;
+        m_last.held = state.held;
+        std::copy(state.queue, state.queue + QUEUE_LEN, m_last.queue);
+    }
+
+    // Moves and score changes ride along with other changes, or wait until
+    // enough time has passed since the last ones
+    bool minor = keyframe || flags || state.state != m_last.state ||
+                 now_ms - m_last_minor_ms >= STATE_STREAM_MINOR_MS;
+    if (minor && (keyframe || !samePose(state, m_last))) {
+        flags |= STREAM_POSE;
+        m_frame.push_back(packPose(state.active_x, state.active_orientation));
+        m_frame.push_back(state.active_y);
+        m_last.active_x = state.active_x;
+        m_last.active_y = state.active_y;
+        m_last.active_orientation = state.active_orientation;
+    }
+    uint8_t stats = changedStats(state, m_last);
+    if (minor && (keyframe || stats)) {
+        flags |= STREAM_STATS;
+        m_frame.push_back(stats);
+        for (int i = 0; i < 5; i++) {
+            int32_t ExportedState::*field = STREAM_STATS_FIELDS[i];
+            if (stats & (1 << i)) {
+                putSignedVarint(m_frame,
+                                (int64_t)(state.*field) - m_last.*field);
+                m_last.*field = state.*field;
+            }
+        }
+    }
+    if (keyframe || state.state != m_last.state) {
+        flags |= STREAM_STATE;
+        m_frame.push_back(state.state);
+        m_last.state = state.state;
+    }
+    m_previous = state;
+
+    if (!flags) {
+        return;
+    }
+    if (keyframe) {
+        flags |= STREAM_KEYFRAME;
+    }
+    m_frame[3] = flags;
+    send();
+
+    m_started = true;
+    m_sequence++;
+    m_last_ms = now_ms;
+    if (keyframe) {
+        m_last_keyframe_ms = now_ms;
+    }
+    if (minor) {
+        m_last_minor_ms = now_ms;
+    }
+}
+
+/**
+ * Put the length in front of a frame built after two reserved bytes and
+ * send it to the viewer, or queue it for the file. Datagrams that can't be
+ * sent right away are dropped; the next keyframe makes up for them.
+ */
+void StateStreamWriter::send() {
+    size_t len = m_frame.size() - 2;
+    uint8_t *data = m_frame.data();
+    size_t start;
+    if (len < 0x80) {
+        start = 1;
+        data[1] = (uint8_t)len;
+    } else {
+        start = 0;
+        data[0] = (uint8_t)(len | 0x80);
+        data[1] = (uint8_t)(len >> 7);
+    }
+    size_t size = m_frame.size() - start;
+    if (m_file) {
+        std::lock_guard<std::mutex> lock(m_pending_mutex);
+        m_pending.insert(m_pending.end(), data + start, data + start + size);
+    } else if (sendto(m_socket, data + start, size, MSG_DONTWAIT,
+                      (sockaddr *)&m_peer, sizeof(m_peer)) != (ssize_t)size) {
+        return;
+    }
+    m_bytes += size;
+}
+
+/**
+ * Writer thread: write the queued frames to the file and flush it every
+ * STATE_STREAM_FLUSH_MS, so that the game thread never waits for the disk
+ * and viewers following the file still see frames soon after they happen
+ */
+void StateStreamWriter::run() {
+    std::vector<uint8_t> frames;
+    std::unique_lock<std::mutex> lock(m_pending_mutex);
+    while (true) {
+        bool stop = m_pending_cv.wait_for(
+            lock, std::chrono::milliseconds(STATE_STREAM_FLUSH_MS),
+            [this] { return m_stop; });
+        frames.swap(m_pending);
+        lock.unlock();
+        if (!frames.empty()) {
+            std::fwrite(frames.data(), 1, frames.size(), m_file);
+            std::fflush(m_file);
+            frames.clear();
+        }
+        lock.lock();
+        if (stop) {
+            return;
+        }
+    }
+}
+
+uint64_t StateStreamWriter::getBytesWritten() const {
+    return m_bytes;
+}
+
+/**
+ * Read the length in front of a frame
+ *
+ * @param header set to the size of the length itself
+ * @param frame_len set to the length of the frame after it
+ * @return false if `data` doesn't hold the whole length yet
+ */
+bool readStreamFrameLength(const uint8_t *data, size_t len, size_t &header,
+                           size_t &frame_len) {
+    FrameReader reader{data, data + std::min<size_t>(len, 2)};
+    uint64_t value;
+    if (!reader.varint(value)) {
+        return false;
+    }
+    header = reader.pos - data;
+    frame_len = value;
+    return true;
+}
+
+/**
+ * Apply a frame, without the length in front of it. Frames are ignored until
+ * the first keyframe, and again after a frame went missing until the next
+ * one.
+ *
+ * @return false if the frame was ignored or is malformed
+ */
+bool StateStreamDecoder::apply(const uint8_t *frame, size_t len) {
+    FrameReader reader{frame, frame + len};
+    uint8_t sequence, flags;
+    if (!reader.byte(sequence) || !reader.byte(flags)) {
+        return false;
+    }
+    bool keyframe = flags & STREAM_KEYFRAME;
+    if (!keyframe && (!m_synced || sequence != (uint8_t)(m_sequence + 1))) {
+        m_synced = false;
+        return false;
+    }
+
+    // Changes go to a copy, so that a malformed frame leaves the state alone
+    ExportedState state = keyframe ? ExportedState{} : m_state;
+    if (keyframe) {
+        std::memset(state.cells, EMPTY_MINO, sizeof(state.cells));
+    }
+    uint64_t ms;
+    if (!reader.varint(ms)) {
+        return false;
+    }
+    state.tick = m_frames + 1;
+    int64_t time_ms = keyframe ? (int64_t)ms : m_time_ms + (int64_t)ms;
+    state.time_ns = time_ms * 1000000;
+
+    if (flags & STREAM_LOCK) {
+        uint8_t pose[2];
+        if (keyframe || !reader.byte(pose[0]) || !reader.byte(pose[1]) ||
+            !applyLock(state, pose[0], pose[1])) {
+            return false;
+        }
+    }
+    if (flags & STREAM_ROWS) {
+        // Rows are copied as they were before this section
+        ExportedState base = state;
+        uint64_t rows;
+        if (!reader.varint(rows) || rows >> GRID_SIZE_Y) {
+            return false;
+        }
+        for (int y = 0; y < GRID_SIZE_Y; y++) {
+            if (!(rows & ((uint64_t)1 << (GRID_SIZE_Y - 1 - y)))) {
+                continue;
+            }
+            uint8_t tag;
+            if (!reader.byte(tag)) {
+                return false;
+            }
+            if (tag == STREAM_ROW_LITERAL) {
+                for (int x = 0; x < GRID_SIZE_X; x += 2) {
+                    uint8_t cells;
+                    if (!reader.byte(cells)) {
+                        return false;
+                    }
+                    state.cells[y][x] = cells & 0xf;
+                    state.cells[y][x + 1] = cells >> 4;
+                }
+            } else if (tag == STREAM_ROW_EMPTY) {
+                std::memset(state.cells[y], EMPTY_MINO, GRID_SIZE_X);
+            } else if (!keyframe && tag <= 4 && y - tag >= 0) {
+                std::memcpy(state.cells[y], base.cells[y - tag], GRID_SIZE_X);
+            } else {
+                return false;
+            }
+        }
+    }
+    if (flags & STREAM_NEXT) {
+        if (!(flags & STREAM_LOCK) || (flags & STREAM_PIECES) ||
+            !reader.byte(state.queue[QUEUE_LEN - 1])) {
+            return false;
+        }
+    }
+    if (flags & STREAM_PIECES) {
+        uint8_t active;
+        if (!reader.byte(active) || !reader.byte(state.held)) {
+            return false;
+        }
+        state.active_kind = active & 0x7f;
+        state.can_hold = active >> 7;
+        for (int i = 0; i < QUEUE_LEN; i++) {
+            if (!reader.byte(state.queue[i])) {
+                return false;
+            }
+        }
+    }
+    if (flags & STREAM_POSE) {
+        uint8_t x, y;
+        if (!reader.byte(x) || !reader.byte(y)) {
+            return false;
+        }
+        state.active_x = (x & 0x3f) - 4;
+        state.active_orientation = x >> 6;
+        state.active_y = y;
+    }
+    if (flags & STREAM_STATS) {
+        uint8_t changed;
+        if (!reader.byte(changed)) {
+            return false;
+        }
+        for (int i = 0; i < 5; i++) {
+            int64_t delta;
+            if (!(changed & (1 << i))) {
+                continue;
+            }
+            if (!reader.signedVarint(delta)) {
+                return false;
+            }
+            state.*STREAM_STATS_FIELDS[i] += delta;
+        }
+    }
+    if ((flags & STREAM_STATE) && !reader.byte(state.state)) {
+        return false;
+    }
+    if (reader.pos != reader.end) {
+        return false;
+    }
+    state.ghost_y = ghostY(state);
+
+    m_state = state;
+    m_frames++;
+    m_time_ms = time_ms;
+    m_sequence = sequence;
+    m_synced = true;
+    return true;
+}
+
+bool StateStreamDecoder::isSynced() const {
+    return m_synced;
+}
+
+const ExportedState &StateStreamDecoder::getState() const {
+    return m_state;
+}
+
+int64_t StateStreamDecoder::getTimeMs() const {
+    return m_time_ms;
+}
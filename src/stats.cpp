@@ -0,0 +1,209 @@
+#include <algorithm>
+
+#include "stats.h"
+
+LiveStats::LiveStats() {
+    reset(cl::time_point{});
+}
+
+/**
+ * Clear all statistics; the game starts at `now`
+ */
+void LiveStats::reset(cl::time_point now) {
+    m_window_begin = 0;
+    m_window_keys = 0;
+    m_window_attack = 0;
+    m_window_start = cl::duration::zero();
+    m_start = now;
+    m_paused = cl::duration::zero();
+    m_is_paused = false;
+    m_time = cl::duration::zero();
+    m_pieces = 0;
+    m_keys = 0;
+    m_attack = 0;
+    m_lines = 0;
+    m_piece_keys = 0;
+    m_clears = {};
+    m_t_spins = {};
+    m_perfect_clears = 0;
+    m_finesse_faults = 0;
+}
+
+cl::duration LiveStats::playTime(cl::time_point now) const {
+    if (m_is_paused) {
+        now = m_pause_start;
+    }
+    return now - m_start - m_paused;
+}
+
+/**
+ * Advance the play time and drop lock downs that have left the window
+ */
+void LiveStats::update(cl::time_point now) {
+    m_time = playTime(now);
+    expire();
+}
+
+void LiveStats::expire() {
+    m_window_start = std::max(m_window_start,
+                              m_time - std::chrono::milliseconds(
+                                           STATS_WINDOW_MS));
+    while (m_window_begin < m_pieces) {
+        const LockEvent &event = m_history[m_window_begin % STATS_HISTORY];
+        if (event.time > m_window_start) {
+            break;
+        }
+        m_window_keys -= event.keys;
+        m_window_attack -= event.attack;
+        m_window_begin++;
+    }
+}
+
+void LiveStats::pause(cl::time_point now) {
+    if (m_is_paused) {
+        return;
+    }
+    m_pause_start = now;
+    m_is_paused = true;
+}
+
+void LiveStats::resume(cl::time_point now) {
+    if (!m_is_paused) {
+        return;
+    }
+    m_paused += now - m_pause_start;
+    m_is_paused = false;
+}
+
+/**
+ * Count a key press; releases aren't counted
+ */
+void LiveStats::onAction(Action action) {
+    switch (action) {
+    case Action::MoveLeftRelease:
+    case Action::MoveRightRelease:
+    case Action::SoftDropRelease:
+        return;
+    default:
+        m_keys++;
+        m_piece_keys++;
+    }
+}
+
+/**
+ * Count a lock down
+ *
+ * @param lock the Tetromino that was locked down
+ * @param perfect_clear whether the Playfield is empty afterwards
+ * @param extra_inputs keys pressed in excess of the optimal finesse
+ * @param now time of the lock down
+ */
+void LiveStats::onLock(const LockInfo &lock, bool perfect_clear,
+                       int extra_inputs, cl::time_point now) {
+    m_time = playTime(now);
+    // The history is full; the window can't reach back further than the
+    // lock down that is about to be overwritten
+    if (m_pieces - m_window_begin == STATS_HISTORY) {
+        const LockEvent &oldest = m_history[m_window_begin % STATS_HISTORY];
+        m_window_start = std::max(m_window_start, oldest.time);
+    }
+    expire();
+
+    m_history[m_pieces % STATS_HISTORY] = {m_time, m_piece_keys, lock.attack};
+    m_window_keys += m_piece_keys;
+    m_window_attack += lock.attack;
+    m_pieces++;
+    m_piece_keys = 0;
+
+    m_attack += lock.attack;
+    m_lines += lock.cleared;
+    if (lock.t_spin == NoTSpin) {
+        m_clears[lock.cleared]++;
+    } else {
+        m_t_spins[lock.t_spin - 1][lock.cleared]++;
+    }
+    if (perfect_clear) {
+        m_perfect_clears++;
+    }
+    if (extra_inputs > 0) {
+        m_finesse_faults++;
+    }
+}
+
+StatsRates LiveStats::rates(int pieces, int keys, int attack,
+                            cl::duration time) {
+    double seconds = std::chrono::duration<double>(time).count();
+    if (seconds <= 0) {
+        return {0, 0, 0};
+    }
+    return {pieces / seconds, attack * 60 / seconds,
+            pieces > 0 ? (double)keys / pieces : 0};
+}
+
+double LiveStats::getSeconds() const {
+    return std::chrono::duration<double>(m_time).count();
+}
+
+int LiveStats::getPieces() const {
+    return m_pieces;
+}
+
+int LiveStats::getKeys() const {
+    return m_keys;
+}
+
+int LiveStats::getAttack() const {
+    return m_attack;
+}
+
+int LiveStats::getClears(int n_lines) const {
+    return m_clears[n_lines];
+}
+
+int LiveStats::getTSpins(TSpinType type, int n_lines) const {
+    return m_t_spins[type - 1][n_lines];
+}
+
+int LiveStats::getPerfectClears() const {
+    return m_perfect_clears;
+}
+
+int LiveStats::getFinesseFaults() const {
+    return m_finesse_faults;
+}
+
+StatsRates LiveStats::getTotalRates() const {
+    return rates(m_pieces, m_keys, m_attack, m_time);
+}
+
+/**
+ * Rates over the last STATS_WINDOW_MS of play, or less at the start of a game
+ */
+StatsRates LiveStats::getWindowRates() const {
+    return rates(m_pieces - m_window_begin, m_window_keys, m_window_attack,
+                 m_time - m_window_start);
+}
+
+/**
+ * Write the statistics as a single line of JSON
+ */
+void LiveStats::write(std::ostream &out) const {
+    StatsRates total = getTotalRates();
+    out << "{\"seconds\":" << getSeconds() << ",\"pieces\":" << m_pieces
+        << ",\"keys\":" << m_keys << ",\"lines\":" << m_lines
+        << ",\"attack\":" << m_attack << ",\"pps\":" << total.pps
+        << ",\"apm\":" << total.apm << ",\"kpp\":" << total.kpp
+        << ",\"finesse_faults\":" << m_finesse_faults
+        << ",\"perfect_clears\":" << m_perfect_clears << ",\"clears\":[";
+    for (int i = 0; i < (int)m_clears.size(); i++) {
+        out << (i > 0 ? "," : "") << m_clears[i];
+    }
+    const char *names[] = {"mini_t_spins", "t_spins"};
+    for (int type = 0; type < 2; type++) {
+        out << "],\"" << names[type] << "\":[";
+        for (int i = 0; i < (int)m_t_spins[type].size(); i++) {
+            out << (i > 0 ? "," : "") << m_t_spins[type][i];
+        }
+    }
+    out << "]}\n";
+}
@@ -5,14 +5,13 @@ TetroVisual::TetroVisual(TetrominoKind_t kind) {
     setKind(kind);
 }
 
-void TetroVisual::loadGrid() {
-    m_grid = TETROMINOS[m_kind];
-}
-
 void TetroVisual::setKind(TetrominoKind_t kind) {
     m_kind = kind;
+    // No kind set; nothing to load
+    if (m_kind == 255) {
+        return;
+    }
     m_color = TETROMINO_COLORS[m_kind];
-    loadGrid();
 }
 
 TetrominoKind_t TetroVisual::getKind() {
@@ -24,13 +23,9 @@ void TetroVisual::draw(SDL_Renderer *renderer, int x, int y) {
     if (m_kind == 255) {
         return;
     }
-    for (int row = 0; row < 4; row++) {
-        for (int col = 0; col < 4; col++) {
-            if (m_grid[row][col]) {
-                drawMino(renderer, x + col * CELL_SIZE, y + row * CELL_SIZE);
-            }
-        }
-    }
+    forEachMino(getPieceMask(m_kind, 0), [&](int col, int row) {
+        drawMino(renderer, x + col * CELL_SIZE, y + row * CELL_SIZE);
+    });
 }
 
 void TetroVisual::drawMino(SDL_Renderer *renderer, int x, int y) {
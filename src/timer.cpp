@@ -18,13 +18,21 @@ bool Timer::hasPassed() const {
 }
 
 void Timer::pause() {
+    pause(cl::now());
+}
+
+void Timer::pause(cl::time_point now) {
     m_paused = true;
-    m_delta = m_next - cl::now();
+    m_delta = m_next - now;
 }
 
 void Timer::resume() {
+    resume(cl::now());
+}
+
+void Timer::resume(cl::time_point now) {
     m_paused = false;
-    m_next = cl::now() + m_delta;
+    m_next = now + m_delta;
 }
 
 bool Timer::isPaused() const {
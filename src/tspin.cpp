@@ -0,0 +1,99 @@
+#include <algorithm>
+
+#include "tspin.h"
+
+namespace {
+
+// Rows with one column of wall on each side, so that the walls and the floor
+// count as obstructed like for any other Tetromino
+using WallRow_t = uint32_t;
+const WallRow_t WALLS = 1 | (1 << (GRID_SIZE_X + 1));
+
+WallRow_t filledWithWalls(const BitBoard &board, int row) {
+    if (row < 0) {
+        return WALLS;
+    }
+    if (row >= GRID_SIZE_Y) {
+        return ~(WallRow_t)0;
+    }
+    return (WallRow_t)board.rows[row] << 1 | WALLS;
+}
+
+} // namespace
+
+/**
+ * Get the mask of obstructed corners of the 3x3 box with its top left corner
+ * at (x, y)
+ */
+uint8_t getCornerMask(const BitBoard &board, int x, int y) {
+    uint8_t corners = 0;
+    // clang-format off
+    if (board.isObstructed(x,     y))     corners |= CORNER_TOP_LEFT;
+    if (board.isObstructed(x + 2, y))     corners |= CORNER_TOP_RIGHT;
+    if (board.isObstructed(x + 2, y + 2)) corners |= CORNER_BOTTOM_RIGHT;
+    if (board.isObstructed(x,     y + 2)) corners |= CORNER_BOTTOM_LEFT;
+    // clang-format on
+    return corners;
+}
+
+/**
+ * Find every spot where a T would fit exactly and lock down as a (non-mini)
+ * T-Spin clearing at least `min_lines` lines. All columns of a row are
+ * checked at once by shifting whole rows.
+ *
+ * @param slots receives the slots, ordered from the top of the board down
+ * @return the number of slots found
+ */
+int findTSlots(const BitBoard &board, std::vector<TSlot> &slots,
+               int min_lines) {
+    slots.clear();
+    int top = 0;
+    while (top < GRID_SIZE_Y && !board.rows[top]) {
+        top++;
+    }
+    // A T-Spin needs three obstructed corners, so the box has to reach at
+    // least the highest occupied row
+    for (int y = std::max(top - 2, 0); y < GRID_SIZE_Y; y++) {
+        std::array<WallRow_t, 3> filled;
+        for (int row = 0; row < 3; row++) {
+            filled[row] = filledWithWalls(board, y + row);
+        }
+        // Corners in clockwise order; bit `x + 1` is set if the corner of
+        // the box at column x is obstructed
+        std::array<WallRow_t, 4> corners = {filled[0], filled[0] >> 2,
+                                            filled[2] >> 2, filled[2]};
+        for (uint8_t orientation = 0; orientation < 4; orientation++) {
+            const PieceRows_t &piece = getPieceRows(T_KIND, orientation);
+            // Every column where all cells of the T are empty
+            WallRow_t fits = ~(WallRow_t)0;
+            for (int row = 0; row < 3; row++) {
+                for (BitRow_t bits = piece[row]; bits; bits &= bits - 1) {
+                    fits &= ~filled[row] >> __builtin_ctz(bits);
+                }
+            }
+            WallRow_t front =
+                corners[orientation] & corners[(orientation + 1) % 4];
+            WallRow_t back =
+                corners[(orientation + 2) % 4] | corners[(orientation + 3) % 4];
+            WallRow_t spins = fits & front & back & ((1 << GRID_SIZE_X) - 1);
+
+            for (; spins; spins &= spins - 1) {
+                int x = __builtin_ctz(spins) - 1;
+                // A row is cleared if the T fills all of its empty cells
+                int lines = 0;
+                for (int row = 0; row < 3; row++) {
+                    if (piece[row] && y + row < GRID_SIZE_Y &&
+                        __builtin_popcount(~board.rows[y + row] & FULL_ROW) ==
+                            __builtin_popcount(piece[row])) {
+                        lines++;
+                    }
+                }
+                if (lines >= min_lines) {
+                    slots.push_back(
+                        {(int8_t)x, (int8_t)y, orientation, (uint8_t)lines});
+                }
+            }
+        }
+    }
+    return slots.size();
+}
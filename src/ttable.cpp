@@ -0,0 +1,78 @@
+#include <cstring>
+
+#include "ttable.h"
+
+/**
+ * @param size_log2 the table holds 2^size_log2 entries of 16 bytes each
+ */
+TranspositionTable::TranspositionTable(int size_log2)
+    : m_entries(new Entry[(uint64_t)1 << size_log2]),
+      m_mask(((uint64_t)1 << size_log2) - 1) {
+    clear();
+}
+
+/**
+ * Remove all entries. Must not be called while other threads use the table.
+ */
+void TranspositionTable::clear() {
+    for (uint64_t i = 0; i <= m_mask; i++) {
+        // An empty entry only matches the hash ~0, which practically never
+        // occurs, so it can't be mistaken for a hit
+        m_entries[i].check.store(~(uint64_t)0, std::memory_order_relaxed);
+        m_entries[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+uint64_t TranspositionTable::pack(float value, uint8_t depth) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return (uint64_t)bits | ((uint64_t)depth << 32);
+}
+
+void TranspositionTable::unpack(uint64_t data, float &value, uint8_t &depth) {
+    uint32_t bits = (uint32_t)data;
+    std::memcpy(&value, &bits, sizeof(value));
+    depth = (uint8_t)(data >> 32);
+}
+
+/**
+ * Store the evaluation of a state. An existing entry for a different state is
+ * always replaced; one for the same state only if the new evaluation was
+ * searched at least as deep.
+ *
+ * @param hash Zobrist hash of the state
+ * @param value the evaluation
+ * @param depth how many Tetrominos ahead the evaluation has looked
+ */
+void TranspositionTable::store(uint64_t hash, float value, uint8_t depth) {
+    Entry &entry = m_entries[hash & m_mask];
+    uint64_t old_data = entry.data.load(std::memory_order_relaxed);
+    uint64_t old_check = entry.check.load(std::memory_order_relaxed);
+    if ((old_check ^ old_data) == hash && (uint8_t)(old_data >> 32) > depth) {
+        return;
+    }
+    uint64_t data = pack(value, depth);
+    entry.check.store(hash ^ data, std::memory_order_relaxed);
+    entry.data.store(data, std::memory_order_relaxed);
+}
+
+/**
+ * Look up the evaluation of a state
+ *
+ * @return whether an evaluation was found
+ */
+bool TranspositionTable::probe(uint64_t hash, float &value,
+                               uint8_t &depth) const {
+    const Entry &entry = m_entries[hash & m_mask];
+    uint64_t data = entry.data.load(std::memory_order_relaxed);
+    uint64_t check = entry.check.load(std::memory_order_relaxed);
+    if ((check ^ data) != hash) {
+        return false;
+    }
+    unpack(data, value, depth);
+    return true;
+}
+
+uint64_t TranspositionTable::size() const {
+    return m_mask + 1;
+}
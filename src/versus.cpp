@@ -0,0 +1,354 @@
+#include <algorithm>
+#include <climits>
+#include <iostream>
+
+#include "versus.h"
+
+VersusSession::VersusSession(Connection &conn, bool host, uint32_t seed,
+                             int input_delay)
+    : m_conn(conn), m_host(host), m_seed(seed), m_input_delay(input_delay),
+      m_rollback_frame(INT_MAX), m_over_frame(INT_MAX) {}
+
+/**
+ * Start the match; both instances call this with the same seed
+ */
+void VersusSession::start(uint32_t seed) {
+    m_seed = seed;
+    m_started = true;
+    for (Simulation &sim : m_sims) {
+        sim.restart(frameTime(0), seed);
+    }
+}
+
+/**
+ * Advance the session by one tick. Should be called at a fixed rate of one
+ * call per VERSUS_TICK_US.
+ *
+ * @param local_input all local inputs since the last call
+ */
+void VersusSession::tick(InputFrame_t local_input) {
+    poll();
+    if (!m_started) {
+        if (m_host && m_hello_timer-- <= 0) {
+            sendHello();
+            m_hello_timer = 6;
+        }
+        return;
+    }
+    if (isOver()) {
+        // Keep sending so that the peer can confirm the last ticks, too
+        sendInputs();
+        return;
+    }
+
+    rollback();
+    checkSync();
+
+    m_pending_input |= local_input;
+    if (shouldStall()) {
+        m_n_stalls++;
+    } else {
+        // Local inputs are scheduled `m_input_delay` ticks into the future
+        m_local_inputs[(m_frame + m_input_delay) % VERSUS_INPUT_HISTORY] =
+            m_pending_input;
+        m_pending_input = 0;
+        m_sims[0].save(m_snapshots[m_frame % m_snapshots.size()][0]);
+        m_sims[1].save(m_snapshots[m_frame % m_snapshots.size()][1]);
+        simulateFrame(m_frame);
+        m_frame++;
+    }
+    sendInputs();
+}
+
+/**
+ * Receive and handle all pending packets
+ */
+void VersusSession::poll() {
+    VersusPacket packet;
+    int len;
+    while ((len = m_conn.receive(&packet, sizeof(packet))) >= 0) {
+        if (len != sizeof(packet) || packet.magic != VERSUS_MAGIC) {
+            continue;
+        }
+        handlePacket(packet);
+    }
+}
+
+void VersusSession::handlePacket(const VersusPacket &packet) {
+    if (!m_started) {
+        if (!m_host && packet.type == VersusPacketType::Hello) {
+            start(packet.seed);
+        } else if (m_host) {
+            // Any packet from the client means it has started
+            start(m_seed);
+        } else {
+            return;
+        }
+    }
+    if (packet.type == VersusPacketType::Hello) {
+        // The host keeps saying hello until it hears from us
+        if (!m_host) {
+            sendHello();
+        }
+        return;
+    }
+
+    m_remote_ack = std::max(m_remote_ack, (int)packet.ack);
+    // Keep the oldest checksums that can't be compared yet, so that a peer
+    // running ahead doesn't keep replacing them
+    if (packet.checksum_frame > m_checked_frame &&
+        m_peer_checksum_frame <= m_checked_frame) {
+        m_peer_checksum_frame = packet.checksum_frame;
+        m_peer_checksums = packet.checksums;
+    }
+    m_local_advantage = m_frame - packet.frame;
+    m_remote_advantage = packet.advantage;
+
+    for (int i = 0; i < packet.count; i++) {
+        int frame = packet.start + i;
+        // Only accept inputs in order; anything else will be resent
+        if (frame != m_remote_last + 1) {
+            continue;
+        }
+        InputFrame_t input = packet.inputs[i];
+        m_remote_inputs[frame % VERSUS_INPUT_HISTORY] = input;
+        m_remote_last = frame;
+        // This tick was already simulated with an empty input
+        if (frame < m_frame && input != 0) {
+            m_rollback_frame = std::min(m_rollback_frame, frame);
+        }
+    }
+}
+
+/**
+ * Send all local inputs the peer hasn't acknowledged yet
+ */
+void VersusSession::sendInputs() {
+    VersusPacket packet{};
+    packet.magic = VERSUS_MAGIC;
+    packet.type = VersusPacketType::Input;
+    packet.seed = m_seed;
+    packet.frame = m_frame;
+    packet.ack = m_remote_last;
+    packet.advantage = m_local_advantage;
+    packet.start = m_remote_ack + 1;
+    // Last tick whose local input has been scheduled
+    int last = m_frame + m_input_delay - 1;
+    packet.count =
+        std::max(0, std::min(last - packet.start + 1, VERSUS_MAX_PACKET_INPUTS));
+    for (int i = 0; i < packet.count; i++) {
+        packet.inputs[i] =
+            m_local_inputs[(packet.start + i) % VERSUS_INPUT_HISTORY];
+    }
+    // Ticks waiting for a rollback don't have their final checksums yet
+    packet.checksum_frame =
+        std::min({m_remote_last, m_frame - 1, m_rollback_frame - 1});
+    if (packet.checksum_frame >= 0) {
+        packet.checksums =
+            m_checksums[packet.checksum_frame % VERSUS_INPUT_HISTORY];
+    }
+    m_conn.send(&packet, sizeof(packet));
+}
+
+void VersusSession::sendHello() {
+    VersusPacket packet{};
+    packet.magic = VERSUS_MAGIC;
+    packet.type = VersusPacketType::Hello;
+    packet.seed = m_seed;
+    packet.ack = -1;
+    packet.checksum_frame = -1;
+    m_conn.send(&packet, sizeof(packet));
+}
+
+/**
+ * Check whether the local simulation has to wait for the remote one, either
+ * because a rollback further than VERSUS_MAX_ROLLBACK ticks might become
+ * necessary or because the local clock runs ahead of the remote one.
+ */
+bool VersusSession::shouldStall() {
+    if (m_frame - m_remote_last > VERSUS_MAX_ROLLBACK) {
+        return true;
+    }
+    // Both sides measure how far they are ahead of each other; if we are
+    // further ahead than the peer, skip an occasional tick to let it catch up
+    if ((m_local_advantage - m_remote_advantage) / 2 >= 1 &&
+        m_frame - m_last_sync_stall >= 8) {
+        m_last_sync_stall = m_frame;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * If a prediction turned out to be wrong, restore the snapshot taken before
+ * the mispredicted tick and re-simulate everything up to the current tick
+ */
+void VersusSession::rollback() {
+    if (m_rollback_frame >= m_frame) {
+        m_rollback_frame = INT_MAX;
+        return;
+    }
+    int frame = m_rollback_frame;
+    m_rollback_frame = INT_MAX;
+    if (m_over_frame >= frame) {
+        m_over_frame = INT_MAX;
+    }
+    m_sims[0].load(m_snapshots[frame % m_snapshots.size()][0]);
+    m_sims[1].load(m_snapshots[frame % m_snapshots.size()][1]);
+    m_n_rollbacks++;
+    for (; frame < m_frame; frame++) {
+        m_sims[0].save(m_snapshots[frame % m_snapshots.size()][0]);
+        m_sims[1].save(m_snapshots[frame % m_snapshots.size()][1]);
+        simulateFrame(frame);
+        m_n_resimulated++;
+    }
+}
+
+/**
+ * Simulate a single tick for both players and exchange garbage afterwards.
+ * This has to be symmetric, since the peer simulates the same tick with the
+ * roles of both players swapped.
+ */
+void VersusSession::simulateFrame(int frame) {
+    cl::time_point now = frameTime(frame);
+    m_sims[0].apply(m_local_inputs[frame % VERSUS_INPUT_HISTORY], now);
+    m_sims[1].apply(getRemoteInput(frame), now);
+    m_sims[0].update(now);
+    m_sims[1].update(now);
+    int sent_local = m_sims[0].takeOutgoingGarbage();
+    int sent_remote = m_sims[1].takeOutgoingGarbage();
+    m_sims[1].receiveGarbage(sent_local);
+    m_sims[0].receiveGarbage(sent_remote);
+    if (m_over_frame == INT_MAX &&
+        (m_sims[0].getState() == GameState::GameOver ||
+         m_sims[1].getState() == GameState::GameOver)) {
+        m_over_frame = frame;
+    }
+    m_checksums[frame % VERSUS_INPUT_HISTORY] = {m_sims[0].getChecksum(),
+                                                 m_sims[1].getChecksum()};
+}
+
+/**
+ * Compare the checksums the peer sent with ours once the tick they belong to
+ * can't be rolled back anymore on our side either. The peer's own player is
+ * our remote one and the other way around.
+ */
+void VersusSession::checkSync() {
+    int frame = m_peer_checksum_frame;
+    if (frame <= m_checked_frame || frame > m_remote_last ||
+        frame >= m_frame) {
+        return;
+    }
+    m_checked_frame = frame;
+    // Too old to still be in the history
+    if (m_frame - frame > VERSUS_INPUT_HISTORY) {
+        return;
+    }
+    const std::array<uint32_t, 2> &ours =
+        m_checksums[frame % VERSUS_INPUT_HISTORY];
+    if (m_desync_frame >= 0 ||
+        (ours[0] == m_peer_checksums[1] && ours[1] == m_peer_checksums[0])) {
+        return;
+    }
+    m_desync_frame = frame;
+    std::cerr << "ERROR: The games diverged in tick " << frame
+              << "; the checksums of the peer differ from ours" << std::endl;
+    if (m_dump_desync) {
+        dumpDesync(frame);
+    }
+}
+
+/**
+ * Print the state of both players after a tick, if it is still known. The
+ * peer prints its own, so the two can be compared side by side.
+ */
+void VersusSession::dumpDesync(int frame) {
+    // State before the next tick, or the current one
+    int next = frame + 1;
+    if (next < m_frame && m_frame - next >= (int)m_snapshots.size()) {
+        std::cerr << "The state after tick " << frame << " is gone\n";
+        return;
+    }
+    const char *const NAMES[] = {"local", "remote"};
+    for (int i = 0; i < 2; i++) {
+        std::cerr << "Tick " << frame << ", " << NAMES[i]
+                  << " player, the peer's checksum is "
+                  << m_peer_checksums[1 - i] << ":\n";
+        if (next == m_frame) {
+            m_sims[i].dump(std::cerr);
+        } else {
+            Simulation sim(m_seed);
+            sim.load(m_snapshots[next % m_snapshots.size()][i]);
+            sim.dump(std::cerr);
+        }
+    }
+}
+
+/**
+ * Get the remote input for a tick, or the prediction if it isn't known yet
+ */
+InputFrame_t VersusSession::getRemoteInput(int frame) const {
+    if (frame > m_remote_last) {
+        return 0;
+    }
+    return m_remote_inputs[frame % VERSUS_INPUT_HISTORY];
+}
+
+/**
+ * Simulation time at the start of a tick; identical on both instances
+ */
+cl::time_point VersusSession::frameTime(int frame) {
+    return cl::time_point{} +
+           std::chrono::microseconds((int64_t)frame * VERSUS_TICK_US);
+}
+
+bool VersusSession::isStarted() const {
+    return m_started;
+}
+
+/**
+ * Check whether one of the players has topped out in a tick whose inputs are
+ * confirmed, i. e. the result can't be undone by a rollback anymore
+ */
+bool VersusSession::isOver() const {
+    return m_started && m_over_frame <= m_remote_last;
+}
+
+int VersusSession::getFrame() const {
+    return m_frame;
+}
+
+Simulation &VersusSession::getLocal() {
+    return m_sims[0];
+}
+
+Simulation &VersusSession::getRemote() {
+    return m_sims[1];
+}
+
+int VersusSession::getRollbacks() const {
+    return m_n_rollbacks;
+}
+
+int VersusSession::getResimulatedFrames() const {
+    return m_n_resimulated;
+}
+
+int VersusSession::getStalls() const {
+    return m_n_stalls;
+}
+
+/**
+ * Get the first tick in which the checksums of the two instances differed,
+ * -1 if they never did
+ */
+int VersusSession::getDesyncFrame() const {
+    return m_desync_frame;
+}
+
+/**
+ * Print the state of both players when the games diverge
+ */
+void VersusSession::setDumpDesync(bool dump) {
+    m_dump_desync = dump;
+}
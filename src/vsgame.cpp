@@ -0,0 +1,99 @@
+#include <iostream>
+#include <thread>
+
+#include "vsgame.h"
+
+VersusGame::VersusGame(Connection &conn, bool host, uint32_t seed,
+                       int input_delay)
+    : m_session(conn, host, seed, input_delay),
+      m_hud(m_session.getLocal().getScoring()) {
+    m_session.getRemote().playfield.setDrawPosition(
+        WINDOW_X + PLAYFIELD_DRAW_X, PLAYFIELD_DRAW_Y);
+    m_next_tick = cl::now();
+}
+
+/**
+ * Run all ticks that are due, then sleep until the next one
+ */
+void VersusGame::update() {
+    cl::time_point now = cl::now();
+    // Don't try to catch up on more than a few ticks, e. g. after the window
+    // was dragged
+    if (now - m_next_tick.get() > std::chrono::milliseconds(100)) {
+        m_next_tick = now;
+    }
+    while (m_next_tick < now) {
+        m_session.tick(m_input | m_gamepad.poll());
+        m_input = 0;
+        m_next_tick += std::chrono::microseconds(VERSUS_TICK_US);
+    }
+
+    if (m_session.isOver() && !m_reported) {
+        m_reported = true;
+        bool lost = m_session.getLocal().getState() == GameState::GameOver;
+        std::cout << (lost ? "You lost" : "You won") << " after "
+                  << m_session.getFrame() << " ticks ("
+                  << m_session.getRollbacks() << " rollbacks, "
+                  << m_session.getResimulatedFrames()
+                  << " re-simulated ticks, " << m_session.getStalls()
+                  << " stalls)\n";
+    }
+
+    std::this_thread::sleep_until(m_next_tick.get());
+}
+
+/**
+ * Start using the game controller and build the glyph atlas; called once the
+ * first frame is shown
+ */
+void VersusGame::finishLoading(SDL_Renderer *renderer) {
+    m_gamepad.init();
+    m_hud.buildGlyphAtlas(renderer);
+}
+
+void VersusGame::setGamepadSettings(const GamepadSettings &settings) {
+    m_gamepad.setSettings(settings);
+}
+
+void VersusGame::setDumpDesync(bool dump) {
+    m_session.setDumpDesync(dump);
+}
+
+void VersusGame::handleEvent(const SDL_Event &e) {
+    m_gamepad.handleEvent(e);
+    Action action;
+    if (actionFromEvent(e, action)) {
+        m_input |= actionBit(action);
+    }
+}
+
+void VersusGame::draw(SDL_Renderer *renderer) {
+    Simulation &local = m_session.getLocal();
+    Simulation &remote = m_session.getRemote();
+    local.draw(renderer);
+    remote.draw(renderer);
+    drawGarbageMeter(renderer, local, PLAYFIELD_DRAW_X);
+    drawGarbageMeter(renderer, remote, WINDOW_X + PLAYFIELD_DRAW_X);
+
+    m_hud.setQueue(local.getQueue());
+    m_hud.setHold(local.getHeld());
+    GameState state = m_session.isOver() ? GameState::GameOver
+                      : m_session.isStarted() ? GameState::Running
+                                              : GameState::Paused;
+    m_hud.draw(renderer, state);
+}
+
+/**
+ * Draw a bar left of a Playfield showing the number of pending garbage lines
+ */
+void VersusGame::drawGarbageMeter(SDL_Renderer *renderer,
+                                  const Simulation &sim, int x) {
+    int height =
+        std::min(sim.getPendingGarbage(), GRID_SIZE_VISIBLE_Y) * CELL_SIZE;
+    SDL_Rect rect{x - CELL_SIZE / 4, PLAYFIELD_DRAW_Y + PLAYFIELD_HEIGHT - height,
+                  CELL_SIZE / 4, height};
+    SDL_SetRenderDrawColor(renderer, TETROMINO_COLORS[4].r,
+                           TETROMINO_COLORS[4].g, TETROMINO_COLORS[4].b,
+                           TETROMINO_COLORS[4].a);
+    SDL_RenderFillRect(renderer, &rect);
+}
@@ -0,0 +1,226 @@
+/*
+ * Checks the game controller input path without a physical controller: drives
+ * an SDL virtual joystick and compares what Gamepad::poll() returns with what
+ * the buttons and sticks were set to, including the stick hysteresis and the
+ * controller being disconnected and connected again. Needs no window or
+ * display:
+ *
+ *   tetris_gamepadcheck
+ *
+ * Prints every check that fails and exits with 1 if any did.
+ */
+#include <initializer_list>
+#include <iostream>
+#include <string>
+
+#include "SDL.h"
+
+#include "action.h"
+#include "gamepad.h"
+
+// Largest value reported by an axis
+inline const double CHECK_AXIS_MAX = 32767;
+
+namespace {
+
+int n_failed = 0;
+
+void expect(bool ok, const std::string &what) {
+    if (!ok) {
+        std::cout << "FAILED: " << what << "\n";
+        n_failed++;
+    }
+}
+
+/*
+ * Virtual controller whose buttons and axes are numbered like
+ * SDL_GameControllerButton and SDL_GameControllerAxis
+ */
+class VirtualPad {
+  private:
+    int m_device_index = -1;
+    SDL_Joystick *m_joystick = nullptr;
+
+  public:
+    ~VirtualPad() { detach(); }
+
+    bool attach() {
+        m_device_index =
+            SDL_JoystickAttachVirtual(SDL_JOYSTICK_TYPE_GAMECONTROLLER,
+                                      SDL_CONTROLLER_AXIS_MAX,
+                                      SDL_CONTROLLER_BUTTON_MAX, 0);
+        if (m_device_index < 0) {
+            return false;
+        }
+        // Make sure SDL maps it like a standard controller
+        char guid[33];
+        SDL_JoystickGetGUIDString(SDL_JoystickGetDeviceGUID(m_device_index),
+                                  guid, sizeof(guid));
+        std::string mapping =
+            std::string(guid) +
+            ",Virtual pad,a:b0,b:b1,x:b2,y:b3,back:b4,guide:b5,start:b6,"
+            "leftstick:b7,rightstick:b8,leftshoulder:b9,rightshoulder:b10,"
+            "dpup:b11,dpdown:b12,dpleft:b13,dpright:b14,leftx:a0,lefty:a1,"
+            "rightx:a2,righty:a3,lefttrigger:a4,righttrigger:a5,";
+        SDL_GameControllerAddMapping(mapping.c_str());
+        m_joystick = SDL_JoystickOpen(m_device_index);
+        return m_joystick != nullptr;
+    }
+
+    void detach() {
+        if (m_joystick) {
+            SDL_JoystickClose(m_joystick);
+            m_joystick = nullptr;
+        }
+        if (m_device_index >= 0) {
+            SDL_JoystickDetachVirtual(m_device_index);
+            m_device_index = -1;
+        }
+    }
+
+    void setButton(SDL_GameControllerButton button, bool pressed) {
+        SDL_JoystickSetVirtualButton(m_joystick, button,
+                                     pressed ? SDL_PRESSED : SDL_RELEASED);
+    }
+
+    /**
+     * @param value deflection from -1 to 1
+     */
+    void setAxis(SDL_GameControllerAxis axis, double value) {
+        SDL_JoystickSetVirtualAxis(m_joystick, axis,
+                                   (Sint16)(value * CHECK_AXIS_MAX));
+    }
+};
+
+/**
+ * Pass connects and disconnects to the Gamepad, like the game's event loop
+ */
+void handleEvents(Gamepad &gamepad) {
+    SDL_Event e;
+    while (SDL_PollEvent(&e) != 0) {
+        gamepad.handleEvent(e);
+    }
+}
+
+InputFrame_t bits(std::initializer_list<Action> actions) {
+    InputFrame_t result = 0;
+    for (Action action : actions) {
+        result |= actionBit(action);
+    }
+    return result;
+}
+
+void checkButtons(Gamepad &gamepad, VirtualPad &pad) {
+    pad.setButton(SDL_CONTROLLER_BUTTON_DPAD_LEFT, true);
+    expect(gamepad.poll() == bits({Action::MoveLeft}), "D-pad left pressed");
+    expect(gamepad.poll() == 0, "D-pad left held");
+    pad.setButton(SDL_CONTROLLER_BUTTON_DPAD_LEFT, false);
+    expect(gamepad.poll() == bits({Action::MoveLeftRelease}),
+           "D-pad left released");
+
+    pad.setButton(SDL_CONTROLLER_BUTTON_DPAD_UP, true);
+    pad.setButton(SDL_CONTROLLER_BUTTON_A, true);
+    pad.setButton(SDL_CONTROLLER_BUTTON_RIGHTSHOULDER, true);
+    expect(gamepad.poll() == bits({Action::HardDrop,
+                                   Action::RotateCounterclockw,
+                                   Action::Hold}),
+           "D-pad up, A and right shoulder pressed together");
+    pad.setButton(SDL_CONTROLLER_BUTTON_DPAD_UP, false);
+    pad.setButton(SDL_CONTROLLER_BUTTON_A, false);
+    pad.setButton(SDL_CONTROLLER_BUTTON_RIGHTSHOULDER, false);
+    expect(gamepad.poll() == 0,
+           "releasing buttons without release actions");
+
+    pad.setButton(SDL_CONTROLLER_BUTTON_X, true);
+    expect(gamepad.poll() == bits({Action::RotateClockw}), "X pressed");
+    pad.setButton(SDL_CONTROLLER_BUTTON_X, false);
+    gamepad.poll();
+}
+
+void checkStick(Gamepad &gamepad, VirtualPad &pad,
+                const GamepadSettings &settings) {
+    double between = (settings.stick_press + settings.stick_release) / 2;
+    pad.setAxis(SDL_CONTROLLER_AXIS_LEFTX, between);
+    expect(gamepad.poll() == 0,
+           "stick between the thresholds doesn't press");
+    pad.setAxis(SDL_CONTROLLER_AXIS_LEFTX, settings.stick_press + 0.05);
+    expect(gamepad.poll() == bits({Action::MoveRight}),
+           "stick past the press threshold presses");
+    pad.setAxis(SDL_CONTROLLER_AXIS_LEFTX, between);
+    expect(gamepad.poll() == 0,
+           "stick back between the thresholds stays pressed");
+    pad.setAxis(SDL_CONTROLLER_AXIS_LEFTX, settings.stick_release - 0.05);
+    expect(gamepad.poll() == bits({Action::MoveRightRelease}),
+           "stick below the release threshold releases");
+    pad.setAxis(SDL_CONTROLLER_AXIS_LEFTX, 0);
+
+    pad.setAxis(SDL_CONTROLLER_AXIS_LEFTX, -1);
+    pad.setAxis(SDL_CONTROLLER_AXIS_LEFTY, 1);
+    expect(gamepad.poll() == bits({Action::MoveLeft, Action::SoftDrop}),
+           "stick down and to the left");
+    pad.setAxis(SDL_CONTROLLER_AXIS_LEFTX, 0);
+    pad.setAxis(SDL_CONTROLLER_AXIS_LEFTY, 0);
+    expect(gamepad.poll() ==
+               bits({Action::MoveLeftRelease, Action::SoftDropRelease}),
+           "stick back to the center");
+}
+
+void checkHotplug(Gamepad &gamepad, VirtualPad &pad) {
+    pad.setButton(SDL_CONTROLLER_BUTTON_DPAD_DOWN, true);
+    pad.setButton(SDL_CONTROLLER_BUTTON_B, true);
+    expect(gamepad.poll() ==
+               bits({Action::SoftDrop, Action::RotateClockw}),
+           "D-pad down and B pressed before disconnecting");
+
+    pad.detach();
+    handleEvents(gamepad);
+    expect(!gamepad.isConnected(), "disconnected");
+    expect(gamepad.poll() == bits({Action::SoftDropRelease}),
+           "held buttons released on disconnect");
+    expect(gamepad.poll() == 0, "nothing while disconnected");
+
+    expect(pad.attach(), "attaching the virtual controller again");
+    handleEvents(gamepad);
+    expect(gamepad.isConnected(), "connected again");
+    pad.setButton(SDL_CONTROLLER_BUTTON_DPAD_RIGHT, true);
+    expect(gamepad.poll() == bits({Action::MoveRight}),
+           "D-pad right pressed after connecting again");
+    pad.setButton(SDL_CONTROLLER_BUTTON_DPAD_RIGHT, false);
+    expect(gamepad.poll() == bits({Action::MoveRightRelease}),
+           "D-pad right released after connecting again");
+}
+
+} // namespace
+
+int main() {
+    if (SDL_InitSubSystem(SDL_INIT_GAMECONTROLLER) != 0) {
+        std::cerr << "ERROR: Couldn't initialize game controllers: "
+                  << SDL_GetError() << std::endl;
+        return 1;
+    }
+    VirtualPad pad;
+    if (!pad.attach()) {
+        std::cerr << "ERROR: Couldn't attach a virtual controller: "
+                  << SDL_GetError() << std::endl;
+        return 1;
+    }
+
+    GamepadSettings settings;
+    Gamepad gamepad(settings);
+    pad.setButton(SDL_CONTROLLER_BUTTON_DPAD_LEFT, true);
+    expect(!gamepad.isConnected() && gamepad.poll() == 0,
+           "no controller used before init()");
+    pad.setButton(SDL_CONTROLLER_BUTTON_DPAD_LEFT, false);
+    gamepad.init();
+    handleEvents(gamepad);
+    expect(gamepad.isConnected(), "controller connected before init() used");
+
+    checkButtons(gamepad, pad);
+    checkStick(gamepad, pad, settings);
+    checkHotplug(gamepad, pad);
+
+    pad.detach();
+    SDL_QuitSubSystem(SDL_INIT_GAMECONTROLLER);
+    std::cout << (n_failed ? "Some checks failed\n" : "All checks passed\n");
+    return n_failed ? 1 : 0;
+}
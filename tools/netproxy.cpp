@@ -0,0 +1,96 @@
+/*
+ * Relays versus packets between two instances of the game while injecting
+ * latency, jitter and packet loss. Stand-in for a real network when testing
+ * versus mode on a single machine:
+ *
+ *   tetris_netproxy unix:/tmp/a unix:/tmp/pa unix:/tmp/pb unix:/tmp/b \
+ *       --latency 40 --jitter 15
+ *   tetris --versus --host --bind unix:/tmp/a --peer unix:/tmp/pa
+ *   tetris --versus --bind unix:/tmp/b --peer unix:/tmp/pb
+ */
+#include <chrono>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "poll.h"
+
+#include "net.h"
+
+using cl = std::chrono::steady_clock;
+
+struct DelayedPacket {
+    cl::time_point release;
+    // Which side the packet is delivered to
+    int to;
+    std::vector<char> data;
+
+    bool operator>(const DelayedPacket &other) const {
+        return release > other.release;
+    }
+};
+
+int main(int argc, char *argv[]) {
+    if (argc < 5) {
+        std::cout << "Usage: " << argv[0]
+                  << " A PROXY_A PROXY_B B [--latency MS] [--jitter MS]"
+                     " [--loss PERCENT]\n"
+                  << "Instance A must use PROXY_A as its peer, instance B "
+                     "PROXY_B.\n";
+        return 1;
+    }
+    double latency_ms = 0, jitter_ms = 0, loss_percent = 0;
+    for (int i = 5; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--latency") {
+            latency_ms = std::stod(argv[i + 1]);
+        } else if (arg == "--jitter") {
+            jitter_ms = std::stod(argv[i + 1]);
+        } else if (arg == "--loss") {
+            loss_percent = std::stod(argv[i + 1]);
+        }
+    }
+
+    // sides[0] talks to instance A, sides[1] to instance B
+    Connection side_a(argv[2], argv[1]);
+    Connection side_b(argv[3], argv[4]);
+    Connection *sides[2] = {&side_a, &side_b};
+
+    std::mt19937 rng(std::random_device{}());
+    std::uniform_real_distribution<double> jitter(-jitter_ms, jitter_ms);
+    std::uniform_real_distribution<double> percent(0, 100);
+    // Packets ordered by release time; jitter may reorder them
+    std::priority_queue<DelayedPacket, std::vector<DelayedPacket>,
+                        std::greater<DelayedPacket>>
+        in_flight;
+
+    std::vector<char> buffer(65536);
+    while (true) {
+        pollfd fds[2] = {{side_a.getFd(), POLLIN, 0},
+                         {side_b.getFd(), POLLIN, 0}};
+        poll(fds, 2, 1);
+
+        cl::time_point now = cl::now();
+        for (int from = 0; from < 2; from++) {
+            int len;
+            while ((len = sides[from]->receive(buffer.data(), buffer.size())) >=
+                   0) {
+                if (percent(rng) < loss_percent) {
+                    continue;
+                }
+                double delay_ms = std::max(0.0, latency_ms + jitter(rng));
+                in_flight.push(
+                    {now + std::chrono::microseconds((int64_t)(delay_ms * 1000)),
+                     1 - from,
+                     std::vector<char>(buffer.begin(), buffer.begin() + len)});
+            }
+        }
+        while (!in_flight.empty() && in_flight.top().release <= now) {
+            const DelayedPacket &packet = in_flight.top();
+            sides[packet.to]->send(packet.data.data(), packet.data.size());
+            in_flight.pop();
+        }
+    }
+}
@@ -0,0 +1,346 @@
+/*
+ * Spectator wall: plays many bot games at once and shows all of their boards
+ * in a single window, e.g. on a projector during a bot tournament:
+ *
+ *   tetris_spectate --games 36 --pps 3
+ *
+ * Bots search on worker threads; the window only draws. All boards go
+ * through one MinoBatch, so drawing takes the same dozen calls to the
+ * renderer no matter how many games are shown. The window can be resized,
+ * the boards are scaled to fit. Games that top out start over with a new
+ * seed.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SDL.h"
+
+#include "bot.h"
+#include "constants.h"
+#include "minobatch.h"
+#include "playfield.h"
+
+using cl = std::chrono::steady_clock;
+
+inline const int SPECTATE_DEFAULT_GAMES = 16;
+inline const int SPECTATE_MAX_GAMES = 64;
+inline const int SPECTATE_WINDOW_X = 1280;
+inline const int SPECTATE_WINDOW_Y = 720;
+// How long a topped out board stays on the wall before its game starts over
+inline const int SPECTATE_RESTART_MS = 3000;
+// Default size of the transposition table of each bot thread, 16 MiB
+inline const int SPECTATE_DEFAULT_TABLE_SIZE_LOG2 = 20;
+
+struct Options {
+    int games = SPECTATE_DEFAULT_GAMES;
+    int depth = 2;
+    // Tetrominos each bot places per second
+    double pps = 2;
+    int jobs = 0;
+    // Each bot thread's TranspositionTable has 2^table_bits entries
+    int table_bits = SPECTATE_DEFAULT_TABLE_SIZE_LOG2;
+    uint32_t seed = std::random_device{}();
+};
+
+void printUsage(const char *program_name) {
+    std::cout
+        << "Usage: " << program_name << " [options]\n"
+        << "\n"
+        << "  --games N           number of games on the wall, at most "
+        << SPECTATE_MAX_GAMES << "\n"
+        << "                      (default " << SPECTATE_DEFAULT_GAMES
+        << ")\n"
+        << "  --pps X             Tetrominos each bot places per second\n"
+        << "                      (default 2)\n"
+        << "  --depth N           Tetrominos the bots look ahead (default 2)\n"
+        << "  --seed N            seed of the first game (default: random)\n"
+        << "  --jobs N            bot threads (default: one per core)\n"
+        << "  --table-bits N      each thread caches 2^N searched positions,\n"
+        << "                      0 for none (default "
+        << SPECTATE_DEFAULT_TABLE_SIZE_LOG2 << ")\n";
+}
+
+bool parseOptions(int argc, char *argv[], Options &options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--games" && has_value) {
+            options.games = std::stoi(argv[++i]);
+        } else if (arg == "--pps" && has_value) {
+            options.pps = std::stod(argv[++i]);
+        } else if (arg == "--depth" && has_value) {
+            options.depth = std::stoi(argv[++i]);
+        } else if (arg == "--seed" && has_value) {
+            options.seed = std::stoul(argv[++i]);
+        } else if (arg == "--jobs" && has_value) {
+            options.jobs = std::stoi(argv[++i]);
+        } else if (arg == "--table-bits" && has_value) {
+            options.table_bits = std::stoi(argv[++i]);
+        } else {
+            return false;
+        }
+    }
+    return options.games > 0 && options.games <= SPECTATE_MAX_GAMES &&
+           options.pps > 0 && options.depth > 0 && options.jobs >= 0 &&
+           options.table_bits >= 0 && options.table_bits <= 30;
+}
+
+/*
+ * One game on the wall. The board is shared between the thread playing the
+ * game and the window, everything else belongs to the playing thread.
+ */
+struct WallGame {
+    std::mutex mutex;
+    // Colored copy of core->board
+    Playfield board;
+
+    std::unique_ptr<GuidelineCore> core;
+    uint32_t seed;
+    // Set once the bot finds no placement, which counts as topping out
+    bool stuck = false;
+    cl::time_point next_move;
+};
+
+class SpectatorWall {
+  private:
+    Options m_options;
+    std::vector<std::unique_ptr<WallGame>> m_games;
+    std::vector<std::thread> m_workers;
+    std::atomic<bool> m_stop{false};
+    cl::duration m_interval;
+
+    void work(int first, int step);
+    void play(WallGame &game, Bot<BoardEvaluator> &bot, cl::time_point now);
+
+  public:
+    SpectatorWall(const Options &options);
+    ~SpectatorWall();
+
+    void layout(int width, int height);
+    void draw(MinoBatch &batch);
+};
+
+SpectatorWall::SpectatorWall(const Options &options) : m_options(options) {
+    m_interval = std::chrono::duration_cast<cl::duration>(
+        std::chrono::duration<double>(1 / options.pps));
+    cl::time_point now = cl::now();
+    for (int i = 0; i < options.games; i++) {
+        auto game = std::make_unique<WallGame>();
+        game->seed = options.seed + i;
+        game->core = std::make_unique<GuidelineCore>(game->seed);
+        // Spread the moves of the games over the interval, so that the bots
+        // don't all search at the same time
+        game->next_move = now + m_interval * i / options.games;
+        m_games.push_back(std::move(game));
+    }
+    int n_workers = options.jobs;
+    if (n_workers == 0) {
+        n_workers = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    n_workers = std::min(n_workers, options.games);
+    for (int i = 0; i < n_workers; i++) {
+        m_workers.emplace_back(&SpectatorWall::work, this, i, n_workers);
+    }
+}
+
+SpectatorWall::~SpectatorWall() {
+    m_stop = true;
+    for (std::thread &worker : m_workers) {
+        worker.join();
+    }
+}
+
+/**
+ * Body of a bot thread: play every `step`-th game, starting with `first`
+ */
+void SpectatorWall::work(int first, int step) {
+    std::unique_ptr<TranspositionTable> table;
+    if (m_options.table_bits > 0) {
+        table = std::make_unique<TranspositionTable>(m_options.table_bits);
+    }
+    Bot<BoardEvaluator> bot(BoardEvaluator(EvalWeights{}), m_options.depth,
+                            table.get());
+    while (!m_stop) {
+        cl::time_point now = cl::now();
+        cl::time_point wake = now + m_interval;
+        for (int i = first; i < (int)m_games.size(); i += step) {
+            WallGame &game = *m_games[i];
+            if (game.next_move <= now) {
+                play(game, bot, now);
+            }
+            wake = std::min(wake, game.next_move);
+        }
+        std::this_thread::sleep_until(wake);
+    }
+}
+
+/**
+ * Place the next Tetromino of a game, or start it over if it is over
+ */
+void SpectatorWall::play(WallGame &game, Bot<BoardEvaluator> &bot,
+                         cl::time_point now) {
+    // A bot that falls behind skips ahead rather than catching up
+    game.next_move = std::max(game.next_move + m_interval, now);
+    if (game.core->isOver() || game.stuck) {
+        game.seed += m_games.size();
+        game.core = std::make_unique<GuidelineCore>(game.seed);
+        game.stuck = false;
+        std::lock_guard<std::mutex> lock(game.mutex);
+        game.board.reset();
+        return;
+    }
+    BotMove move;
+    if (!bot.chooseMove(*game.core, move)) {
+        game.stuck = true;
+    } else {
+        if (move.hold) {
+            game.core->hold();
+        }
+        TetrominoKind_t kind = game.core->getActive();
+        const Placement &placement = move.placement;
+        game.core->place(placement);
+        std::lock_guard<std::mutex> lock(game.mutex);
+        forEachMino(getPieceMask(kind, placement.orientation),
+                    [&](int col, int row) {
+                        game.board.setAt(placement.x + col,
+                                         placement.y + row, kind);
+                    });
+        game.board.clearEmptyLines();
+    }
+    if (game.core->isOver() || game.stuck) {
+        game.next_move = now + std::chrono::milliseconds(SPECTATE_RESTART_MS);
+    }
+}
+
+/**
+ * Arrange the boards in the grid that gives them the largest cells in a
+ * window of the given size
+ */
+void SpectatorWall::layout(int width, int height) {
+    // Every board is surrounded by half a cell of space on each side
+    const int board_x = GRID_SIZE_VISIBLE_X + 1;
+    const int board_y = GRID_SIZE_VISIBLE_Y + 1;
+    int n_games = m_games.size();
+    int best_columns = 1;
+    int best_cell_size = 0;
+    for (int columns = 1; columns <= n_games; columns++) {
+        int rows = (n_games + columns - 1) / columns;
+        int cell_size = std::min(width / (columns * board_x),
+                                 height / (rows * board_y));
+        if (cell_size > best_cell_size) {
+            best_cell_size = cell_size;
+            best_columns = columns;
+        }
+    }
+    int cell_size = std::max(best_cell_size, 2);
+    int rows = (n_games + best_columns - 1) / best_columns;
+    // Center the wall in the window
+    int left = (width - best_columns * board_x * cell_size + cell_size) / 2;
+    int top = (height - rows * board_y * cell_size + cell_size) / 2;
+    for (int i = 0; i < n_games; i++) {
+        std::lock_guard<std::mutex> lock(m_games[i]->mutex);
+        m_games[i]->board.setDrawPosition(
+            left + (i % best_columns) * board_x * cell_size,
+            top + (i / best_columns) * board_y * cell_size, cell_size);
+    }
+}
+
+void SpectatorWall::draw(MinoBatch &batch) {
+    for (const std::unique_ptr<WallGame> &game : m_games) {
+        std::lock_guard<std::mutex> lock(game->mutex);
+        game->board.draw(batch);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    Options options;
+    try {
+        if (!parseOptions(argc, argv, options)) {
+            printUsage(argv[0]);
+            return 1;
+        }
+    } catch (const std::exception &) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        std::cerr << "ERROR: Couldn't initialize SDL: " << SDL_GetError()
+                  << std::endl;
+        return 1;
+    }
+    SDL_Window *window = SDL_CreateWindow(
+        "Tetris spectator", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+        SPECTATE_WINDOW_X, SPECTATE_WINDOW_Y, SDL_WINDOW_RESIZABLE);
+    SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, 0);
+
+    SpectatorWall wall(options);
+    wall.layout(SPECTATE_WINDOW_X, SPECTATE_WINDOW_Y);
+    MinoBatch batch;
+
+    // Frames and drawing time since the title was last updated
+    int frames = 0;
+    cl::duration draw_time{};
+    cl::time_point title_time = cl::now();
+
+    bool is_running = true;
+    while (is_running) {
+        cl::time_point now = cl::now();
+        SDL_Event e;
+        while (SDL_PollEvent(&e) != 0) {
+            if (e.type == SDL_QUIT) {
+                is_running = false;
+            } else if (e.type == SDL_WINDOWEVENT &&
+                       e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+                wall.layout(e.window.data1, e.window.data2);
+            }
+        }
+
+        SDL_SetRenderDrawColor(renderer, BACKGROUND.r, BACKGROUND.g,
+                               BACKGROUND.b, BACKGROUND.a);
+        SDL_RenderClear(renderer);
+        wall.draw(batch);
+        batch.draw(renderer);
+        draw_time += cl::now() - now;
+        SDL_RenderPresent(renderer);
+
+        // Show the framerate in the title once a second
+        frames++;
+        if (now - title_time >= std::chrono::seconds(1)) {
+            double seconds = std::chrono::duration<double>(now - title_time)
+                                 .count();
+            char title[128];
+            std::snprintf(
+                title, sizeof(title),
+                "Tetris spectator: %d games, %.0f fps, %.2f ms per frame",
+                options.games, frames / seconds,
+                std::chrono::duration<double, std::milli>(draw_time).count() /
+                    frames);
+            SDL_SetWindowTitle(window, title);
+            frames = 0;
+            draw_time = {};
+            title_time = now;
+        }
+
+        // Limit framerate like the game does
+        std::this_thread::sleep_for(std::chrono::milliseconds(
+            MIN_FRAMETIME_MS -
+            std::chrono::duration_cast<std::chrono::milliseconds>(cl::now() -
+                                                                  now)
+                .count()));
+    }
+
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+    return 0;
+}
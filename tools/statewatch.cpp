@@ -0,0 +1,252 @@
+/*
+ * Prints the state a game publishes with --export-state to the terminal
+ * whenever it changes. Example of a reader of the shared memory layout in
+ * include/stateexport.h:
+ *
+ *   tetris --export-state /tetris-state
+ *   tetris_statewatch /tetris-state
+ *
+ * With --stream, rebuilds the state from the stream written with --stream
+ * instead (see include/statestream.h), either live from a socket or by
+ * playing back a file at the speed it was recorded at:
+ *
+ *   tetris_statewatch --stream unix:/tmp/tetris.stream
+ *   tetris --stream unix:/tmp/tetris.stream
+ *
+ *   tetris --stream game.tss
+ *   tetris_statewatch --stream game.tss
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sys/socket.h"
+#include "sys/un.h"
+#include "unistd.h"
+
+#include "bitboard.h"
+#include "stateexport.h"
+#include "statestream.h"
+
+using cl = std::chrono::steady_clock;
+
+// How often to look for a new state; well below the length of a tick
+inline const int STATEWATCH_POLL_MS = 2;
+
+void print(const ExportedState &state) {
+    static const char *const KIND_NAMES = "IJLOSTZ";
+    static const char *const STATE_NAMES[] = {"not started", "running",
+                                              "paused", "game over"};
+    // Move to the top left corner and clear the screen
+    std::printf("\033[H\033[2J");
+    std::printf("tick %llu  %s\n", (unsigned long long)state.tick,
+                STATE_NAMES[state.state & 3]);
+    std::printf("score %d  lines %d  level %d  pieces %d  garbage %d\n",
+                state.score, state.lines, state.level, state.pieces,
+                state.pending_garbage);
+    std::printf("hold %c  next ",
+                state.held < N_TETROMINOS ? KIND_NAMES[state.held] : '-');
+    for (int i = 0; i < QUEUE_LEN; i++) {
+        std::printf("%c", KIND_NAMES[state.queue[i] % N_TETROMINOS]);
+    }
+    std::printf("\n\n");
+    for (int y = GRID_START_Y; y < GRID_SIZE_Y; y++) {
+        std::printf("|");
+        for (int x = 0; x < GRID_SIZE_X; x++) {
+            uint8_t cell = state.cells[y][x];
+            char c = cell < N_TETROMINOS ? KIND_NAMES[cell] : ' ';
+            int col = x - state.active_x;
+            int row = y - state.active_y;
+            if (col >= 0 && col < 4 && row >= 0 && row < 4 &&
+                (getPieceMask(state.active_kind, state.active_orientation) >>
+                 (row * 4 + col)) &
+                    1) {
+                c = '#';
+            }
+            std::printf("%c%c", c, c);
+        }
+        std::printf("|\n");
+    }
+    std::fflush(stdout);
+}
+
+/**
+ * Watch the shared memory segment of a game
+ */
+void watchSegment(const std::string &name) {
+    StateExportReader reader(name);
+    ExportedState state, last{};
+    // Everything after the tick and the time, which change every tick
+    const size_t offset = offsetof(ExportedState, score);
+    while (true) {
+        if (reader.read(state) &&
+            std::memcmp(reinterpret_cast<char *>(&state) + offset,
+                        reinterpret_cast<char *>(&last) + offset,
+                        sizeof(ExportedState) - offset) != 0) {
+            last = state;
+            print(state);
+        }
+        std::this_thread::sleep_for(
+            std::chrono::milliseconds(STATEWATCH_POLL_MS));
+    }
+}
+
+/*
+ * Applies the frames of a stream and prints every state they lead to, along
+ * with how much of the stream it took
+ */
+class StreamPrinter {
+  private:
+    StateStreamDecoder m_decoder;
+    uint64_t m_bytes = 0;
+    int64_t m_first_ms = -1;
+
+  public:
+    /**
+     * @return the time of the frame in milliseconds, or -1 if the frame
+     *         couldn't be applied
+     */
+    int64_t apply(const uint8_t *frame, size_t len, size_t header) {
+        m_bytes += header + len;
+        if (!m_decoder.apply(frame, len)) {
+            return -1;
+        }
+        if (m_first_ms < 0) {
+            m_first_ms = m_decoder.getTimeMs();
+        }
+        return m_decoder.getTimeMs();
+    }
+
+    void print() const {
+        ::print(m_decoder.getState());
+        double minutes = (m_decoder.getTimeMs() - m_first_ms) / 60000.0;
+        std::printf("\n%llu bytes", (unsigned long long)m_bytes);
+        if (minutes > 0) {
+            std::printf(", %.0f bytes per minute", m_bytes / minutes);
+        }
+        std::printf("\n");
+        std::fflush(stdout);
+    }
+};
+
+/**
+ * Receive a stream on a Unix datagram socket, one frame per datagram
+ */
+void watchSocket(const std::string &path) {
+    sockaddr_un addr{};
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Invalid socket path: " + path);
+    }
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, path.c_str());
+    int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Couldn't create socket");
+    }
+    // Remove stale socket left over by a previous run
+    unlink(path.c_str());
+    if (bind(fd, (sockaddr *)&addr, sizeof(addr)) != 0) {
+        throw std::runtime_error("Couldn't bind to " + path);
+    }
+    StreamPrinter printer;
+    uint8_t buffer[STATE_STREAM_MAX_FRAME];
+    while (true) {
+        ssize_t len = recv(fd, buffer, sizeof(buffer), 0);
+        size_t header, frame_len;
+        if (len > 0 &&
+            readStreamFrameLength(buffer, len, header, frame_len) &&
+            header + frame_len == (size_t)len &&
+            printer.apply(buffer + header, frame_len, header) >= 0) {
+            printer.print();
+        }
+    }
+}
+
+/**
+ * Play back a stream file at the speed it was recorded at. Waits for more
+ * at the end of the file, so a file that is still being written is followed.
+ */
+void watchFile(const std::string &path) {
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        throw std::runtime_error("Couldn't open " + path);
+    }
+    uint8_t magic[4];
+    if (std::fread(magic, 1, sizeof(magic), file) != sizeof(magic) ||
+        (magic[0] | magic[1] << 8 | magic[2] << 16 |
+         (uint32_t)magic[3] << 24) != STATE_STREAM_MAGIC) {
+        std::fclose(file);
+        throw std::runtime_error(path + " isn't a stream file");
+    }
+    StreamPrinter printer;
+    std::vector<uint8_t> buffer;
+    // Wall clock time at which the first frame was shown, and its time
+    cl::time_point start;
+    int64_t start_ms = -1;
+    uint8_t chunk[4096];
+    while (true) {
+        size_t n_read = std::fread(chunk, 1, sizeof(chunk), file);
+        if (n_read == 0) {
+            std::clearerr(file);
+            std::this_thread::sleep_for(
+                std::chrono::milliseconds(STATEWATCH_POLL_MS));
+            continue;
+        }
+        buffer.insert(buffer.end(), chunk, chunk + n_read);
+        size_t pos = 0;
+        size_t header, frame_len;
+        while (readStreamFrameLength(buffer.data() + pos, buffer.size() - pos,
+                                     header, frame_len) &&
+               pos + header + frame_len <= buffer.size()) {
+            if (frame_len > STATE_STREAM_MAX_FRAME) {
+                std::fclose(file);
+                throw std::runtime_error(path + " is corrupt");
+            }
+            int64_t time_ms =
+                printer.apply(buffer.data() + pos + header, frame_len, header);
+            pos += header + frame_len;
+            if (time_ms < 0) {
+                continue;
+            }
+            if (start_ms < 0) {
+                start = cl::now();
+                start_ms = time_ms;
+            }
+            std::this_thread::sleep_until(
+                start + std::chrono::milliseconds(time_ms - start_ms));
+            printer.print();
+        }
+        buffer.erase(buffer.begin(), buffer.begin() + pos);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::string name = STATE_EXPORT_DEFAULT_NAME;
+    std::string stream;
+    if (argc == 3 && std::string(argv[1]) == "--stream") {
+        stream = argv[2];
+    } else if (argc == 2 && argv[1][0] != '-') {
+        name = argv[1];
+    } else if (argc != 1) {
+        std::cout << "Usage: " << argv[0] << " [NAME]\n"
+                  << "       " << argv[0] << " --stream FILE|unix:PATH\n";
+        return 1;
+    }
+    try {
+        if (stream.empty()) {
+            watchSegment(name);
+        } else if (stream.rfind("unix:", 0) == 0) {
+            watchSocket(stream.substr(5));
+        } else {
+            watchFile(stream);
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,405 @@
+/*
+ * Plays bot configurations against each other, to tell whether a change to a
+ * bot is an improvement. Both sides of a match play the same Tetromino
+ * sequences and whoever scores more on a sequence wins that game:
+ *
+ *   tetris_tournament bots.txt --games 200
+ *   tetris_tournament bots.txt --swiss --rounds 5
+ *
+ * Every line of the bots file names a bot and, optionally, settings that
+ * differ from the defaults:
+ *
+ *   # name    settings
+ *   default
+ *   deep      depth=3
+ *   holey     holes=2.5 wells=0.5
+ *
+ * Games run in a pool of worker processes, one per core by default.
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "bot.h"
+#include "gamepool.h"
+
+enum class Metric { Score, Lines };
+
+struct Options {
+    std::string bots_path;
+    bool swiss = false;
+    // Games per match; every game of a match has its own seed
+    int games = 100;
+    // Number of Swiss rounds; 0 picks enough to separate the bots
+    int rounds = 0;
+    int pieces = GAME_POOL_DEFAULT_PIECES;
+    int jobs = 0;
+    uint32_t seed = 1;
+    Metric metric = Metric::Score;
+};
+
+void printUsage(const char *program_name) {
+    std::cout
+        << "Usage: " << program_name << " BOTS_FILE [options]\n"
+        << "\n"
+        << "  --swiss             Swiss system instead of round robin\n"
+        << "  --rounds N          number of Swiss rounds (default: log2 of\n"
+        << "                      the number of bots, rounded up)\n"
+        << "  --games N           games per match (default 100)\n"
+        << "  --pieces N          end games after N Tetrominos (default "
+        << GAME_POOL_DEFAULT_PIECES << ")\n"
+        << "  --metric M          'score' or 'lines' (default score)\n"
+        << "  --seed N            seed of the first game (default 1)\n"
+        << "  --jobs N            worker processes (default: one per core)\n";
+}
+
+bool parseOptions(int argc, char *argv[], Options &options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--swiss") {
+            options.swiss = true;
+        } else if (arg == "--rounds" && has_value) {
+            options.rounds = std::stoi(argv[++i]);
+        } else if (arg == "--games" && has_value) {
+            options.games = std::stoi(argv[++i]);
+        } else if (arg == "--pieces" && has_value) {
+            options.pieces = std::stoi(argv[++i]);
+        } else if (arg == "--metric" && has_value) {
+            std::string metric = argv[++i];
+            if (metric == "score") {
+                options.metric = Metric::Score;
+            } else if (metric == "lines") {
+                options.metric = Metric::Lines;
+            } else {
+                return false;
+            }
+        } else if (arg == "--seed" && has_value) {
+            options.seed = std::stoul(argv[++i]);
+        } else if (arg == "--jobs" && has_value) {
+            options.jobs = std::stoi(argv[++i]);
+        } else if (options.bots_path.empty() && arg[0] != '-') {
+            options.bots_path = arg;
+        } else {
+            return false;
+        }
+    }
+    return !options.bots_path.empty() && options.games > 0 &&
+           options.pieces > 0 && options.rounds >= 0 && options.jobs >= 0;
+}
+
+/**
+ * Read the bots file, see the top of this file for the format
+ *
+ * @throws std::invalid_argument if the file can't be read or is invalid
+ */
+std::vector<BotConfig> loadBots(const std::string &path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::invalid_argument("Couldn't open " + path);
+    }
+    std::vector<BotConfig> bots;
+    std::string line;
+    for (int line_number = 1; std::getline(file, line); line_number++) {
+        std::istringstream tokens(line);
+        BotConfig bot;
+        if (!(tokens >> bot.name) || bot.name[0] == '#') {
+            continue;
+        }
+        std::string where = path + ":" + std::to_string(line_number);
+        for (const BotConfig &other : bots) {
+            if (other.name == bot.name) {
+                throw std::invalid_argument(where + ": duplicate bot '" +
+                                            bot.name + "'");
+            }
+        }
+        std::string setting;
+        while (tokens >> setting) {
+            size_t equals = setting.find('=');
+            std::string key = setting.substr(0, equals);
+            double value;
+            try {
+                size_t n_parsed;
+                std::string number = setting.substr(equals + 1);
+                value = std::stod(number, &n_parsed);
+                if (equals == std::string::npos ||
+                    n_parsed != number.size() || !std::isfinite(value)) {
+                    throw std::invalid_argument(setting);
+                }
+            } catch (const std::exception &) {
+                throw std::invalid_argument(where + ": expected 'key=number'"
+                                                    ", got '" +
+                                            setting + "'");
+            }
+            bool known = false;
+            if (key == "depth") {
+                bot.depth = (int)value;
+                known = value >= 1 && value <= BOT_MAX_DEPTH;
+            }
+            for (const auto &[name, weight] : EVAL_WEIGHT_NAMES) {
+                if (key == name) {
+                    bot.weights.*weight = value;
+                    known = true;
+                }
+            }
+            if (!known) {
+                throw std::invalid_argument(where + ": invalid setting '" +
+                                            setting + "'");
+            }
+        }
+        bots.push_back(bot);
+    }
+    if (bots.size() < 2) {
+        throw std::invalid_argument(path + ": need at least two bots");
+    }
+    return bots;
+}
+
+/**
+ * Elo difference corresponding to an expected score
+ */
+double eloFromScore(double score) {
+    score = std::clamp(score, 0.001, 0.999);
+    return 400 * std::log10(score / (1 - score));
+}
+
+/*
+ * Everything played between two bots, from the point of view of the one
+ * listed first in the bots file
+ */
+struct MatchRecord {
+    // 1 for a win, 0.5 for a draw and 0 for a loss
+    std::vector<double> outcomes;
+    // Difference in the metric on each seed
+    std::vector<double> differences;
+};
+
+struct Standing {
+    double points = 0;
+    int wins = 0, draws = 0, losses = 0;
+    std::vector<double> values;
+};
+
+class Tournament {
+  private:
+    const Options &m_options;
+    const std::vector<BotConfig> &m_bots;
+    GamePool m_pool;
+    std::vector<Standing> m_standings;
+    // Keyed by the indices of both bots, the lower one first
+    std::map<std::pair<int, int>, MatchRecord> m_matches;
+
+    double metric(const GameResult &result) const {
+        return m_options.metric == Metric::Score ? result.score
+                                                 : result.lines;
+    }
+
+    void recordGame(int a, int b, const GameResult &result_a,
+                    const GameResult &result_b) {
+        if (a > b) {
+            recordGame(b, a, result_b, result_a);
+            return;
+        }
+        double difference = metric(result_a) - metric(result_b);
+        double outcome = difference > 0 ? 1 : difference < 0 ? 0 : 0.5;
+        MatchRecord &match = m_matches[{a, b}];
+        match.outcomes.push_back(outcome);
+        match.differences.push_back(difference);
+        for (auto [bot, points] : {std::pair(a, outcome),
+                                   std::pair(b, 1 - outcome)}) {
+            Standing &standing = m_standings[bot];
+            standing.points += points;
+            standing.wins += points == 1;
+            standing.draws += points == 0.5;
+            standing.losses += points == 0;
+        }
+    }
+
+    /**
+     * Play the given matches, each on the seeds starting at `first_seed`
+     */
+    bool playMatches(const std::vector<std::pair<int, int>> &pairs,
+                     uint32_t first_seed, const std::string &label) {
+        // Each bot plays each seed once, however many matches it is in
+        std::vector<int> slot(m_bots.size(), -1);
+        std::vector<GameRequest> requests;
+        for (auto [a, b] : pairs) {
+            for (int bot : {a, b}) {
+                if (slot[bot] < 0) {
+                    slot[bot] = requests.size();
+                    for (int i = 0; i < m_options.games; i++) {
+                        requests.push_back({bot, first_seed + i});
+                    }
+                }
+            }
+        }
+        std::vector<GameResult> results;
+        bool success = m_pool.run(
+            m_bots, requests, results, [&label](int finished, int total) {
+                std::cerr << "\r" << label << ": " << finished << "/" << total
+                          << " games" << std::flush;
+            });
+        std::cerr << "\n";
+        if (!success) {
+            std::cerr << "ERROR: A worker process failed\n";
+            return false;
+        }
+        for (int bot = 0; bot < (int)m_bots.size(); bot++) {
+            for (int i = 0; slot[bot] >= 0 && i < m_options.games; i++) {
+                m_standings[bot].values.push_back(
+                    metric(results[slot[bot] + i]));
+            }
+        }
+        for (auto [a, b] : pairs) {
+            for (int i = 0; i < m_options.games; i++) {
+                recordGame(a, b, results[slot[a] + i], results[slot[b] + i]);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Pair bots with similar points that haven't met yet. The bot left over
+     * with an odd number of bots sits the round out.
+     */
+    std::vector<std::pair<int, int>> pairSwissRound() const {
+        std::vector<int> order(m_bots.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+            return m_standings[a].points > m_standings[b].points;
+        });
+        std::vector<bool> paired(m_bots.size(), false);
+        std::vector<std::pair<int, int>> pairs;
+        for (size_t i = 0; i < order.size(); i++) {
+            int a = order[i];
+            if (paired[a]) {
+                continue;
+            }
+            // Prefer the closest opponent not met yet, else the closest one
+            int opponent = -1;
+            for (size_t j = i + 1; j < order.size(); j++) {
+                int b = order[j];
+                if (paired[b]) {
+                    continue;
+                }
+                if (opponent < 0) {
+                    opponent = b;
+                }
+                if (!m_matches.count({std::min(a, b), std::max(a, b)})) {
+                    opponent = b;
+                    break;
+                }
+            }
+            if (opponent >= 0) {
+                paired[a] = paired[opponent] = true;
+                pairs.push_back({a, opponent});
+            }
+        }
+        return pairs;
+    }
+
+  public:
+    Tournament(const Options &options, const std::vector<BotConfig> &bots)
+        : m_options(options), m_bots(bots),
+          m_pool(options.jobs, options.pieces), m_standings(bots.size()) {}
+
+    bool play() {
+        if (!m_options.swiss) {
+            std::vector<std::pair<int, int>> pairs;
+            for (int a = 0; a < (int)m_bots.size(); a++) {
+                for (int b = a + 1; b < (int)m_bots.size(); b++) {
+                    pairs.push_back({a, b});
+                }
+            }
+            return playMatches(pairs, m_options.seed, "Round robin");
+        }
+        int rounds = m_options.rounds;
+        if (rounds == 0) {
+            rounds = std::max(1, (int)std::ceil(std::log2(m_bots.size())));
+        }
+        for (int round = 0; round < rounds; round++) {
+            // Every round is played on new seeds
+            if (!playMatches(pairSwissRound(),
+                             m_options.seed + round * m_options.games,
+                             "Round " + std::to_string(round + 1))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void print() const {
+        const char *metric_name =
+            m_options.metric == Metric::Score ? "score" : "lines";
+        std::vector<int> order(m_bots.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+            return m_standings[a].points > m_standings[b].points;
+        });
+
+        std::printf("\n%-3s %-16s %8s %6s %6s %6s   %s (95%% CI)\n", "#", "bot",
+                    "points", "won", "drawn", "lost", metric_name);
+        for (size_t rank = 0; rank < order.size(); rank++) {
+            const Standing &standing = m_standings[order[rank]];
+            Estimate value = estimate(standing.values);
+            std::printf("%-3zu %-16s %8.1f %6d %6d %6d   %.1f +- %.1f\n",
+                        rank + 1, m_bots[order[rank]].name.c_str(),
+                        standing.points, standing.wins, standing.draws,
+                        standing.losses, value.mean, value.error);
+        }
+
+        std::printf("\n%-33s %6s %16s %22s   %s difference\n", "match",
+                    "games", "score", "Elo", metric_name);
+        for (const auto &[bots, match] : m_matches) {
+            Estimate score = estimate(match.outcomes);
+            Estimate difference = estimate(match.differences);
+            std::string name = m_bots[bots.first].name + " vs " +
+                               m_bots[bots.second].name;
+            std::printf("%-33s %6zu %7.1f%% +- %4.1f %+6.0f [%+6.0f, %+6.0f]"
+                        "   %+.1f +- %.1f\n",
+                        name.c_str(), match.outcomes.size(), score.mean * 100,
+                        score.error * 100, eloFromScore(score.mean),
+                        eloFromScore(score.mean - score.error),
+                        eloFromScore(score.mean + score.error),
+                        difference.mean, difference.error);
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    Options options;
+    try {
+        if (!parseOptions(argc, argv, options)) {
+            printUsage(argv[0]);
+            return 1;
+        }
+    } catch (const std::exception &) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    std::vector<BotConfig> bots;
+    try {
+        bots = loadBots(options.bots_path);
+    } catch (const std::exception &e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return 1;
+    }
+
+    Tournament tournament(options, bots);
+    if (!tournament.play()) {
+        return 1;
+    }
+    tournament.print();
+    return 0;
+}
@@ -0,0 +1,673 @@
+/*
+ * Tunes the evaluation weights of the bot with CMA-ES (covariance matrix
+ * adaptation evolution strategy). Every generation, a population of weight
+ * vectors is sampled and each candidate plays the same seeded games; the best
+ * half moves the search distribution towards it:
+ *
+ *   tetris_tuner --generations 50 --games 200 --checkpoint run.txt
+ *   tetris_tuner --generations 100 --checkpoint run.txt --resume
+ *
+ * The state of the search is written to the checkpoint file after every
+ * generation, so an interrupted run continues where it left off. The weights
+ * found are printed as a line of a tetris_tournament bots file.
+ */
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bot.h"
+#include "gamepool.h"
+
+enum class Metric { Score, Lines };
+
+inline const int N_WEIGHTS = EVAL_WEIGHT_NAMES.size();
+using Vector = std::array<double, N_WEIGHTS>;
+using Matrix = std::array<Vector, N_WEIGHTS>;
+
+// First line of checkpoint files, to be changed with their layout
+inline const char *const CHECKPOINT_VERSION = "tetris_tuner 1";
+
+struct Options {
+    int generations = 50;
+    // Candidates per generation; 0 picks the usual 4 + 3 ln(n)
+    int population = 0;
+    int games = 200;
+    // Candidates that are clearly worse than the best half stop playing after
+    // each of these parts of their games
+    int stages = 4;
+    int pieces = GAME_POOL_DEFAULT_PIECES;
+    int depth = 2;
+    int jobs = 0;
+    uint32_t seed = 1;
+    // Initial step size, relative to the weights normalized to length 1
+    double sigma = 0.1;
+    Metric metric = Metric::Score;
+    std::string checkpoint_path = "tuner.txt";
+    bool resume = false;
+};
+
+void printUsage(const char *program_name) {
+    std::cout
+        << "Usage: " << program_name << " [options]\n"
+        << "\n"
+        << "  --generations N     generations to run in total (default 50)\n"
+        << "  --population N      candidates per generation (default 9)\n"
+        << "  --games N           games per candidate (default 200)\n"
+        << "  --stages N          check for clearly bad candidates N - 1\n"
+        << "                      times per generation; 1 never stops them\n"
+        << "                      early (default 4)\n"
+        << "  --pieces N          end games after N Tetrominos (default "
+        << GAME_POOL_DEFAULT_PIECES << ")\n"
+        << "  --depth N           look ahead of the bot (default 2)\n"
+        << "  --metric M          'score' or 'lines' (default score)\n"
+        << "  --seed N            seed of the first game (default 1)\n"
+        << "  --sigma X           initial step size (default 0.1)\n"
+        << "  --jobs N            worker processes (default: one per core)\n"
+        << "  --checkpoint PATH   state of the search (default tuner.txt)\n"
+        << "  --resume            continue the search in the checkpoint;\n"
+        << "                      only --generations, --stages and --jobs\n"
+        << "                      can differ from the interrupted run\n";
+}
+
+bool parseOptions(int argc, char *argv[], Options &options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--generations" && has_value) {
+            options.generations = std::stoi(argv[++i]);
+        } else if (arg == "--population" && has_value) {
+            options.population = std::stoi(argv[++i]);
+        } else if (arg == "--games" && has_value) {
+            options.games = std::stoi(argv[++i]);
+        } else if (arg == "--stages" && has_value) {
+            options.stages = std::stoi(argv[++i]);
+        } else if (arg == "--pieces" && has_value) {
+            options.pieces = std::stoi(argv[++i]);
+        } else if (arg == "--depth" && has_value) {
+            options.depth = std::stoi(argv[++i]);
+        } else if (arg == "--metric" && has_value) {
+            std::string metric = argv[++i];
+            if (metric == "score") {
+                options.metric = Metric::Score;
+            } else if (metric == "lines") {
+                options.metric = Metric::Lines;
+            } else {
+                return false;
+            }
+        } else if (arg == "--seed" && has_value) {
+            options.seed = std::stoul(argv[++i]);
+        } else if (arg == "--sigma" && has_value) {
+            options.sigma = std::stod(argv[++i]);
+        } else if (arg == "--jobs" && has_value) {
+            options.jobs = std::stoi(argv[++i]);
+        } else if (arg == "--checkpoint" && has_value) {
+            options.checkpoint_path = argv[++i];
+        } else if (arg == "--resume") {
+            options.resume = true;
+        } else {
+            return false;
+        }
+    }
+    if (options.population == 0) {
+        options.population = 4 + (int)(3 * std::log(N_WEIGHTS));
+    }
+    return options.generations > 0 && options.population >= 2 &&
+           options.games > 0 && options.stages >= 1 &&
+           options.stages <= options.games && options.pieces > 0 &&
+           options.depth >= 1 && options.depth <= BOT_MAX_DEPTH &&
+           options.sigma > 0 && options.jobs >= 0;
+}
+
+double norm(const Vector &v) {
+    double sum = 0;
+    for (double x : v) {
+        sum += x * x;
+    }
+    return std::sqrt(sum);
+}
+
+/**
+ * Turn a point of the search space into weights. Only the direction matters,
+ * since the bot just compares scores, so the weights are scaled to length 1.
+ */
+EvalWeights toWeights(const Vector &x) {
+    double length = std::max(norm(x), 1e-9);
+    EvalWeights weights;
+    for (int i = 0; i < N_WEIGHTS; i++) {
+        weights.*EVAL_WEIGHT_NAMES[i].second = x[i] / length;
+    }
+    return weights;
+}
+
+/**
+ * Eigendecomposition of a symmetric matrix with the Jacobi method, which is
+ * plenty for a handful of dimensions
+ *
+ * @param vectors receives the eigenvectors as columns
+ */
+void eigenDecompose(Matrix a, Matrix &vectors, Vector &values) {
+    for (int i = 0; i < N_WEIGHTS; i++) {
+        vectors[i].fill(0);
+        vectors[i][i] = 1;
+    }
+    for (int sweep = 0; sweep < 50; sweep++) {
+        double off_diagonal = 0;
+        for (int p = 0; p < N_WEIGHTS; p++) {
+            for (int q = p + 1; q < N_WEIGHTS; q++) {
+                off_diagonal += a[p][q] * a[p][q];
+            }
+        }
+        if (off_diagonal < 1e-30) {
+            break;
+        }
+        for (int p = 0; p < N_WEIGHTS; p++) {
+            for (int q = p + 1; q < N_WEIGHTS; q++) {
+                if (a[p][q] == 0) {
+                    continue;
+                }
+                // Rotate rows and columns p and q so that a[p][q] becomes 0
+                double theta = (a[q][q] - a[p][p]) / (2 * a[p][q]);
+                double t = (theta >= 0 ? 1 : -1) /
+                           (std::abs(theta) + std::sqrt(theta * theta + 1));
+                double c = 1 / std::sqrt(t * t + 1);
+                double s = t * c;
+                for (int k = 0; k < N_WEIGHTS; k++) {
+                    double akp = a[k][p], akq = a[k][q];
+                    a[k][p] = c * akp - s * akq;
+                    a[k][q] = s * akp + c * akq;
+                }
+                for (int k = 0; k < N_WEIGHTS; k++) {
+                    double apk = a[p][k], aqk = a[q][k];
+                    a[p][k] = c * apk - s * aqk;
+                    a[q][k] = s * apk + c * aqk;
+                }
+                for (int k = 0; k < N_WEIGHTS; k++) {
+                    double vkp = vectors[k][p], vkq = vectors[k][q];
+                    vectors[k][p] = c * vkp - s * vkq;
+                    vectors[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+    for (int i = 0; i < N_WEIGHTS; i++) {
+        values[i] = std::max(a[i][i], 1e-20);
+    }
+}
+
+/*
+ * State of the search distribution, following Hansen's "The CMA Evolution
+ * Strategy: A Tutorial". Fitness is maximized.
+ */
+class CmaEs {
+  private:
+    int m_lambda;
+    int m_mu;
+    std::vector<double> m_recombination;
+    double m_mu_eff;
+    double m_cc, m_cs, m_c1, m_cmu, m_damps, m_chi_n;
+
+    int m_generation = 0;
+    double m_sigma;
+    Vector m_mean;
+    // Evolution paths of the covariance matrix and of the step size
+    Vector m_pc{}, m_ps{};
+    Matrix m_covariance{};
+
+  public:
+    CmaEs(int lambda, const Vector &mean, double sigma)
+        : m_lambda(lambda), m_mu(lambda / 2), m_sigma(sigma), m_mean(mean) {
+        const double n = N_WEIGHTS;
+        double sum = 0, sum_squares = 0;
+        for (int i = 0; i < m_mu; i++) {
+            m_recombination.push_back(std::log(m_mu + 0.5) -
+                                      std::log(i + 1.0));
+            sum += m_recombination.back();
+        }
+        for (double &w : m_recombination) {
+            w /= sum;
+            sum_squares += w * w;
+        }
+        m_mu_eff = 1 / sum_squares;
+        m_cc = (4 + m_mu_eff / n) / (n + 4 + 2 * m_mu_eff / n);
+        m_cs = (m_mu_eff + 2) / (n + m_mu_eff + 5);
+        m_c1 = 2 / ((n + 1.3) * (n + 1.3) + m_mu_eff);
+        m_cmu = std::min(1 - m_c1, 2 * (m_mu_eff - 2 + 1 / m_mu_eff) /
+                                       ((n + 2) * (n + 2) + m_mu_eff));
+        m_damps =
+            1 + 2 * std::max(0.0, std::sqrt((m_mu_eff - 1) / (n + 1)) - 1) +
+            m_cs;
+        m_chi_n = std::sqrt(n) * (1 - 1 / (4 * n) + 1 / (21 * n * n));
+        for (int i = 0; i < N_WEIGHTS; i++) {
+            m_covariance[i][i] = 1;
+        }
+    }
+
+    int getGeneration() const {
+        return m_generation;
+    }
+
+    double getSigma() const {
+        return m_sigma;
+    }
+
+    const Vector &getMean() const {
+        return m_mean;
+    }
+
+    /**
+     * Draw the candidates of the current generation. The random numbers
+     * depend only on `seed` and the generation, so a resumed run draws the
+     * same candidates.
+     */
+    std::vector<Vector> sample(uint32_t seed) const {
+        Matrix vectors;
+        Vector values;
+        eigenDecompose(m_covariance, vectors, values);
+        std::seed_seq seq{seed, (uint32_t)m_generation};
+        std::mt19937 rng(seq);
+        std::normal_distribution<double> normal;
+        std::vector<Vector> candidates(m_lambda);
+        for (Vector &x : candidates) {
+            Vector z;
+            for (int i = 0; i < N_WEIGHTS; i++) {
+                z[i] = std::sqrt(values[i]) * normal(rng);
+            }
+            for (int i = 0; i < N_WEIGHTS; i++) {
+                x[i] = m_mean[i];
+                for (int j = 0; j < N_WEIGHTS; j++) {
+                    x[i] += m_sigma * vectors[i][j] * z[j];
+                }
+            }
+        }
+        return candidates;
+    }
+
+    /**
+     * Move the distribution towards the best candidates
+     *
+     * @param ranked candidates of the generation, best first
+     */
+    void update(const std::vector<Vector> &ranked) {
+        const double n = N_WEIGHTS;
+        Vector old_mean = m_mean;
+        m_mean.fill(0);
+        for (int k = 0; k < m_mu; k++) {
+            for (int i = 0; i < N_WEIGHTS; i++) {
+                m_mean[i] += m_recombination[k] * ranked[k][i];
+            }
+        }
+        Vector step;
+        for (int i = 0; i < N_WEIGHTS; i++) {
+            step[i] = (m_mean[i] - old_mean[i]) / m_sigma;
+        }
+
+        // C^(-1/2) * step
+        Matrix vectors;
+        Vector values;
+        eigenDecompose(m_covariance, vectors, values);
+        Vector whitened{};
+        for (int j = 0; j < N_WEIGHTS; j++) {
+            double projection = 0;
+            for (int i = 0; i < N_WEIGHTS; i++) {
+                projection += vectors[i][j] * step[i];
+            }
+            projection /= std::sqrt(values[j]);
+            for (int i = 0; i < N_WEIGHTS; i++) {
+                whitened[i] += vectors[i][j] * projection;
+            }
+        }
+
+        double cs_factor = std::sqrt(m_cs * (2 - m_cs) * m_mu_eff);
+        for (int i = 0; i < N_WEIGHTS; i++) {
+            m_ps[i] = (1 - m_cs) * m_ps[i] + cs_factor * whitened[i];
+        }
+        // While the step size path is long, the step size is about to grow
+        // and the covariance path is held back so it doesn't grow too fast
+        double ps_norm = norm(m_ps);
+        double ps_expected =
+            std::sqrt(1 - std::pow(1 - m_cs, 2 * (m_generation + 1))) *
+            m_chi_n;
+        bool hsig = ps_norm / ps_expected < 1.4 + 2 / (n + 1);
+        double cc_factor = std::sqrt(m_cc * (2 - m_cc) * m_mu_eff);
+        for (int i = 0; i < N_WEIGHTS; i++) {
+            m_pc[i] = (1 - m_cc) * m_pc[i] + (hsig ? cc_factor * step[i] : 0);
+        }
+
+        double correction = hsig ? 0 : m_c1 * m_cc * (2 - m_cc);
+        for (int i = 0; i < N_WEIGHTS; i++) {
+            for (int j = 0; j < N_WEIGHTS; j++) {
+                double rank_mu = 0;
+                for (int k = 0; k < m_mu; k++) {
+                    rank_mu += m_recombination[k] *
+                               (ranked[k][i] - old_mean[i]) *
+                               (ranked[k][j] - old_mean[j]);
+                }
+                m_covariance[i][j] =
+                    (1 - m_c1 - m_cmu + correction) * m_covariance[i][j] +
+                    m_c1 * m_pc[i] * m_pc[j] +
+                    m_cmu * rank_mu / (m_sigma * m_sigma);
+            }
+        }
+        m_sigma *= std::exp(m_cs / m_damps * (ps_norm / m_chi_n - 1));
+
+        // Scaling the weights doesn't change the bot, so keep the mean at
+        // length 1 rather than letting it drift along that direction
+        double length = norm(m_mean);
+        for (double &x : m_mean) {
+            x /= length;
+        }
+        m_generation++;
+    }
+
+    void save(std::ostream &out) const {
+        out << "generation " << m_generation << "\n"
+            << "sigma " << m_sigma << "\n";
+        auto write = [&out](const char *name, const Vector &v) {
+            out << name;
+            for (double x : v) {
+                out << " " << x;
+            }
+            out << "\n";
+        };
+        write("mean", m_mean);
+        write("pc", m_pc);
+        write("ps", m_ps);
+        for (const Vector &row : m_covariance) {
+            write("covariance", row);
+        }
+    }
+
+    /**
+     * @return false if the state is incomplete
+     */
+    bool load(std::istream &in) {
+        std::string key;
+        auto read = [&in, &key](const char *name, Vector &v) {
+            if (!(in >> key) || key != name) {
+                return false;
+            }
+            for (double &x : v) {
+                in >> x;
+            }
+            return (bool)in;
+        };
+        if (!(in >> key >> m_generation) || key != "generation" ||
+            !(in >> key >> m_sigma) || key != "sigma" ||
+            !read("mean", m_mean) || !read("pc", m_pc) || !read("ps", m_ps)) {
+            return false;
+        }
+        for (Vector &row : m_covariance) {
+            if (!read("covariance", row)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+class Tuner {
+  private:
+    Options m_options;
+    GamePool m_pool;
+    CmaEs m_cmaes;
+    // Total number of games played and that would have been played without
+    // stopping bad candidates early
+    long m_games_played = 0;
+    long m_games_budget = 0;
+
+    double metric(const GameResult &result) const {
+        return m_options.metric == Metric::Score ? result.score
+                                                 : result.lines;
+    }
+
+    static Vector defaultMean() {
+        EvalWeights defaults;
+        Vector mean;
+        for (int i = 0; i < N_WEIGHTS; i++) {
+            mean[i] = defaults.*EVAL_WEIGHT_NAMES[i].second;
+        }
+        double length = norm(mean);
+        for (double &x : mean) {
+            x /= length;
+        }
+        return mean;
+    }
+
+    /**
+     * Play the games of one generation. All candidates play the same seeds,
+     * in stages; after each stage, candidates whose confidence interval lies
+     * entirely below that of the worst of the best half are dropped.
+     *
+     * @param order receives the candidates from best to worst
+     */
+    bool evaluate(const std::vector<Vector> &candidates,
+                  std::vector<int> &order, std::vector<Estimate> &fitness) {
+        int n = candidates.size();
+        int mu = n / 2;
+        uint32_t first_seed =
+            m_options.seed + m_cmaes.getGeneration() * m_options.games;
+        std::vector<BotConfig> bots(n);
+        for (int i = 0; i < n; i++) {
+            bots[i].name = std::to_string(i);
+            bots[i].depth = m_options.depth;
+            bots[i].weights = toWeights(candidates[i]);
+        }
+
+        std::vector<std::vector<double>> values(n);
+        std::vector<bool> alive(n, true);
+        fitness.assign(n, {});
+        int played = 0;
+        for (int stage = 0; stage < m_options.stages; stage++) {
+            int end = (long)m_options.games * (stage + 1) / m_options.stages;
+            std::vector<GameRequest> requests;
+            for (int i = 0; i < n; i++) {
+                for (int game = played; alive[i] && game < end; game++) {
+                    requests.push_back({i, first_seed + game});
+                }
+            }
+            std::vector<GameResult> results;
+            int generation = m_cmaes.getGeneration() + 1;
+            bool success = m_pool.run(
+                bots, requests, results,
+                [generation, stage, this](int finished, int total) {
+                    std::cerr << "\rGeneration " << generation << ", stage "
+                              << stage + 1 << "/" << m_options.stages << ": "
+                              << finished << "/" << total << " games"
+                              << std::flush;
+                });
+            std::cerr << "\n";
+            if (!success) {
+                std::cerr << "ERROR: A worker process failed\n";
+                return false;
+            }
+            m_games_played += requests.size();
+            for (size_t r = 0; r < requests.size(); r++) {
+                values[requests[r].bot].push_back(metric(results[r]));
+            }
+            played = end;
+
+            std::vector<int> alive_order;
+            for (int i = 0; i < n; i++) {
+                fitness[i] = estimate(values[i]);
+                if (alive[i]) {
+                    alive_order.push_back(i);
+                }
+            }
+            if (stage + 1 == m_options.stages ||
+                (int)alive_order.size() <= mu) {
+                continue;
+            }
+            std::sort(alive_order.begin(), alive_order.end(),
+                      [&fitness](int a, int b) {
+                          return fitness[a].mean > fitness[b].mean;
+                      });
+            const Estimate &threshold = fitness[alive_order[mu - 1]];
+            for (int i : alive_order) {
+                if (fitness[i].mean + fitness[i].error <
+                    threshold.mean - threshold.error) {
+                    alive[i] = false;
+                }
+            }
+        }
+        m_games_budget += (long)n * m_options.games;
+
+        // Candidates that played all games rank above the dropped ones
+        order.resize(n);
+        for (int i = 0; i < n; i++) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&](int a, int b) {
+            if (alive[a] != alive[b]) {
+                return (bool)alive[a];
+            }
+            return fitness[a].mean > fitness[b].mean;
+        });
+        return true;
+    }
+
+    /**
+     * Write the checkpoint to a temporary file first, so that an interrupted
+     * write leaves the previous checkpoint intact
+     */
+    bool saveCheckpoint() const {
+        std::string temporary_path = m_options.checkpoint_path + ".tmp";
+        {
+            std::ofstream out(temporary_path, std::ios::trunc);
+            out.precision(std::numeric_limits<double>::max_digits10);
+            out << CHECKPOINT_VERSION << "\n"
+                << "population " << m_options.population << "\n"
+                << "games " << m_options.games << "\n"
+                << "pieces " << m_options.pieces << "\n"
+                << "depth " << m_options.depth << "\n"
+                << "metric "
+                << (m_options.metric == Metric::Score ? "score" : "lines")
+                << "\n"
+                << "seed " << m_options.seed << "\n"
+                << "played " << m_games_played << " " << m_games_budget
+                << "\n";
+            m_cmaes.save(out);
+            if (!out.flush()) {
+                std::cerr << "ERROR: Couldn't write " << temporary_path
+                          << "\n";
+                return false;
+            }
+        }
+        if (std::rename(temporary_path.c_str(),
+                        m_options.checkpoint_path.c_str()) != 0) {
+            std::cerr << "ERROR: Couldn't replace "
+                      << m_options.checkpoint_path << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    void printWeights(const char *name, const Vector &x) const {
+        EvalWeights weights = toWeights(x);
+        std::printf("%s depth=%d", name, m_options.depth);
+        for (const auto &[key, weight] : EVAL_WEIGHT_NAMES) {
+            std::printf(" %s=%.4f", key, weights.*weight);
+        }
+        std::printf("\n");
+    }
+
+  public:
+    Tuner(const Options &options)
+        : m_options(options), m_pool(options.jobs, options.pieces),
+          m_cmaes(options.population, defaultMean(), options.sigma) {}
+
+    /**
+     * Continue the search in the checkpoint file. Settings of the search
+     * itself are taken from the checkpoint.
+     *
+     * @return false if the file can't be read or is invalid
+     */
+    bool loadCheckpoint() {
+        std::ifstream in(m_options.checkpoint_path);
+        if (!in) {
+            std::cerr << "ERROR: Couldn't open " << m_options.checkpoint_path
+                      << "\n";
+            return false;
+        }
+        std::string version, key, metric;
+        bool valid = std::getline(in, version) &&
+                     version == CHECKPOINT_VERSION &&
+                     in >> key >> m_options.population &&
+                     in >> key >> m_options.games &&
+                     in >> key >> m_options.pieces &&
+                     in >> key >> m_options.depth && in >> key >> metric &&
+                     in >> key >> m_options.seed &&
+                     in >> key >> m_games_played >> m_games_budget;
+        m_options.metric = metric == "lines" ? Metric::Lines : Metric::Score;
+        if (valid) {
+            m_pool = GamePool(m_options.jobs, m_options.pieces);
+            m_cmaes = CmaEs(m_options.population, defaultMean(),
+                            m_options.sigma);
+            valid = m_cmaes.load(in);
+        }
+        if (!valid || m_options.stages > m_options.games) {
+            std::cerr << "ERROR: " << m_options.checkpoint_path
+                      << " isn't a valid checkpoint\n";
+            return false;
+        }
+        std::cout << "Resuming after generation " << m_cmaes.getGeneration()
+                  << "\n";
+        return true;
+    }
+
+    bool run() {
+        while (m_cmaes.getGeneration() < m_options.generations) {
+            std::vector<Vector> candidates = m_cmaes.sample(m_options.seed);
+            std::vector<int> order;
+            std::vector<Estimate> fitness;
+            if (!evaluate(candidates, order, fitness)) {
+                return false;
+            }
+            std::vector<Vector> ranked;
+            for (int i : order) {
+                ranked.push_back(candidates[i]);
+            }
+            m_cmaes.update(ranked);
+            if (!saveCheckpoint()) {
+                return false;
+            }
+
+            const Estimate &best = fitness[order[0]];
+            std::printf("Generation %d: best %.1f +- %.1f, sigma %.4f, "
+                        "%ld/%ld games played\n",
+                        m_cmaes.getGeneration(), best.mean, best.error,
+                        m_cmaes.getSigma(), m_games_played, m_games_budget);
+            printWeights("  best", candidates[order[0]]);
+            printWeights("  mean", m_cmaes.getMean());
+            std::fflush(stdout);
+        }
+        std::printf("\n");
+        printWeights("tuned", m_cmaes.getMean());
+        return true;
+    }
+};
+
+int main(int argc, char *argv[]) {
+    Options options;
+    try {
+        if (!parseOptions(argc, argv, options)) {
+            printUsage(argv[0]);
+            return 1;
+        }
+    } catch (const std::exception &) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    Tuner tuner(options);
+    if (options.resume && !tuner.loadCheckpoint()) {
+        return 1;
+    }
+    return tuner.run() ? 0 : 1;
+}